@@ -96,14 +96,40 @@ void printUsage() {
     << "  -explore-config         Emit code that explores all possible kernel configuration and print its performance\n"
     << "  -use-config <nxm>       Emit code that uses a configuration of nxm threads, e.g. 128x1\n"
     << "  -time-kernels           Emit code that executes each kernel multiple times to get accurate timings\n"
+    << "  -tuning-db <file>       Use kernel configurations from tuning database <file> - for CUDA/OpenCL only\n"
+    << "                          In combination with -explore-config, the best configurations are stored in <file>\n"
+    << "  -specialize-sizes       Emit kernels with image sizes and strides known at compile time as constants\n"
     << "  -use-textures <o>       Enable/disable usage of textures (cached) in CUDA/OpenCL to read/write image pixels - for GPU devices only\n"
     << "                          Valid values for CUDA on NVIDIA devices: 'off', 'Linear1D', 'Linear2D', 'Array2D', and 'Ldg'\n"
     << "                          Valid values for OpenCL: 'off' and 'Array2D'\n"
     << "  -use-local <o>          Enable/disable usage of shared/local memory in CUDA/OpenCL to stage image pixels to scratchpad\n"
     << "                          Valid values: 'on' and 'off'\n"
-    << "  -vectorize <o>          Enable/disable vectorization of generated CUDA/OpenCL code\n"
+    << "  -vectorize <o>          Enable/disable vectorization of generated CUDA/OpenCL/C++ code\n"
     << "                          Valid values: 'on' and 'off'\n"
+    << "                          Valid values for C++ to emit vectorization hints for the host compiler: 'sse4.2', 'avx', 'avx2', and 'avx512'\n"
     << "  -pixels-per-thread <n>  Specify how many pixels should be calculated per thread\n"
+    << "  -threads <n>            Specify how many threads should be used to execute kernels in C++ code\n"
+    << "                          Valid values: a positive integer or 'auto' to use all available cores\n"
+    << "  -fuse <o>               Enable/disable interleaved execution of consecutive producer/consumer kernels and\n"
+    << "                          of kernels with their global reduction on bands of rows in C++ code\n"
+    << "                          Valid values: 'on', 'off', and 'stream'\n"
+    << "                          'on' interleaves the launches only: the producer still writes the whole\n"
+    << "                          intermediate image to memory. 'stream' is required to keep images only read by\n"
+    << "                          the consumer or the reduction in line buffers instead of memory\n"
+    << "                          CUDA, OpenCL, and Renderscript keep launching separate reduction kernels\n"
+    << "  -fuse-sampling <o>      Enable/disable fusion of kernels with a consumer that only subsamples their output,\n"
+    << "                          so that the kernel is evaluated only at the retained pixels\n"
+    << "                          Valid values: 'on' and 'off'\n"
+    << "  -concurrent-kernels <o> Enable/disable non-blocking kernel launches on multiple command queues in OpenCL,\n"
+    << "                          ordered only by the images the kernels read and write\n"
+    << "                          Levels of a pyramid traversal are still launched one kernel at a time in program\n"
+    << "                          order; they are neither batched into one launch nor reordered by dependencies\n"
+    << "                          Valid values: 'on' and 'off'\n"
+    << "  -async-transfers <o>    Enable/disable non-blocking memory transfers on multiple command queues in OpenCL,\n"
+    << "                          implies -concurrent-kernels; reading an image waits only for the operations on that\n"
+    << "                          image. Host memory written to an image must not be modified before the image was\n"
+    << "                          read by the kernels using it, e.g. before their output was read\n"
+    << "                          Valid values: 'on' and 'off'\n"
     << "  -rs-package <string>    Specify Renderscript package name. (default: \"org.hipacc.rs\")\n"
     << "  -o <file>               Write output to <file>\n"
     << "  --help                  Display available options\n"
@@ -233,6 +259,16 @@ int main(int argc, char *argv[]) {
       compilerOptions.setTimeKernels(USER_ON);
       continue;
     }
+    if (StringRef(argv[i]) == "-tuning-db") {
+      assert(i<(argc-1) && "Mandatory file name for -tuning-db switch missing.");
+      compilerOptions.setTuningDB(argv[i+1]);
+      ++i;
+      continue;
+    }
+    if (StringRef(argv[i]) == "-specialize-sizes") {
+      compilerOptions.setSpecializeSizes(USER_ON);
+      continue;
+    }
     if (StringRef(argv[i]) == "-use-textures") {
       assert(i<(argc-1) && "Mandatory texture memory specification for -use-textures switch missing.");
       if (StringRef(argv[i+1]) == "off") {
@@ -273,6 +309,14 @@ int main(int argc, char *argv[]) {
         compilerOptions.setVectorizeKernels(USER_OFF);
       } else if (StringRef(argv[i+1]) == "on") {
         compilerOptions.setVectorizeKernels(USER_ON);
+      } else if (StringRef(argv[i+1]) == "sse4.2") {
+        compilerOptions.setVectorISA(ISA_SSE42);
+      } else if (StringRef(argv[i+1]) == "avx") {
+        compilerOptions.setVectorISA(ISA_AVX);
+      } else if (StringRef(argv[i+1]) == "avx2") {
+        compilerOptions.setVectorISA(ISA_AVX2);
+      } else if (StringRef(argv[i+1]) == "avx512") {
+        compilerOptions.setVectorISA(ISA_AVX512);
       } else {
         llvm::errs() << "ERROR: Expected valid vectorization specification for -use-vectorize switch.\n\n";
         printUsage();
@@ -295,6 +339,83 @@ int main(int argc, char *argv[]) {
       ++i;
       continue;
     }
+    if (StringRef(argv[i]) == "-threads") {
+      assert(i<(argc-1) && "Mandatory parameter for -threads switch missing.");
+      if (StringRef(argv[i+1]) == "auto") {
+        compilerOptions.setNumThreads(0);
+      } else {
+        std::istringstream buffer(argv[i+1]);
+        int val;
+        buffer >> val;
+        if (buffer.fail() || val < 1) {
+          llvm::errs() << "ERROR: Expected positive integer parameter or 'auto' for -threads switch.\n\n";
+          printUsage();
+          return EXIT_FAILURE;
+        }
+        compilerOptions.setNumThreads(val);
+      }
+      ++i;
+      continue;
+    }
+    if (StringRef(argv[i]) == "-fuse") {
+      assert(i<(argc-1) && "Mandatory fusion specification for -fuse switch missing.");
+      if (StringRef(argv[i+1]) == "off") {
+        compilerOptions.setFuseKernels(USER_OFF);
+      } else if (StringRef(argv[i+1]) == "on") {
+        compilerOptions.setFuseKernels(USER_ON);
+      } else if (StringRef(argv[i+1]) == "stream") {
+        compilerOptions.setFuseKernels(USER_ON);
+        compilerOptions.setStreamLines(USER_ON);
+      } else {
+        llvm::errs() << "ERROR: Expected valid fusion specification for -fuse switch.\n\n";
+        printUsage();
+        return EXIT_FAILURE;
+      }
+      ++i;
+      continue;
+    }
+    if (StringRef(argv[i]) == "-fuse-sampling") {
+      assert(i<(argc-1) && "Mandatory fusion specification for -fuse-sampling switch missing.");
+      if (StringRef(argv[i+1]) == "off") {
+        compilerOptions.setFuseSampling(USER_OFF);
+      } else if (StringRef(argv[i+1]) == "on") {
+        compilerOptions.setFuseSampling(USER_ON);
+      } else {
+        llvm::errs() << "ERROR: Expected valid fusion specification for -fuse-sampling switch.\n\n";
+        printUsage();
+        return EXIT_FAILURE;
+      }
+      ++i;
+      continue;
+    }
+    if (StringRef(argv[i]) == "-concurrent-kernels") {
+      assert(i<(argc-1) && "Mandatory specification for -concurrent-kernels switch missing.");
+      if (StringRef(argv[i+1]) == "off") {
+        compilerOptions.setConcurrentKernels(USER_OFF);
+      } else if (StringRef(argv[i+1]) == "on") {
+        compilerOptions.setConcurrentKernels(USER_ON);
+      } else {
+        llvm::errs() << "ERROR: Expected valid specification for -concurrent-kernels switch.\n\n";
+        printUsage();
+        return EXIT_FAILURE;
+      }
+      ++i;
+      continue;
+    }
+    if (StringRef(argv[i]) == "-async-transfers") {
+      assert(i<(argc-1) && "Mandatory specification for -async-transfers switch missing.");
+      if (StringRef(argv[i+1]) == "off") {
+        compilerOptions.setAsyncTransfers(USER_OFF);
+      } else if (StringRef(argv[i+1]) == "on") {
+        compilerOptions.setAsyncTransfers(USER_ON);
+      } else {
+        llvm::errs() << "ERROR: Expected valid specification for -async-transfers switch.\n\n";
+        printUsage();
+        return EXIT_FAILURE;
+      }
+      ++i;
+      continue;
+    }
     if (StringRef(argv[i]) == "-rs-package") {
       assert(i<(argc-1) && "Mandatory package name string for -rs-package switch missing.");
       compilerOptions.setRSPackageName(argv[i+1]);
@@ -397,6 +518,60 @@ int main(int argc, char *argv[]) {
     printUsage();
     return EXIT_FAILURE;
   }
+  // Instruction set selection only supported for C/C++
+  if (!compilerOptions.emitC() && compilerOptions.getVectorISA()!=ISA_Native) {
+    llvm::errs() << "Warning: instruction set selection is only supported for C/C++ code generation!"
+                 << "  Using '-vectorize on' instead!\n";
+    compilerOptions.setVectorISA(ISA_Native);
+  }
+  // Multi-threading only supported for C/C++
+  if (!compilerOptions.emitC() && compilerOptions.useThreads()) {
+    llvm::errs() << "Warning: multi-threading is only supported for C/C++ code generation!"
+                 << "  Ignoring -threads switch!\n";
+    compilerOptions.setNumThreads(1);
+  }
+  // Kernel fusion only supported for C/C++
+  if (compilerOptions.fuseKernels() && (!compilerOptions.emitC() ||
+        compilerOptions.exploreConfig() || compilerOptions.timeKernels())) {
+    llvm::errs() << "Warning: kernel fusion is only supported for C/C++ code generation without exploration or timing!"
+                 << "  Ignoring -fuse switch!\n";
+    compilerOptions.setFuseKernels(USER_OFF);
+    compilerOptions.setStreamLines(USER_OFF);
+  }
+  // Asynchronous transfers only supported for OpenCL; kernel launches must
+  // not wait for all pending transfers
+  if (compilerOptions.asyncTransfers()) {
+    if (!compilerOptions.emitOpenCL() || compilerOptions.exploreConfig() ||
+        compilerOptions.timeKernels()) {
+      llvm::errs() << "Warning: asynchronous memory transfers are only supported for OpenCL code generation without exploration or timing!"
+                   << "  Ignoring -async-transfers switch!\n";
+      compilerOptions.setAsyncTransfers(USER_OFF);
+    } else {
+      compilerOptions.setConcurrentKernels(USER_ON);
+    }
+  }
+  // Concurrent kernel launches only supported for OpenCL
+  if (compilerOptions.concurrentKernels() && (!compilerOptions.emitOpenCL() ||
+        compilerOptions.exploreConfig() || compilerOptions.timeKernels())) {
+    llvm::errs() << "Warning: concurrent kernel launches are only supported for OpenCL code generation without exploration or timing!"
+                 << "  Ignoring -concurrent-kernels switch!\n";
+    compilerOptions.setConcurrentKernels(USER_OFF);
+  }
+  // Tuning database only supported for CUDA/OpenCL
+  if (compilerOptions.useTuningDB() && !(compilerOptions.emitCUDA() ||
+        compilerOptions.emitOpenCL())) {
+    llvm::errs() << "Warning: tuning database is only supported for CUDA/OpenCL code generation!"
+                 << "  Ignoring -tuning-db switch!\n";
+    compilerOptions.setTuningDB("");
+  }
+  // Renderscript kernels get the image geometry from the allocation
+  if (compilerOptions.specializeSizes() &&
+      (compilerOptions.emitRenderscript() ||
+       compilerOptions.emitFilterscript())) {
+    llvm::errs() << "Warning: specialization of image sizes is not supported for Renderscript/Filterscript!"
+                 << "  Ignoring -specialize-sizes switch!\n";
+    compilerOptions.setSpecializeSizes(USER_OFF);
+  }
   if (compilerOptions.timeKernels(USER_ON) &&
       compilerOptions.exploreConfig(USER_ON)) {
     // kernels are timed internally by the runtime in case of exploration
@@ -217,7 +217,7 @@ class AccessorBase {
     protected:
         const int width, height;
         const int offset_x, offset_y;
-        ElementIterator *EI;
+        HipaccPerThread<ElementIterator *> EI;
 
         virtual void setEI(ElementIterator *ei) {
             // TODO: enable this again for debugging
@@ -238,6 +238,8 @@ class AccessorBase {
             EI(nullptr)
         {}
 
+        virtual ~AccessorBase() {}
+
     template<typename> friend class Kernel;
 };
 
@@ -254,8 +256,18 @@ class Accessor : public AccessorBase, BoundaryCondition<data_t> {
         using BoundaryCondition<data_t>::clamp;
 
         virtual data_t &interpolate(int x, int y, int xf=0, int yf=0) {
-            return getPixelBH(EI->getX() - EI->getOffsetX() + offset_x + xf,
-                    EI->getY() - EI->getOffsetY() + offset_y + yf);
+            return getPixelBH(x - EI->getOffsetX() + offset_x + xf,
+                    y - EI->getOffsetY() + offset_y + yf);
+        }
+
+        // resolve the access without interpolation, unless the Accessor
+        // maps the iteration space to the image
+        data_t &access(int xf, int yf) {
+            ElementIterator *ei = EI;
+            assert(ei && "ElementIterator not set!");
+            if (mapped) return interpolate(ei->getX(), ei->getY(), xf, yf);
+            return getPixelBH(ei->getX() - ei->getOffsetX() + offset_x + xf,
+                    ei->getY() - ei->getOffsetY() + offset_y + yf);
         }
 
         // used by output Accessor: outputAtPixel(x, y)
@@ -268,6 +280,12 @@ class Accessor : public AccessorBase, BoundaryCondition<data_t> {
         }
 
         data_t &getPixelBH(int x, int y) {
+            // pixels inside the Accessor are the same for all boundary modes
+            if ((unsigned)(x - offset_x) < (unsigned)width &&
+                (unsigned)(y - offset_y) < (unsigned)height) {
+                return img.getPixel(x, y);
+            }
+
             data_t *ret = &dummy;
 
             switch (mode) {
@@ -296,7 +314,6 @@ class Accessor : public AccessorBase, BoundaryCondition<data_t> {
                 case BOUNDARY_CONSTANT:
                     if (x < offset_x || y < offset_y || x >=
                             offset_x+width || y >= offset_y+height) {
-                        dummy = const_val;
                         ret = &dummy;
                     } else {
                         ret = &img.getPixel(x, y);
@@ -308,41 +325,46 @@ class Accessor : public AccessorBase, BoundaryCondition<data_t> {
         }
 
 
+    protected:
+        // set by Accessors that interpolate
+        bool mapped;
+
     public:
         Accessor(Image<data_t> &Img) :
             AccessorBase(Img.getWidth(), Img.getHeight(), 0, 0),
-            BoundaryCondition<data_t>(BoundaryCondition<data_t>(Img, 0, 0, BOUNDARY_CLAMP))
+            BoundaryCondition<data_t>(BoundaryCondition<data_t>(Img, 0, 0, BOUNDARY_CLAMP)),
+            mapped(false)
         {}
 
         Accessor(Image<data_t> &Img, int width, int height, int xf, int yf) :
             AccessorBase(width, height, xf, yf),
-            BoundaryCondition<data_t>(BoundaryCondition<data_t>(Img, 0, 0, BOUNDARY_CLAMP))
+            BoundaryCondition<data_t>(BoundaryCondition<data_t>(Img, 0, 0, BOUNDARY_CLAMP)),
+            mapped(false)
         {}
 
         Accessor(BoundaryCondition<data_t> &BC) :
             AccessorBase(BC.img.getWidth(), BC.img.getHeight(), 0, 0),
-            BoundaryCondition<data_t>(BC)
+            BoundaryCondition<data_t>(BC),
+            mapped(false)
         {}
 
         Accessor(BoundaryCondition<data_t> &BC, int width, int height, int xf,
                 int yf) :
             AccessorBase(width, height, xf, yf),
-            BoundaryCondition<data_t>(BC)
+            BoundaryCondition<data_t>(BC),
+            mapped(false)
         {}
 
         data_t &operator()(void) {
-            assert(EI && "ElementIterator not set!");
-            return interpolate(EI->getX(), EI->getY());
+            return access(0, 0);
         }
 
         data_t &operator()(const int xf, const int yf) {
-            assert(EI && "ElementIterator not set!");
-            return interpolate(EI->getX(), EI->getY(), xf, yf);
+            return access(xf, yf);
         }
 
         data_t &operator()(MaskBase &M) {
-            assert(EI && "ElementIterator not set!");
-            return interpolate(EI->getX(), EI->getY(), M.getX(), M.getY());
+            return access(M.getX(), M.getY());
         }
 
 
@@ -406,6 +428,7 @@ class AccessorNN : public Accessor<data_t> {
         using Accessor<data_t>::offset_x;
         using Accessor<data_t>::offset_y;
         using Accessor<data_t>::EI;
+        using Accessor<data_t>::mapped;
         using Accessor<data_t>::getPixel;
         using Accessor<data_t>::getPixelBH;
 
@@ -426,21 +449,29 @@ class AccessorNN : public Accessor<data_t> {
 
         AccessorNN(Image<data_t> &Img) :
             Accessor<data_t>(Img)
-        {}
+        {
+            mapped = true;
+        }
 
         AccessorNN(Image<data_t> &Img, int width, int height, int xf=0, int
                 yf=0) :
             Accessor<data_t>(Img, width, height, xf, yf)
-        {}
+        {
+            mapped = true;
+        }
 
         AccessorNN(BoundaryCondition<data_t> &BC) :
             Accessor<data_t>(BC)
-        {}
+        {
+            mapped = true;
+        }
 
         AccessorNN(BoundaryCondition<data_t> &BC, int width, int height, int
                 xf=0, int yf=0) :
             Accessor<data_t>(BC, width, height, xf, yf)
-        {}
+        {
+            mapped = true;
+        }
 
         int getX(void) {
             assert(EI && "ElementIterator not set!");
@@ -471,11 +502,11 @@ class AccessorLF : public Accessor<data_t> {
         using Accessor<data_t>::offset_x;
         using Accessor<data_t>::offset_y;
         using Accessor<data_t>::EI;
+        using Accessor<data_t>::mapped;
         using Accessor<data_t>::getPixel;
         using Accessor<data_t>::getPixelBH;
-        // dummy reference to return a reference for interpolation
-        data_t interpol_init;
-        data_t &interpol_val;
+        // per-thread value to return a reference for interpolation
+        HipaccPerThread<data_t> interpol_val;
 
         void setEI(ElementIterator *ei) { EI = ei; }
 
@@ -518,29 +549,33 @@ class AccessorLF : public Accessor<data_t> {
 
         AccessorLF(Image<data_t> &Img) :
             Accessor<data_t>(Img),
-            interpol_init(0),
-            interpol_val(interpol_init)
-        {}
+            interpol_val(0)
+        {
+            mapped = true;
+        }
 
         AccessorLF(Image<data_t> &Img, int width, int height, int xf=0, int
                 yf=0) :
             Accessor<data_t>(Img, width, height, xf, yf),
-            interpol_init(0),
-            interpol_val(interpol_init)
-        {}
+            interpol_val(0)
+        {
+            mapped = true;
+        }
 
         AccessorLF(BoundaryCondition<data_t> &BC) :
             Accessor<data_t>(BC),
-            interpol_init(0),
-            interpol_val(interpol_init)
-        {}
+            interpol_val(0)
+        {
+            mapped = true;
+        }
 
         AccessorLF(BoundaryCondition<data_t> &BC, int width, int height, int
                 xf=0, int yf=0) :
             Accessor<data_t>(BC, width, height, xf, yf),
-            interpol_init(0),
-            interpol_val(interpol_init)
-        {}
+            interpol_val(0)
+        {
+            mapped = true;
+        }
 
         int getX(void) {
             assert(EI && "ElementIterator not set!");
@@ -571,11 +606,11 @@ class AccessorCF : public Accessor<data_t> {
         using Accessor<data_t>::offset_x;
         using Accessor<data_t>::offset_y;
         using Accessor<data_t>::EI;
+        using Accessor<data_t>::mapped;
         using Accessor<data_t>::getPixel;
         using Accessor<data_t>::getPixelBH;
-        // dummy reference to return a reference for interpolation
-        data_t interpol_init;
-        data_t &interpol_val;
+        // per-thread value to return a reference for interpolation
+        HipaccPerThread<data_t> interpol_val;
 
         void setEI(ElementIterator *ei) { EI = ei; }
 
@@ -684,29 +719,33 @@ class AccessorCF : public Accessor<data_t> {
 
         AccessorCF(Image<data_t> &Img) :
             Accessor<data_t>(Img),
-            interpol_init(0),
-            interpol_val(interpol_init)
-        {}
+            interpol_val(0)
+        {
+            mapped = true;
+        }
 
         AccessorCF(Image<data_t> &Img, int width, int height, int xf=0, int
                 yf=0) :
             Accessor<data_t>(Img, width, height, xf, yf),
-            interpol_init(0),
-            interpol_val(interpol_init)
-        {}
+            interpol_val(0)
+        {
+            mapped = true;
+        }
 
         AccessorCF(BoundaryCondition<data_t> &BC) :
             Accessor<data_t>(BC),
-            interpol_init(0),
-            interpol_val(interpol_init)
-        {}
+            interpol_val(0)
+        {
+            mapped = true;
+        }
 
         AccessorCF(BoundaryCondition<data_t> &BC, int width, int height, int
                 xf=0, int yf=0) :
             Accessor<data_t>(BC, width, height, xf, yf),
-            interpol_init(0),
-            interpol_val(interpol_init)
-        {}
+            interpol_val(0)
+        {
+            mapped = true;
+        }
 
         int getX(void) {
             assert(EI && "ElementIterator not set!");
@@ -737,11 +776,11 @@ class AccessorL3 : public Accessor<data_t> {
         using Accessor<data_t>::offset_x;
         using Accessor<data_t>::offset_y;
         using Accessor<data_t>::EI;
+        using Accessor<data_t>::mapped;
         using Accessor<data_t>::getPixel;
         using Accessor<data_t>::getPixelBH;
-        // dummy reference to return a reference for interpolation
-        data_t interpol_init;
-        data_t &interpol_val;
+        // per-thread value to return a reference for interpolation
+        HipaccPerThread<data_t> interpol_val;
 
         void setEI(ElementIterator *ei) { EI = ei; }
 
@@ -841,29 +880,33 @@ class AccessorL3 : public Accessor<data_t> {
 
         AccessorL3(Image<data_t> &Img) :
             Accessor<data_t>(Img),
-            interpol_init(0),
-            interpol_val(interpol_init)
-        {}
+            interpol_val(0)
+        {
+            mapped = true;
+        }
 
         AccessorL3(Image<data_t> &Img, int width, int height, int xf=0, int
                 yf=0) :
             Accessor<data_t>(Img, width, height, xf, yf),
-            interpol_init(0),
-            interpol_val(interpol_init)
-        {}
+            interpol_val(0)
+        {
+            mapped = true;
+        }
 
         AccessorL3(BoundaryCondition<data_t> &BC) :
             Accessor<data_t>(BC),
-            interpol_init(0),
-            interpol_val(interpol_init)
-        {}
+            interpol_val(0)
+        {
+            mapped = true;
+        }
 
         AccessorL3(BoundaryCondition<data_t> &BC, int width, int height, int
                 xf=0, int yf=0) :
             Accessor<data_t>(BC, width, height, xf, yf),
-            interpol_init(0),
-            interpol_val(interpol_init)
-        {}
+            interpol_val(0)
+        {
+            mapped = true;
+        }
 
         int getX(void) {
             assert(EI && "ElementIterator not set!");
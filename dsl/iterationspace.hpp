@@ -30,10 +30,50 @@
 
 #include "image.hpp"
 
+#ifndef HIPACC_MAX_THREADS
+#define HIPACC_MAX_THREADS 64
+#endif
+
 namespace hipacc {
 // forward declaration
 template<typename data_t> class Image;
 
+// index of the worker executing the current band of a Kernel
+inline int &hipacc_thread_index() {
+    static thread_local int index = 0;
+    return index;
+}
+
+// state that is shared by all pixels of a band, but private to the worker
+// thread processing that band; slots are padded to separate cache lines
+template<typename T>
+class HipaccPerThread {
+    private:
+        struct Slot {
+            T val;
+            char pad[64 - sizeof(T) % 64];
+        };
+        Slot slots[HIPACC_MAX_THREADS];
+
+    public:
+        HipaccPerThread() {
+            for (int i=0; i<HIPACC_MAX_THREADS; ++i) slots[i].val = T();
+        }
+
+        template<typename V>
+        explicit HipaccPerThread(const V &init) {
+            for (int i=0; i<HIPACC_MAX_THREADS; ++i) slots[i].val = T(init);
+        }
+
+        T &get() { return slots[hipacc_thread_index()].val; }
+        operator T &() { return get(); }
+        T operator->() { return get(); }
+        HipaccPerThread &operator=(const T &val) {
+            get() = val;
+            return *this;
+        }
+};
+
 class Coordinate {
     public:
         int x, y;
@@ -71,6 +111,7 @@ class IterationSpaceBase {
                 int max_x, max_y;
                 const IterationSpaceBase *iteration_space;
                 Coordinate coord;
+                int last_y;
 
             public:
                 ElementIterator(int width=0, int height=0, int offset_x=0, int
@@ -81,7 +122,23 @@ class IterationSpaceBase {
                     max_x(offset_x+width),
                     max_y(offset_y+height),
                     iteration_space(iteration_space),
-                    coord(offset_x, offset_y)
+                    coord(offset_x, offset_y),
+                    last_y(offset_y+height)
+                {}
+
+                // iterate only over rows [first_y, last_y) of the iteration
+                // space, but report the geometry of the whole space
+                ElementIterator(int width, int height, int offset_x, int
+                        offset_y, int first_y, int last_y, const
+                        IterationSpaceBase *iteration_space) :
+                    min_x(offset_x),
+                    min_y(offset_y),
+                    max_x(offset_x+width),
+                    max_y(offset_y+height),
+                    iteration_space(first_y < last_y ? iteration_space :
+                            nullptr),
+                    coord(offset_x, offset_y+first_y),
+                    last_y(offset_y+last_y)
                 {}
 
                 // increment so we iterate over elements in a block
@@ -91,7 +148,7 @@ class IterationSpaceBase {
                         if (coord.x >= max_x) {
                             coord.x = min_x;
                             coord.y++;
-                            if (coord.y >= max_y) {
+                            if (coord.y >= last_y) {
                                 iteration_space = nullptr;
                             }
                         }
@@ -112,6 +169,10 @@ class IterationSpaceBase {
         ElementIterator begin() const {
             return ElementIterator(width, height, offset_x, offset_y, this);
         }
+        ElementIterator begin(int first_y, int last_y) const {
+            return ElementIterator(width, height, offset_x, offset_y, first_y,
+                    last_y, this);
+        }
         ElementIterator end() const { return ElementIterator(); }
 
         int getWidth() const { return width; }
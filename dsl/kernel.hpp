@@ -28,6 +28,9 @@
 #ifndef __KERNEL_HPP__
 #define __KERNEL_HPP__
 
+#include <cstdlib>
+#include <cstring>
+#include <thread>
 #include <vector>
 
 #include "iterationspace.hpp"
@@ -42,15 +45,47 @@ double hipacc_time_ms() {
     return ((double)(tv.tv_sec) * 1e+3 + (double)(tv.tv_usec) * 1e-3);
 }
 
+// number of threads used to execute a Kernel: 1 unless set by
+// HIPACC_NUM_THREADS to n or to 'auto' for the hardware concurrency
+int hipacc_num_threads() {
+    const char *env = getenv("HIPACC_NUM_THREADS");
+    if (!env) return 1;
 
+    int num_threads = strcmp(env, "auto") ?
+        atoi(env) : (int)std::thread::hardware_concurrency();
+    return std::max(1, std::min(num_threads, HIPACC_MAX_THREADS));
+}
+
+
+// Kernels are executed serially unless HIPACC_NUM_THREADS is set. Then the
+// iteration space is split into bands of rows, which are executed by several
+// threads on the same Kernel object: kernel() must not modify members of the
+// kernel class. Kernels that do have to call setSerialExecution().
 template<typename data_t>
 class Kernel {
     private:
         const IterationSpace<data_t> &iteration_space;
         Accessor<data_t> outImgAcc;
-        ElementIterator iter;
+        HipaccPerThread<ElementIterator *> iter;
         std::vector<AccessorBase *> images;
         data_t reduction_result;
+        bool serial_execution;
+
+        // select the (upper) median using min/max only, which works
+        // component-wise for vector types
+        template <typename T>
+        static T median(std::vector<T> &values) {
+            size_t n = values.size();
+            for (size_t i=0; i<=n/2; ++i) {
+                for (size_t j=n-1; j>i; --j) {
+                    T lo = hipacc::math::min(values[j-1], values[j]);
+                    T hi = hipacc::math::max(values[j-1], values[j]);
+                    values[j-1] = lo;
+                    values[j] = hi;
+                }
+            }
+            return values[n/2];
+        }
 
     public:
         Kernel(IterationSpace<data_t> &iteration_space) :
@@ -59,7 +94,8 @@ class Kernel {
                         iteration_space.getWidth(), iteration_space.getHeight(),
                         iteration_space.getOffsetX(),
                         iteration_space.getOffsetY()),
-            iter()
+            iter(nullptr),
+            serial_execution(false)
         {}
 
         virtual ~Kernel() {}
@@ -67,29 +103,57 @@ class Kernel {
         virtual data_t reduce(data_t left, data_t right) { return left; }
 
         void addAccessor(AccessorBase *Acc) { images.push_back(Acc); }
+        void setSerialExecution(bool serial=true) { serial_execution = serial; }
 
         void execute() {
             double time0, time1;
+            int height = iteration_space.getHeight();
+            int num_threads = std::min(hipacc_num_threads(), std::max(1, height));
+            if (serial_execution) num_threads = 1;
+
+            // apply kernel to whole iteration space, split into bands of rows
+            time0 = hipacc_time_ms();
+            if (num_threads == 1) {
+                executeBand(0, 0, height);
+            } else {
+                std::vector<std::thread> workers;
+                for (int t=1; t<num_threads; ++t) {
+                    workers.push_back(std::thread(&Kernel::executeBand, this,
+                                t, t*height/num_threads,
+                                (t+1)*height/num_threads));
+                }
+                executeBand(0, 0, height/num_threads);
+                for (size_t t=0; t<workers.size(); ++t) {
+                    workers[t].join();
+                }
+            }
+            time1 = hipacc_time_ms();
+            hipacc_last_timing = time1 - time0;
+
+            // apply reduction
+            reduce();
+        }
+
+        void executeBand(int index, int first_y, int last_y) {
+            hipacc_thread_index() = index;
             ElementIterator end = iteration_space.end();
-            iter = iteration_space.begin();
+            ElementIterator band = iteration_space.begin(first_y, last_y);
+            iter = &band;
 
             // register input accessors
             for (std::vector<AccessorBase *>::iterator ei=images.begin(), ie=images.end();
                     ei!=ie; ++ei) {
                 AccessorBase *Acc = *ei;
-                Acc->setEI(&iter);
+                Acc->setEI(&band);
             }
             // register output accessors
-            outImgAcc.setEI(&iter);
+            outImgAcc.setEI(&band);
 
-            // advance iterator and apply kernel to whole iteration space
-            time0 = hipacc_time_ms();
-            while (iter != end) {
+            // advance iterator and apply kernel to the band
+            while (band != end) {
                 kernel();
-                ++iter;
+                ++band;
             }
-            time1 = hipacc_time_ms();
-            hipacc_last_timing = time1 - time0;
 
             // de-register input accessors
             for (std::vector<AccessorBase*>::iterator ei=images.begin(), ie=images.end();
@@ -101,10 +165,8 @@ class Kernel {
             outImgAcc.setEI(nullptr);
 
             // reset kernel iterator
-            iter = ElementIterator();
-
-            // apply reduction
-            reduce();
+            iter = nullptr;
+            hipacc_thread_index() = 0;
         }
 
         void reduce(void) {
@@ -147,13 +209,13 @@ class Kernel {
         }
 
         int getX(void) {
-            assert(iter!=ElementIterator() && "ElementIterator not set!");
-            return iter.getX() - iter.getOffsetX();
+            assert(iter && "ElementIterator not set!");
+            return iter->getX() - iter->getOffsetX();
         }
 
         int getY(void) {
-            assert(iter!=ElementIterator() && "ElementIterator not set!");
-            return iter.getY() - iter.getOffsetY();
+            assert(iter && "ElementIterator not set!");
+            return iter->getY() - iter->getOffsetY();
         }
 
         // built-in functions: convolve, iterate, and reduce
@@ -174,6 +236,18 @@ auto Kernel<data_t>::convolve(Mask<data_m> &mask, HipaccConvolutionMode mode, co
     // register mask
     mask.setEI(&iter);
 
+    // median: collect values of all iterations
+    if (mode == HipaccMEDIAN) {
+        std::vector<decltype(fun())> values;
+        while (iter != end) {
+            values.push_back(fun());
+            ++iter;
+        }
+        mask.setEI(nullptr);
+
+        return median(values);
+    }
+
     // initialize result - calculate first iteration
     auto result = fun();
     ++iter;
@@ -200,7 +274,7 @@ auto Kernel<data_t>::convolve(Mask<data_m> &mask, HipaccConvolutionMode mode, co
                 result *= fun();
                 break;
             case HipaccMEDIAN:
-                assert(0 && "HipaccMEDIAN not implemented yet!");
+                // handled above
                 break;
         }
         ++iter;
@@ -222,6 +296,18 @@ auto Kernel<data_t>::reduce(Domain &domain, HipaccConvolutionMode mode,
     // register domain
     domain.setDI(&iter);
 
+    // median: collect values of all iterations
+    if (mode == HipaccMEDIAN) {
+        std::vector<decltype(fun())> values;
+        while (iter != end) {
+            values.push_back(fun());
+            ++iter;
+        }
+        domain.setDI(nullptr);
+
+        return median(values);
+    }
+
     // initialize result - calculate first iteration
     auto result = fun();
     ++iter;
@@ -246,7 +332,7 @@ auto Kernel<data_t>::reduce(Domain &domain, HipaccConvolutionMode mode,
                 result *= fun();
                 break;
             case HipaccMEDIAN:
-                assert(0 && "HipaccMEDIAN not implemented yet!");
+                // handled above
                 break;
         }
         ++iter;
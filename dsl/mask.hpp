@@ -154,7 +154,7 @@ class Domain : public MaskBase {
         };
 
     protected:
-        DomainIterator *DI;
+        HipaccPerThread<DomainIterator *> DI;
 
     public:
         Domain(int size_x, int size_y) :
@@ -237,7 +237,7 @@ class Domain : public MaskBase {
 template<typename data_t>
 class Mask : public MaskBase {
     private:
-        ElementIterator *EI;
+        HipaccPerThread<ElementIterator *> EI;
         data_t *array;
 
         template <int size_y, int size_x>
@@ -268,6 +268,7 @@ class Mask : public MaskBase {
 
         Mask(const Mask &mask) :
             MaskBase(mask.size_x, mask.size_y),
+            EI(nullptr),
             array(new data_t[mask.size_x*mask.size_y])
         {
             init(mask.array);
@@ -291,7 +292,8 @@ class Mask : public MaskBase {
 
         data_t &operator()(void) {
             assert(EI && "ElementIterator for Mask not set!");
-            return array[(EI->getY()-offset_y)*size_x + EI->getX()-offset_x];
+            ElementIterator *ei = EI;
+            return array[(ei->getY()-offset_y)*size_x + ei->getX()-offset_x];
         }
         data_t &operator()(const int xf, const int yf) {
             return array[(yf-offset_y)*size_x + xf-offset_x];
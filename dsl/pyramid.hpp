@@ -189,7 +189,7 @@ class Recursion {
 
     void run(int loop) {
       std::vector<PyramidBase*> pyrs = gPyramids.back();
-      if (pyrs.at(0)->getLevel() < pyrs.at(0)->getDepth()-1) {
+      if (pyrs.at(0)->getLevel() < pyrs.at(0)->getDepth()) {
         for (int i = 0; i < loop; i++) {
           (*gTraverse.back())();
           if (i < loop-1) {
@@ -26,6 +26,8 @@
 #ifndef __TYPES_HPP__
 #define __TYPES_HPP__
 
+#include <limits>
+
 namespace hipacc {
 
 enum HipaccConvolutionMode {
@@ -57,6 +59,10 @@ typedef unsigned long       ulong;
     MAKE_MOP(NEW_TYPE, BASIC_TYPE)
 #define MAKE_VEC_I(NEW_TYPE, BASIC_TYPE, RET_TYPE) \
     MAKE_VEC_F(NEW_TYPE, BASIC_TYPE, RET_TYPE)
+#define MAKE_CONV_FUNC(BASIC_TYPE, RET_TYPE, VEC_TYPE) \
+    MAKE_CONV_CMP(BASIC_TYPE, RET_TYPE, VEC_TYPE)
+#define MAKE_CONV_SAT_FUNC(BASIC_TYPE, RET_TYPE, VEC_TYPE, MIN, MAX) \
+    MAKE_CONV_SAT_CMP(BASIC_TYPE, RET_TYPE, VEC_TYPE, MIN, MAX)
 #elif defined __GNUC__
 typedef unsigned char       uchar;
 typedef unsigned short      ushort;
@@ -64,23 +70,41 @@ typedef unsigned int        uint;
 typedef unsigned long       ulong;
 #define ATTRIBUTES inline
 #define MAKE_VEC_F(NEW_TYPE, BASIC_TYPE, RET_TYPE) \
-    MAKE_TYPE(NEW_TYPE, BASIC_TYPE) \
+    MAKE_SIMD_TYPE(NEW_TYPE, BASIC_TYPE) \
     MAKE_VMOP(NEW_TYPE, BASIC_TYPE) \
     MAKE_MOP(NEW_TYPE, BASIC_TYPE) \
-    MAKE_VOPS_A(NEW_TYPE, BASIC_TYPE, RET_TYPE)
+    MAKE_SIMD_OPS_A(NEW_TYPE, BASIC_TYPE, RET_TYPE)
 #define MAKE_VEC_I(NEW_TYPE, BASIC_TYPE, RET_TYPE) \
     MAKE_VEC_F(NEW_TYPE, BASIC_TYPE, RET_TYPE) \
-    MAKE_VOPS_I(NEW_TYPE, BASIC_TYPE, RET_TYPE)
+    MAKE_SIMD_OPS_I(NEW_TYPE, BASIC_TYPE, RET_TYPE)
+// __builtin_convertvector is available since GCC 9
+#if __GNUC__ >= 9
+#define MAKE_CONV_FUNC(BASIC_TYPE, RET_TYPE, VEC_TYPE) \
+    MAKE_CONV_SIMD(BASIC_TYPE, RET_TYPE, VEC_TYPE)
+#define MAKE_CONV_SAT_FUNC(BASIC_TYPE, RET_TYPE, VEC_TYPE, MIN, MAX) \
+    MAKE_CONV_SAT_SIMD(BASIC_TYPE, RET_TYPE, VEC_TYPE, MIN, MAX)
+#else
+#define MAKE_CONV_FUNC(BASIC_TYPE, RET_TYPE, VEC_TYPE) \
+    MAKE_CONV_CMP(BASIC_TYPE, RET_TYPE, VEC_TYPE)
+#define MAKE_CONV_SAT_FUNC(BASIC_TYPE, RET_TYPE, VEC_TYPE, MIN, MAX) \
+    MAKE_CONV_SAT_CMP(BASIC_TYPE, RET_TYPE, VEC_TYPE, MIN, MAX)
+#endif
 #else
 #error "Only Clang, and gcc compilers supported!"
 #endif
 
 
-// vector type definition
-#define MAKE_TYPE(NEW_TYPE, BASIC_TYPE) \
-_Pragma("pack(1)") \
+// vector type definition: the components share storage with a GCC vector of
+// natural alignment, limited to the 16 bytes guaranteed by malloc, so that
+// operations on pixels map to SIMD instructions
+#define MAKE_SIMD_TYPE(NEW_TYPE, BASIC_TYPE) \
+typedef BASIC_TYPE NEW_TYPE##_simd __attribute__ ((vector_size(4*sizeof(BASIC_TYPE)), \
+    aligned(4*sizeof(BASIC_TYPE) < 16 ? 4*sizeof(BASIC_TYPE) : 16))); \
 struct NEW_TYPE { \
-    BASIC_TYPE x, y, z, w; \
+    union { \
+        struct { BASIC_TYPE x, y, z, w; }; \
+        NEW_TYPE##_simd v; \
+    }; \
     void operator=(BASIC_TYPE b) { \
         x = b; y = b; z = b; w = b; \
     } \
@@ -88,206 +112,85 @@ struct NEW_TYPE { \
 typedef struct NEW_TYPE NEW_TYPE;
 
 
-// make function
-#define MAKE_VMOP(NEW_TYPE, BASIC_TYPE) \
-static ATTRIBUTES NEW_TYPE make_##NEW_TYPE(BASIC_TYPE x, BASIC_TYPE y, BASIC_TYPE z, BASIC_TYPE w) { \
-    NEW_TYPE t; t.x = x; t.y = y; t.z = z; t.w = w; return t; \
-}
-
-#define MAKE_MOP(NEW_TYPE, BASIC_TYPE) \
-static ATTRIBUTES NEW_TYPE make_##NEW_TYPE(BASIC_TYPE s) \
-{ \
-    return make_##NEW_TYPE(s, s, s, s); \
-}
-
-
-// vector operators for all data types
-#define MAKE_VOPS_A(NEW_TYPE, BASIC_TYPE, RET_TYPE) \
- \
- /* binary operator: add */ \
- \
-ATTRIBUTES NEW_TYPE operator+(NEW_TYPE a, NEW_TYPE b) { \
-    return make_##NEW_TYPE(a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w); \
-} \
-ATTRIBUTES NEW_TYPE operator+(NEW_TYPE a, BASIC_TYPE b) { \
-    return make_##NEW_TYPE(a.x + b, a.y + b, a.z + b, a.w + b); \
-} \
-ATTRIBUTES NEW_TYPE operator+(BASIC_TYPE a, NEW_TYPE b) { \
-    return make_##NEW_TYPE(a + b.x, a + b.y, a + b.z, a + b.w); \
-} \
-ATTRIBUTES void operator+=(NEW_TYPE &a, NEW_TYPE b) { \
-    a.x += b.x; a.y += b.y; a.z += b.z; a.w += b.w; \
-} \
-ATTRIBUTES void operator+=(NEW_TYPE a, BASIC_TYPE b) { \
-    a.x += b, a.y += b, a.z += b, a.w += b; \
-} \
- \
- /* binary operator: subtract */ \
- \
-ATTRIBUTES NEW_TYPE operator-(NEW_TYPE a, NEW_TYPE b) { \
-    return make_##NEW_TYPE(a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w); \
+// arithmetic operator and its compound assignment on SIMD vectors
+#define MAKE_SIMD_BOP(NEW_TYPE, BASIC_TYPE, OP) \
+ATTRIBUTES NEW_TYPE operator OP(NEW_TYPE a, NEW_TYPE b) { \
+    NEW_TYPE t; t.v = a.v OP b.v; return t; \
 } \
-ATTRIBUTES NEW_TYPE operator-(NEW_TYPE a, BASIC_TYPE b) { \
-    return make_##NEW_TYPE(a.x - b, a.y - b, a.z - b, a.w - b); \
+ATTRIBUTES NEW_TYPE operator OP(NEW_TYPE a, BASIC_TYPE b) { \
+    return a OP make_##NEW_TYPE(b); \
 } \
-ATTRIBUTES NEW_TYPE operator-(BASIC_TYPE a, NEW_TYPE b) { \
-    return make_##NEW_TYPE(a - b.x, a - b.y, a - b.z, a - b.w); \
+ATTRIBUTES NEW_TYPE operator OP(BASIC_TYPE a, NEW_TYPE b) { \
+    return make_##NEW_TYPE(a) OP b; \
 } \
-ATTRIBUTES void operator-=(NEW_TYPE &a, NEW_TYPE b) { \
-    a.x -= b.x; a.y -= b.y; a.z -= b.z; a.w -= b.w; \
+ATTRIBUTES void operator OP##=(NEW_TYPE &a, NEW_TYPE b) { \
+    a.v = a.v OP b.v; \
 } \
-ATTRIBUTES void operator-=(NEW_TYPE a, BASIC_TYPE b) { \
-    a.x -= b, a.y -= b, a.z -= b, a.w -= b; \
-} \
- \
- /* binary operator: multiply */ \
- \
-ATTRIBUTES NEW_TYPE operator*(NEW_TYPE a, NEW_TYPE b) { \
-    return make_##NEW_TYPE(a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w); \
-} \
-ATTRIBUTES NEW_TYPE operator*(NEW_TYPE a, BASIC_TYPE b) { \
-    return make_##NEW_TYPE(a.x * b, a.y * b, a.z * b, a.w * b); \
+ATTRIBUTES void operator OP##=(NEW_TYPE &a, BASIC_TYPE b) { \
+    a.v = a.v OP make_##NEW_TYPE(b).v; \
+}
+
+// relational operator on SIMD vectors, true components are -1 like for
+// OpenCL and Clang vectors
+#define MAKE_SIMD_ROP(NEW_TYPE, BASIC_TYPE, RET_TYPE, OP) \
+ATTRIBUTES RET_TYPE operator OP(NEW_TYPE a, NEW_TYPE b) { \
+    RET_TYPE t; t.v = (RET_TYPE##_simd)(a.v OP b.v); return t; \
 } \
-ATTRIBUTES NEW_TYPE operator*(BASIC_TYPE a, NEW_TYPE b) { \
-    return make_##NEW_TYPE(a * b.x, a * b.y, a * b.z, a * b.w); \
+ATTRIBUTES RET_TYPE operator OP(NEW_TYPE a, BASIC_TYPE b) { \
+    return a OP make_##NEW_TYPE(b); \
 } \
-ATTRIBUTES void operator*=(NEW_TYPE &a, NEW_TYPE b) { \
-    a.x *= b.x; a.y *= b.y; a.z *= b.z; a.w *= b.w; \
+ATTRIBUTES RET_TYPE operator OP(BASIC_TYPE a, NEW_TYPE b) { \
+    return make_##NEW_TYPE(a) OP b; \
+}
+
+// logical operator on SIMD vectors
+#define MAKE_SIMD_LOP(NEW_TYPE, BASIC_TYPE, RET_TYPE, OP, BOP) \
+ATTRIBUTES RET_TYPE operator OP(NEW_TYPE a, NEW_TYPE b) { \
+    NEW_TYPE##_simd zero = make_##NEW_TYPE(0).v; \
+    RET_TYPE t; t.v = (RET_TYPE##_simd)(a.v != zero) BOP (RET_TYPE##_simd)(b.v != zero); return t; \
 } \
-ATTRIBUTES void operator*=(NEW_TYPE a, BASIC_TYPE b) { \
-    a.x *= b, a.y *= b, a.z *= b, a.w *= b; \
+ATTRIBUTES RET_TYPE operator OP(NEW_TYPE a, BASIC_TYPE b) { \
+    return a OP make_##NEW_TYPE(b); \
 } \
+ATTRIBUTES RET_TYPE operator OP(BASIC_TYPE a, NEW_TYPE b) { \
+    return make_##NEW_TYPE(a) OP b; \
+}
+
+
+// vector operators for all data types on SIMD vectors
+#define MAKE_SIMD_OPS_A(NEW_TYPE, BASIC_TYPE, RET_TYPE) \
  \
- /* binary operator: divide */ \
+ /* binary operators: add, subtract, multiply, divide */ \
  \
-ATTRIBUTES NEW_TYPE operator/(NEW_TYPE a, NEW_TYPE b) { \
-    return make_##NEW_TYPE(a.x / b.x, a.y / b.y, a.z / b.z, a.w / b.w); \
-} \
-ATTRIBUTES NEW_TYPE operator/(NEW_TYPE a, BASIC_TYPE b) { \
-    return make_##NEW_TYPE(a.x / b, a.y / b, a.z / b, a.w / b); \
-} \
-ATTRIBUTES NEW_TYPE operator/(BASIC_TYPE a, NEW_TYPE b) { \
-    return make_##NEW_TYPE(a / b.x, a / b.y, a / b.z, a / b.w); \
-} \
-ATTRIBUTES void operator/=(NEW_TYPE &a, NEW_TYPE b) { \
-    a.x /= b.x; a.y /= b.y; a.z /= b.z; a.w /= b.w; \
-} \
-ATTRIBUTES void operator/=(NEW_TYPE a, BASIC_TYPE b) { \
-    a.x /= b, a.y /= b, a.z /= b, a.w /= b; \
-} \
+MAKE_SIMD_BOP(NEW_TYPE, BASIC_TYPE, +) \
+MAKE_SIMD_BOP(NEW_TYPE, BASIC_TYPE, -) \
+MAKE_SIMD_BOP(NEW_TYPE, BASIC_TYPE, *) \
+MAKE_SIMD_BOP(NEW_TYPE, BASIC_TYPE, /) \
  \
- /* unary operator: plus */ \
+ /* unary operators: plus, minus */ \
  \
 ATTRIBUTES NEW_TYPE operator+(NEW_TYPE a) { \
-    return make_##NEW_TYPE(+a.x, +a.y, +a.z, +a.w); \
+    return a; \
 } \
- \
- /* unary operator: minus */ \
- \
 ATTRIBUTES NEW_TYPE operator-(NEW_TYPE a) { \
-    return make_##NEW_TYPE(-a.x, -a.y, -a.z, -a.w); \
-} \
- \
- /* relational operator: greater-than */ \
- \
-ATTRIBUTES RET_TYPE operator>(NEW_TYPE a, NEW_TYPE b) { \
-    return make_##RET_TYPE(a.x > b.x, a.y > b.y, a.z > b.z, a.w > b.w); \
-} \
-ATTRIBUTES RET_TYPE operator>(NEW_TYPE a, BASIC_TYPE b) { \
-    return make_##RET_TYPE(a.x > b, a.y > b, a.z > b, a.w > b); \
-} \
-ATTRIBUTES RET_TYPE operator>(BASIC_TYPE a, NEW_TYPE b) { \
-    return make_##RET_TYPE(a > b.x, a > b.y, a > b.z, a > b.w); \
-} \
- \
- /* relational operator: less-than */ \
- \
-ATTRIBUTES RET_TYPE operator<(NEW_TYPE a, NEW_TYPE b) { \
-    return make_##RET_TYPE(a.x < b.x, a.y < b.y, a.z < b.z, a.w < b.w); \
-} \
-ATTRIBUTES RET_TYPE operator<(NEW_TYPE a, BASIC_TYPE b) { \
-    return make_##RET_TYPE(a.x < b, a.y < b, a.z < b, a.w < b); \
-} \
-ATTRIBUTES RET_TYPE operator<(BASIC_TYPE a, NEW_TYPE b) { \
-    return make_##RET_TYPE(a < b.x, a < b.y, a < b.z, a < b.w); \
+    NEW_TYPE t; t.v = -a.v; return t; \
 } \
  \
- /* relational operator: greater-than or equal-to */ \
+ /* relational and equality operators */ \
  \
-ATTRIBUTES RET_TYPE operator>=(NEW_TYPE a, NEW_TYPE b) { \
-    return make_##RET_TYPE(a.x >= b.x, a.y >= b.y, a.z >= b.z, a.w >= b.w); \
-} \
-ATTRIBUTES RET_TYPE operator>=(NEW_TYPE a, BASIC_TYPE b) { \
-    return make_##RET_TYPE(a.x >= b, a.y >= b, a.z >= b, a.w >= b); \
-} \
-ATTRIBUTES RET_TYPE operator>=(BASIC_TYPE a, NEW_TYPE b) { \
-    return make_##RET_TYPE(a >= b.x, a >= b.y, a >= b.z, a >= b.w); \
-} \
- \
- /* relational operator: less-than or equal-to */ \
- \
-ATTRIBUTES RET_TYPE operator<=(NEW_TYPE a, NEW_TYPE b) { \
-    return make_##RET_TYPE(a.x <= b.x, a.y <= b.y, a.z <= b.z, a.w <= b.w); \
-} \
-ATTRIBUTES RET_TYPE operator<=(NEW_TYPE a, BASIC_TYPE b) { \
-    return make_##RET_TYPE(a.x <= b, a.y <= b, a.z <= b, a.w <= b); \
-} \
-ATTRIBUTES RET_TYPE operator<=(BASIC_TYPE a, NEW_TYPE b) { \
-    return make_##RET_TYPE(a <= b.x, a <= b.y, a <= b.z, a <= b.w); \
-} \
- \
- /* equality operator: equal */ \
- \
-ATTRIBUTES RET_TYPE operator==(NEW_TYPE a, NEW_TYPE b) { \
-    return make_##RET_TYPE(a.x == b.x, a.y == b.y, a.z == b.z, a.w == b.w); \
-} \
-ATTRIBUTES RET_TYPE operator==(NEW_TYPE a, BASIC_TYPE b) { \
-    return make_##RET_TYPE(a.x == b, a.y == b, a.z == b, a.w == b); \
-} \
-ATTRIBUTES RET_TYPE operator==(BASIC_TYPE a, NEW_TYPE b) { \
-    return make_##RET_TYPE(a == b.x, a == b.y, a == b.z, a == b.w); \
-} \
- \
- /* equality operator: not equal */ \
- \
-ATTRIBUTES RET_TYPE operator!=(NEW_TYPE a, NEW_TYPE b) { \
-    return make_##RET_TYPE(a.x != b.x, a.y != b.y, a.z != b.z, a.w != b.w); \
-} \
-ATTRIBUTES RET_TYPE operator!=(NEW_TYPE a, BASIC_TYPE b) { \
-    return make_##RET_TYPE(a.x != b, a.y != b, a.z != b, a.w != b); \
-} \
-ATTRIBUTES RET_TYPE operator!=(BASIC_TYPE a, NEW_TYPE b) { \
-    return make_##RET_TYPE(a != b.x, a != b.y, a != b.z, a != b.w); \
-} \
+MAKE_SIMD_ROP(NEW_TYPE, BASIC_TYPE, RET_TYPE, >) \
+MAKE_SIMD_ROP(NEW_TYPE, BASIC_TYPE, RET_TYPE, <) \
+MAKE_SIMD_ROP(NEW_TYPE, BASIC_TYPE, RET_TYPE, >=) \
+MAKE_SIMD_ROP(NEW_TYPE, BASIC_TYPE, RET_TYPE, <=) \
+MAKE_SIMD_ROP(NEW_TYPE, BASIC_TYPE, RET_TYPE, ==) \
+MAKE_SIMD_ROP(NEW_TYPE, BASIC_TYPE, RET_TYPE, !=) \
  \
- /* logical operator: and */ \
- \
-ATTRIBUTES RET_TYPE operator&&(NEW_TYPE a, NEW_TYPE b) { \
-    return make_##RET_TYPE(a.x && b.x, a.y && b.y, a.z && b.z, a.w && b.w); \
-} \
-ATTRIBUTES RET_TYPE operator&&(NEW_TYPE a, BASIC_TYPE b) { \
-    return make_##RET_TYPE(a.x && b, a.y && b, a.z && b, a.w && b); \
-} \
-ATTRIBUTES RET_TYPE operator&&(BASIC_TYPE a, NEW_TYPE b) { \
-    return make_##RET_TYPE(a && b.x, a && b.y, a && b.z, a && b.w); \
-} \
- \
- /* logical operator: or */ \
- \
-ATTRIBUTES RET_TYPE operator||(NEW_TYPE a, NEW_TYPE b) { \
-    return make_##RET_TYPE(a.x || b.x, a.y || b.y, a.z || b.z, a.w || b.w); \
-} \
-ATTRIBUTES RET_TYPE operator||(NEW_TYPE a, BASIC_TYPE b) { \
-    return make_##RET_TYPE(a.x || b, a.y || b, a.z || b, a.w || b); \
-} \
-ATTRIBUTES RET_TYPE operator||(BASIC_TYPE a, NEW_TYPE b) { \
-    return make_##RET_TYPE(a || b.x, a || b.y, a || b.z, a || b.w); \
-} \
- \
- /* logical unary operator: not */ \
+ /* logical operators: and, or, not */ \
  \
+MAKE_SIMD_LOP(NEW_TYPE, BASIC_TYPE, RET_TYPE, &&, &) \
+MAKE_SIMD_LOP(NEW_TYPE, BASIC_TYPE, RET_TYPE, ||, |) \
 ATTRIBUTES RET_TYPE operator!(NEW_TYPE a) { \
-    return make_##RET_TYPE(!a.x, !a.y, !a.z, !a.w); \
+    RET_TYPE t; t.v = (RET_TYPE##_simd)(a.v == make_##NEW_TYPE(0).v); return t; \
 } \
  \
  /* operator: comma */ \
@@ -303,141 +206,54 @@ ATTRIBUTES NEW_TYPE operator,(BASIC_TYPE a, NEW_TYPE b) { \
 }
 
 
-// vector operators for integer data types only
-#define MAKE_VOPS_I(NEW_TYPE, BASIC_TYPE, RET_TYPE) \
+// vector operators for integer data types only on SIMD vectors
+#define MAKE_SIMD_OPS_I(NEW_TYPE, BASIC_TYPE, RET_TYPE) \
  \
- /* binary operator: remainder */ \
+ /* binary operators: remainder, bitwise and, or, exclusive or, shifts */ \
  \
-ATTRIBUTES NEW_TYPE operator%(NEW_TYPE a, NEW_TYPE b) { \
-    return make_##NEW_TYPE(a.x % b.x, a.y % b.y, a.z % b.z, a.w % b.w); \
-} \
-ATTRIBUTES NEW_TYPE operator%(NEW_TYPE a, BASIC_TYPE b) { \
-    return make_##NEW_TYPE(a.x % b, a.y % b, a.z % b, a.w % b); \
-} \
-ATTRIBUTES NEW_TYPE operator%(BASIC_TYPE a, NEW_TYPE b) { \
-    return make_##NEW_TYPE(a % b.x, a % b.y, a % b.z, a % b.w); \
-} \
-ATTRIBUTES void operator%=(NEW_TYPE &a, NEW_TYPE b) { \
-    a.x %= b.x; a.y %= b.y; a.z %= b.z; a.w %= b.w; \
-} \
-ATTRIBUTES void operator%=(NEW_TYPE a, BASIC_TYPE b) { \
-    a.x %= b, a.y %= b, a.z %= b, a.w %= b; \
-} \
+MAKE_SIMD_BOP(NEW_TYPE, BASIC_TYPE, %) \
+MAKE_SIMD_BOP(NEW_TYPE, BASIC_TYPE, &) \
+MAKE_SIMD_BOP(NEW_TYPE, BASIC_TYPE, |) \
+MAKE_SIMD_BOP(NEW_TYPE, BASIC_TYPE, ^) \
+MAKE_SIMD_BOP(NEW_TYPE, BASIC_TYPE, >>) \
+MAKE_SIMD_BOP(NEW_TYPE, BASIC_TYPE, <<) \
  \
  /* unary operator: post- and pre-increment */ \
  \
 ATTRIBUTES NEW_TYPE operator++(NEW_TYPE a) { \
-    return make_##NEW_TYPE(++a.x, ++a.y, ++a.z, ++a.w); \
+    return a + make_##NEW_TYPE(1); \
 } \
 ATTRIBUTES NEW_TYPE operator++(NEW_TYPE a, int) { \
-    return make_##NEW_TYPE(a.x++, a.y++, a.z++, a.w++); \
+    return a; \
 } \
  \
  /* unary operator: post- and pre-decrement */ \
  \
 ATTRIBUTES NEW_TYPE operator--(NEW_TYPE a) { \
-    return make_##NEW_TYPE(--a.x, --a.y, --a.z, --a.w); \
+    return a - make_##NEW_TYPE(1); \
 } \
 ATTRIBUTES NEW_TYPE operator--(NEW_TYPE a, int) { \
-    return make_##NEW_TYPE(a.x--, a.y--, a.z--, a.w--); \
-} \
- \
- /* bitwise operator: and */ \
- \
-ATTRIBUTES NEW_TYPE operator&(NEW_TYPE a, NEW_TYPE b) { \
-    return make_##NEW_TYPE(a.x & b.x, a.y & b.y, a.z & b.z, a.w & b.w); \
-} \
-ATTRIBUTES NEW_TYPE operator&(NEW_TYPE a, BASIC_TYPE b) { \
-    return make_##NEW_TYPE(a.x & b, a.y & b, a.z & b, a.w & b); \
-} \
-ATTRIBUTES NEW_TYPE operator&(BASIC_TYPE a, NEW_TYPE b) { \
-    return make_##NEW_TYPE(a & b.x, a & b.y, a & b.z, a & b.w); \
-} \
-ATTRIBUTES void operator&=(NEW_TYPE &a, NEW_TYPE b) { \
-    a.x &= b.x; a.y &= b.y; a.z &= b.z; a.w &= b.w; \
-} \
-ATTRIBUTES void operator&=(NEW_TYPE a, BASIC_TYPE b) { \
-    a.x &= b, a.y &= b, a.z &= b, a.w &= b; \
-} \
- \
- /* bitwise operator: or */ \
- \
-ATTRIBUTES NEW_TYPE operator|(NEW_TYPE a, NEW_TYPE b) { \
-    return make_##NEW_TYPE(a.x | b.x, a.y | b.y, a.z | b.z, a.w | b.w); \
-} \
-ATTRIBUTES NEW_TYPE operator|(NEW_TYPE a, BASIC_TYPE b) { \
-    return make_##NEW_TYPE(a.x | b, a.y | b, a.z | b, a.w | b); \
-} \
-ATTRIBUTES NEW_TYPE operator|(BASIC_TYPE a, NEW_TYPE b) { \
-    return make_##NEW_TYPE(a | b.x, a | b.y, a | b.z, a | b.w); \
-} \
-ATTRIBUTES void operator|=(NEW_TYPE &a, NEW_TYPE b) { \
-    a.x |= b.x; a.y |= b.y; a.z |= b.z; a.w |= b.w; \
-} \
-ATTRIBUTES void operator|=(NEW_TYPE a, BASIC_TYPE b) { \
-    a.x |= b, a.y |= b, a.z |= b, a.w |= b; \
-} \
- \
- /* bitwise operator: exclusive or */ \
- \
-ATTRIBUTES NEW_TYPE operator^(NEW_TYPE a, NEW_TYPE b) { \
-    return make_##NEW_TYPE(a.x ^ b.x, a.y ^ b.y, a.z ^ b.z, a.w ^ b.w); \
-} \
-ATTRIBUTES NEW_TYPE operator^(NEW_TYPE a, BASIC_TYPE b) { \
-    return make_##NEW_TYPE(a.x ^ b, a.y ^ b, a.z ^ b, a.w ^ b); \
-} \
-ATTRIBUTES NEW_TYPE operator^(BASIC_TYPE a, NEW_TYPE b) { \
-    return make_##NEW_TYPE(a ^ b.x, a ^ b.y, a ^ b.z, a ^ b.w); \
-} \
-ATTRIBUTES void operator^=(NEW_TYPE &a, NEW_TYPE b) { \
-    a.x ^= b.x; a.y ^= b.y; a.z ^= b.z; a.w ^= b.w; \
-} \
-ATTRIBUTES void operator^=(NEW_TYPE a, BASIC_TYPE b) { \
-    a.x ^= b, a.y ^= b, a.z ^= b, a.w ^= b; \
+    return a; \
 } \
  \
  /* bitwise operator: not */ \
  \
 ATTRIBUTES NEW_TYPE operator~(NEW_TYPE a) { \
-    return make_##NEW_TYPE(~a.x, ~a.y, ~a.z, ~a.w); \
-} \
- \
- /* operator: right-shift */ \
- \
-ATTRIBUTES NEW_TYPE operator>>(NEW_TYPE a, NEW_TYPE b) { \
-    return make_##NEW_TYPE(a.x >> b.x, a.y >> b.y, a.z >> b.z, a.w >> b.w); \
-} \
-ATTRIBUTES NEW_TYPE operator>>(NEW_TYPE a, BASIC_TYPE b) { \
-    return make_##NEW_TYPE(a.x >> b, a.y >> b, a.z >> b, a.w >> b); \
-} \
-ATTRIBUTES NEW_TYPE operator>>(BASIC_TYPE a, NEW_TYPE b) { \
-    return make_##NEW_TYPE(a >> b.x, a >> b.y, a >> b.z, a >> b.w); \
-} \
-ATTRIBUTES void operator>>=(NEW_TYPE &a, NEW_TYPE b) { \
-    a.x >>= b.x; a.y >>= b.y; a.z >>= b.z; a.w >>= b.w; \
-} \
-ATTRIBUTES void operator>>=(NEW_TYPE a, BASIC_TYPE b) { \
-    a.x >>= b, a.y >>= b, a.z >>= b, a.w >>= b; \
-} \
- \
- /* operator: left-shift */ \
- \
-ATTRIBUTES NEW_TYPE operator<<(NEW_TYPE a, NEW_TYPE b) { \
-    return make_##NEW_TYPE(a.x << b.x, a.y << b.y, a.z << b.z, a.w << b.w); \
-} \
-ATTRIBUTES NEW_TYPE operator<<(NEW_TYPE a, BASIC_TYPE b) { \
-    return make_##NEW_TYPE(a.x << b, a.y << b, a.z << b, a.w << b); \
-} \
-ATTRIBUTES NEW_TYPE operator<<(BASIC_TYPE a, NEW_TYPE b) { \
-    return make_##NEW_TYPE(a << b.x, a << b.y, a << b.z, a << b.w); \
-} \
-ATTRIBUTES void operator<<=(NEW_TYPE &a, NEW_TYPE b) { \
-    a.x <<= b.x; a.y <<= b.y; a.z <<= b.z; a.w <<= b.w; \
-} \
-ATTRIBUTES void operator<<=(NEW_TYPE a, BASIC_TYPE b) { \
-    a.x <<= b, a.y <<= b, a.z <<= b, a.w <<= b; \
+    NEW_TYPE t; t.v = ~a.v; return t; \
+}
+
+
+// make function
+#define MAKE_VMOP(NEW_TYPE, BASIC_TYPE) \
+static ATTRIBUTES NEW_TYPE make_##NEW_TYPE(BASIC_TYPE x, BASIC_TYPE y, BASIC_TYPE z, BASIC_TYPE w) { \
+    NEW_TYPE t; t.x = x; t.y = y; t.z = z; t.w = w; return t; \
 }
 
+#define MAKE_MOP(NEW_TYPE, BASIC_TYPE) \
+static ATTRIBUTES NEW_TYPE make_##NEW_TYPE(BASIC_TYPE s) \
+{ \
+    return make_##NEW_TYPE(s, s, s, s); \
+}
 
 MAKE_VEC_I(char4,     char,     char4)
 MAKE_VEC_I(uchar4,    uchar,    char4)
@@ -453,11 +269,69 @@ MAKE_VEC_F(double4,   double,   long4)
 
 
 // conversion function
-#define MAKE_CONV_FUNC(BASIC_TYPE, RET_TYPE, VEC_TYPE) \
+#define MAKE_CONV_CMP(BASIC_TYPE, RET_TYPE, VEC_TYPE) \
 ATTRIBUTES RET_TYPE convert_##RET_TYPE(VEC_TYPE vec) { \
     return make_##RET_TYPE(vec.x, vec.y, vec.z, vec.w); \
 }
 
+// conversion function on SIMD vectors
+#define MAKE_CONV_SIMD(BASIC_TYPE, RET_TYPE, VEC_TYPE) \
+ATTRIBUTES RET_TYPE convert_##RET_TYPE(VEC_TYPE vec) { \
+    RET_TYPE t; t.v = __builtin_convertvector(vec.v, RET_TYPE##_simd); return t; \
+}
+
+// saturating conversion function: components are clamped to [MIN, MAX] of the
+// integer type, NaN is converted to 0
+#define HIPACC_SAT(BASIC_TYPE, V, MIN, MAX) \
+    ((V) != (V) ? (BASIC_TYPE)0 : \
+     (double)(V) < (double)(MIN) ? (BASIC_TYPE)(MIN) : \
+     (double)(V) > (double)(MAX) ? (BASIC_TYPE)(MAX) : (BASIC_TYPE)(V))
+#define MAKE_CONV_SAT_CMP(BASIC_TYPE, RET_TYPE, VEC_TYPE, MIN, MAX) \
+ATTRIBUTES RET_TYPE convert_##RET_TYPE##_sat(VEC_TYPE vec) { \
+    return make_##RET_TYPE(HIPACC_SAT(BASIC_TYPE, vec.x, MIN, MAX), \
+                           HIPACC_SAT(BASIC_TYPE, vec.y, MIN, MAX), \
+                           HIPACC_SAT(BASIC_TYPE, vec.z, MIN, MAX), \
+                           HIPACC_SAT(BASIC_TYPE, vec.w, MIN, MAX)); \
+}
+
+// saturating conversion function on SIMD vectors: components are clamped in
+// the source type to the values converting to [MIN, MAX] of the integer type;
+// MAX itself might not be representable in a floating-point source type
+#define MAKE_CONV_SAT_SIMD(BASIC_TYPE, RET_TYPE, VEC_TYPE, MIN, MAX) \
+ATTRIBUTES RET_TYPE convert_##RET_TYPE##_sat(VEC_TYPE vec) { \
+    typedef __typeof__(vec.x) src_type; \
+    VEC_TYPE lo = make_##VEC_TYPE(hipacc_sat_min<src_type, BASIC_TYPE>()); \
+    VEC_TYPE hi = make_##VEC_TYPE(hipacc_sat_max<src_type, BASIC_TYPE>()); \
+    __typeof__(vec.v > hi.v) above = vec.v > hi.v; \
+    vec.v = vec.v == vec.v ? vec.v : lo.v - lo.v; \
+    vec.v = vec.v < lo.v ? lo.v : vec.v; \
+    vec.v = above ? hi.v : vec.v; \
+    RET_TYPE t = convert_##RET_TYPE(vec); \
+    t.v = __builtin_convertvector(above, RET_TYPE##_simd) ? \
+          make_##RET_TYPE(MAX).v : t.v; \
+    return t; \
+}
+
+// smallest and largest value of type S within the range of the integer type D
+template<typename S, typename D>
+inline S hipacc_sat_min() {
+    long double l = (long double)std::numeric_limits<D>::min();
+    long double s = std::numeric_limits<S>::is_integer ?
+        (long double)std::numeric_limits<S>::min() :
+        -(long double)std::numeric_limits<S>::max();
+    return (S)(l > s ? l : s);
+}
+template<typename S, typename D>
+inline S hipacc_sat_max() {
+    long double h = (long double)std::numeric_limits<D>::max();
+    if (h > (long double)std::numeric_limits<S>::max())
+        h = (long double)std::numeric_limits<S>::max();
+    S t = (S)h;
+    // the next smaller value, if the maximum rounds up in a floating-point type
+    if ((long double)t > h) t = t * (1 - std::numeric_limits<S>::epsilon()/2);
+    return t;
+}
+
 // generate conversion functions for types
 #define MAKE_CONV(VEC_TYPE) \
     MAKE_CONV_FUNC(char,   char4,   VEC_TYPE) \
@@ -469,7 +343,13 @@ ATTRIBUTES RET_TYPE convert_##RET_TYPE(VEC_TYPE vec) { \
     MAKE_CONV_FUNC(long,   long4,   VEC_TYPE) \
     MAKE_CONV_FUNC(ulong,  ulong4,  VEC_TYPE) \
     MAKE_CONV_FUNC(float,  float4,  VEC_TYPE) \
-    MAKE_CONV_FUNC(double, double4, VEC_TYPE)
+    MAKE_CONV_FUNC(double, double4, VEC_TYPE) \
+    MAKE_CONV_SAT_FUNC(char,   char4,   VEC_TYPE, -128, 127) \
+    MAKE_CONV_SAT_FUNC(uchar,  uchar4,  VEC_TYPE, 0, 255) \
+    MAKE_CONV_SAT_FUNC(short,  short4,  VEC_TYPE, -32768, 32767) \
+    MAKE_CONV_SAT_FUNC(ushort, ushort4, VEC_TYPE, 0, 65535) \
+    MAKE_CONV_SAT_FUNC(int,    int4,    VEC_TYPE, -2147483647-1, 2147483647) \
+    MAKE_CONV_SAT_FUNC(uint,   uint4,   VEC_TYPE, 0, 4294967295u)
 
 
 MAKE_CONV(char4)
@@ -94,6 +94,16 @@ class ASTTranslate : public StmtVisitor<ASTTranslate, Stmt *> {
     DeclRefExpr *convTmp;
     ConvolutionMode convMode;
     int convIdxX, convIdxY;
+    // loop body allowing sliding windows for separable convolutions and
+    // statements initializing the windows before the loop
+    Stmt *sepLoopBody;
+    SmallVector<Stmt *, 16> sepInitStmts;
+    // statements declaring running sums of box filters at kernel entry
+    SmallVector<Stmt *, 16> kernelInitStmts;
+    // median: tap variable for sorting networks, histograms (fine and coarse)
+    // and operation (++/--) for histogram updates
+    DeclRefExpr *medianTap, *medianHist, *medianCoarse;
+    UnaryOperatorKind medianHistOp;
     enum ConvolveMethod {
       Convolve,
       Reduce,
@@ -107,6 +117,7 @@ class ASTTranslate : public StmtVisitor<ASTTranslate, Stmt *> {
 
     DeclRefExpr *bh_start_left, *bh_start_right, *bh_start_top,
                 *bh_start_bottom, *bh_fall_back;
+    DeclRefExpr *band_start_y, *band_end_y, *band_start_x, *band_end_x;
     DeclRefExpr *outputImage;
     DeclRefExpr *retValRef;
     Expr *writeImageRHS;
@@ -161,6 +172,8 @@ class ASTTranslate : public StmtVisitor<ASTTranslate, Stmt *> {
     void setExprProps(Expr *orig, Expr *clone);
     void setExprPropsClone(Expr *orig, Expr *clone);
     void setCastPath(CastExpr *orig, CXXCastPath &castPath);
+    void specializeSizes(HipaccAccessor *Acc, bool crop, SmallVector<Stmt *,
+        16> &kernelBody);
     void initCPU(SmallVector<Stmt *, 16> &kernelBody, Stmt *S);
     void initCUDA(SmallVector<Stmt *, 16> &kernelBody);
     void initOpenCL(SmallVector<Stmt *, 16> &kernelBody);
@@ -211,6 +224,22 @@ class ASTTranslate : public StmtVisitor<ASTTranslate, Stmt *> {
       Kernel->setUsed(bh_fall_back->getNameInfo().getAsString());
       return bh_fall_back;
     }
+    DeclRefExpr *getBandStartY() {
+      Kernel->setUsed(band_start_y->getNameInfo().getAsString());
+      return band_start_y;
+    }
+    DeclRefExpr *getBandEndY() {
+      Kernel->setUsed(band_end_y->getNameInfo().getAsString());
+      return band_end_y;
+    }
+    DeclRefExpr *getBandStartX() {
+      Kernel->setUsed(band_start_x->getNameInfo().getAsString());
+      return band_start_x;
+    }
+    DeclRefExpr *getBandEndX() {
+      Kernel->setUsed(band_end_x->getNameInfo().getAsString());
+      return band_end_x;
+    }
 
     // KernelDeclMap - this keeps track of the cloned Decls which are used in
     // expressions, e.g. DeclRefExpr
@@ -250,10 +279,33 @@ class ASTTranslate : public StmtVisitor<ASTTranslate, Stmt *> {
     Stmt *addDomainCheck(HipaccMask *Domain, DeclRefExpr *domain_var, Stmt
         *stmt);
     Expr *convertConvolution(CXXMemberCallExpr *E);
+    bool isHoistableValue(Stmt *S);
+    bool getSeparableMask(HipaccMask *Mask, SmallVector<double, 16> &col,
+        SmallVector<double, 16> &row);
+    Expr *createMaskCoefficient(double val, QualType QT);
+    Expr *getSeparableColumn(Expr *val, int idx_x, SmallVector<double, 16>
+        &col, QualType QT, QualType MQT);
+    bool convertSeparableConvolution(HipaccMask *Mask, FieldDecl *FD,
+        LambdaExpr *LE, DeclRefExpr *tmp_var, CompoundStmt *CStmt);
+    Expr *cloneBoxTap(ConvolveMethod method, Expr *val, int x, int y);
+    bool convertBoxFilter(ConvolveMethod method, HipaccMask *Mask, FieldDecl
+        *FD, LambdaExpr *LE, DeclRefExpr *tmp_var, CompoundStmt *CStmt);
+    Stmt *getMedianStmt(Expr *ret_val);
+    Stmt *cloneMedianTap(ConvolveMethod method, LambdaExpr *LE, int x, int y);
+    void convertMedianSortingNetwork(ConvolveMethod method, LambdaExpr *LE,
+        SmallVector<std::pair<int, int>, 64> &taps, DeclRefExpr *tmp_var,
+        CompoundStmt *CStmt);
+    void convertMedianHistogram(ConvolveMethod method, HipaccMask *Mask,
+        LambdaExpr *LE, SmallVector<std::pair<int, int>, 64> &taps,
+        DeclRefExpr *tmp_var, CompoundStmt *CStmt);
+    void convertMedian(ConvolveMethod method, HipaccMask *Mask, LambdaExpr
+        *LE, DeclRefExpr *tmp_var, CompoundStmt *CStmt);
 
     // Interpolation.cpp
     Expr *addNNInterpolationX(HipaccAccessor *Acc, Expr *idx_x);
     Expr *addNNInterpolationY(HipaccAccessor *Acc, Expr *idx_y);
+    Expr *addDecimationX(HipaccAccessor *Acc, Expr *idx_x);
+    Expr *addDecimationY(HipaccAccessor *Acc, Expr *idx_y);
     FunctionDecl *getInterpolationFunction(HipaccAccessor *Acc);
     FunctionDecl *getTextureFunction(HipaccAccessor *Acc, MemoryAccess memAcc);
     FunctionDecl *getImageFunction(HipaccAccessor *Acc, MemoryAccess memAcc);
@@ -319,11 +371,20 @@ class ASTTranslate : public StmtVisitor<ASTTranslate, Stmt *> {
       convTmp(nullptr),
       convIdxX(0),
       convIdxY(0),
+      sepLoopBody(nullptr),
+      medianTap(nullptr),
+      medianHist(nullptr),
+      medianCoarse(nullptr),
+      medianHistOp(UO_PostInc),
       bh_start_left(nullptr),
       bh_start_right(nullptr),
       bh_start_top(nullptr),
       bh_start_bottom(nullptr),
       bh_fall_back(nullptr),
+      band_start_y(nullptr),
+      band_end_y(nullptr),
+      band_start_x(nullptr),
+      band_end_x(nullptr),
       outputImage(nullptr),
       retValRef(nullptr),
       writeImageRHS(nullptr),
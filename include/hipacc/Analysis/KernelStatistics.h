@@ -29,8 +29,9 @@
 //
 // This file implements various statistics and analysis for source-level CFGs of
 // kernel functions.
-// Statistics include number of instructions (ALU/SPU) and memory operations
-// (global memory, constant memory).
+// Statistics include number of instructions (ALU/SFU) and memory operations
+// (global memory, constant memory) per output pixel and per iteration of
+// lambda functions passed to convolve(), reduce(), and iterate().
 // Analysis include use-def analysis for vectorization.
 //
 //===----------------------------------------------------------------------===//
@@ -44,6 +45,8 @@
 #include <clang/Analysis/Analyses/PostOrderCFGView.h>
 #include <clang/Basic/Diagnostic.h>
 
+#include <map>
+
 #include "hipacc/Device/TargetDescription.h"
 #include "hipacc/DSL/CompilerKnownClasses.h"
 
@@ -73,6 +76,24 @@ enum VectorInfo {
   PROPAGATE   = 0x2
 };
 
+// static operation counts of the kernel body or of a lambda function
+class OperationCounts {
+  public:
+    // arithmetic/logic operations and transcendental function calls
+    unsigned int ops, sfu_ops;
+    unsigned int img_loads, img_stores;
+    unsigned int mask_loads, mask_stores;
+    // loads per Accessor
+    std::map<const FieldDecl *, unsigned int> acc_loads;
+
+    OperationCounts() :
+      ops(0), sfu_ops(0),
+      img_loads(0), img_stores(0),
+      mask_loads(0), mask_stores(0),
+      acc_loads()
+    {}
+};
+
 class KernelStatistics : public ManagedAnalysis {
   private:
     KernelStatistics(void *impl);
@@ -84,6 +105,11 @@ class KernelStatistics : public ManagedAnalysis {
     MemoryAccessDetail getOutAccessDetail();
     VectorInfo getVectorizeInfo(const VarDecl *VD);
     KernelType getKernelType();
+    // operation counts per output pixel, excluding lambda functions
+    OperationCounts &getOperationCounts();
+    // operation counts per iteration of lambda functions by the Mask or Domain
+    // they iterate over; nullptr if unknown
+    std::map<const FieldDecl *, OperationCounts> &getLambdaOperationCounts();
 
     virtual ~KernelStatistics();
 
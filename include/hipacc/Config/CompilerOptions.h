@@ -78,12 +78,22 @@ class CompilerOptions {
     CompilerOption local_memory;
     CompilerOption multiple_pixels;
     CompilerOption vectorize_kernels;
+    CompilerOption multi_threading;
+    CompilerOption fuse_kernels;
+    CompilerOption stream_lines;
+    CompilerOption fuse_sampling;
+    CompilerOption concurrent_kernels;
+    CompilerOption async_transfers;
+    CompilerOption specialize_sizes;
     // user defined values for target code features
     int kernel_config_x, kernel_config_y;
     int align_bytes;
     int pixels_per_thread;
+    int num_threads;
     TextureType texture_memory_type;
+    VectorISA vector_isa;
     std::string rs_package_name;
+    std::string tuning_db;
 
     void getOptionAsString(CompilerOption option, int val=-1) {
       switch (option) {
@@ -118,12 +128,22 @@ class CompilerOptions {
       local_memory(AUTO),
       multiple_pixels(AUTO),
       vectorize_kernels(OFF),
+      multi_threading(OFF),
+      fuse_kernels(OFF),
+      stream_lines(OFF),
+      fuse_sampling(OFF),
+      concurrent_kernels(OFF),
+      async_transfers(OFF),
+      specialize_sizes(OFF),
       kernel_config_x(128),
       kernel_config_y(1),
       align_bytes(0),
       pixels_per_thread(1),
+      num_threads(1),
       texture_memory_type(NoTexture),
-      rs_package_name("org.hipacc.rs")
+      vector_isa(ISA_Native),
+      rs_package_name("org.hipacc.rs"),
+      tuning_db()
     {}
 
     bool emitCUDA() {
@@ -201,13 +221,56 @@ class CompilerOptions {
       if (vectorize_kernels & option) return true;
       return false;
     }
+    VectorISA getVectorISA() { return vector_isa; }
     bool multiplePixelsPerThread(CompilerOption
         option=(CompilerOption)(ON|USER_ON)) {
       if (multiple_pixels & option) return true;
       return false;
     }
     int getPixelsPerThread() { return pixels_per_thread; }
+    bool useThreads(CompilerOption option=(CompilerOption)(AUTO|ON|USER_ON)) {
+      if (multi_threading & option) return true;
+      return false;
+    }
+    // 0 means the number of threads is determined by the runtime
+    int getNumThreads() { return num_threads; }
+    bool fuseKernels(CompilerOption option=(CompilerOption)(ON|USER_ON)) {
+      if (fuse_kernels & option) return true;
+      return false;
+    }
+    bool streamLines(CompilerOption option=(CompilerOption)(ON|USER_ON)) {
+      if (stream_lines & option) return true;
+      return false;
+    }
+    bool fuseSampling(CompilerOption option=(CompilerOption)(ON|USER_ON)) {
+      if (fuse_sampling & option) return true;
+      return false;
+    }
+    bool concurrentKernels(CompilerOption
+        option=(CompilerOption)(ON|USER_ON)) {
+      if (concurrent_kernels & option) return true;
+      return false;
+    }
+    bool asyncTransfers(CompilerOption option=(CompilerOption)(ON|USER_ON)) {
+      if (async_transfers & option) return true;
+      return false;
+    }
+    bool specializeSizes(CompilerOption option=(CompilerOption)(ON|USER_ON)) {
+      if (specialize_sizes & option) return true;
+      return false;
+    }
+    // C/C++ kernels process a band of rows passed by the runtime
+    bool emitRowBands() {
+      return emitC() && (useThreads() || fuseKernels() || exploreConfig());
+    }
+    // C/C++ kernels additionally process a tile of columns during exploration
+    bool emitColumnTiles() {
+      return emitC() && exploreConfig();
+    }
     std::string getRSPackageName() { return rs_package_name; }
+    // file storing the best configurations found by exploration
+    bool useTuningDB() { return !tuning_db.empty(); }
+    std::string getTuningDB() { return tuning_db; }
 
     void setTargetCode(TargetCode tc) { target_code = tc; }
     void setTargetDevice(TargetDevice td) { target_device = td; }
@@ -215,6 +278,16 @@ class CompilerOptions {
     void setTimeKernels(CompilerOption o) { time_kernels = o; }
     void setLocalMemory(CompilerOption o) { local_memory = o; }
     void setVectorizeKernels(CompilerOption o) { vectorize_kernels = o; }
+    void setFuseKernels(CompilerOption o) { fuse_kernels = o; }
+    void setStreamLines(CompilerOption o) { stream_lines = o; }
+    void setFuseSampling(CompilerOption o) { fuse_sampling = o; }
+    void setConcurrentKernels(CompilerOption o) { concurrent_kernels = o; }
+    void setAsyncTransfers(CompilerOption o) { async_transfers = o; }
+    void setSpecializeSizes(CompilerOption o) { specialize_sizes = o; }
+    void setVectorISA(VectorISA isa) {
+      vector_isa = isa;
+      vectorize_kernels = USER_ON;
+    }
 
     void setTextureMemory(TextureType type) {
       texture_memory_type = type;
@@ -240,6 +313,14 @@ class CompilerOptions {
       else multiple_pixels = USER_OFF;
     }
 
+    void setNumThreads(int threads) {
+      num_threads = threads;
+      if (threads == 0) multi_threading = AUTO;
+      else if (threads > 1) multi_threading = USER_ON;
+      else multi_threading = USER_OFF;
+    }
+
+    void setTuningDB(std::string file) { tuning_db = file; }
     void setRSPackageName(std::string name) {
       rs_package_name = name;
     }
@@ -300,6 +381,9 @@ class CompilerOptions {
       if (useKernelConfig()) {
         llvm::errs() << ": " << kernel_config_x << "x" << kernel_config_y;
       }
+      llvm::errs() << "\n  Tuning database for kernel configurations: ";
+      if (useTuningDB()) llvm::errs() << "'" << tuning_db << "'";
+      else getOptionAsString(OFF);
       llvm::errs() << "\n  Alignment of image memory: ";
       getOptionAsString(align_memory, align_bytes);
       llvm::errs() << "\n  Usage of texture memory for images: ";
@@ -315,8 +399,31 @@ class CompilerOptions {
       getOptionAsString(local_memory);
       llvm::errs() << "\n  Mapping multiple pixels to one thread: ";
       getOptionAsString(multiple_pixels, pixels_per_thread);
+      llvm::errs() << "\n  Fusion of kernels with subsampling consumers: ";
+      getOptionAsString(fuse_sampling);
+      llvm::errs() << "\n  Concurrent kernel launches: ";
+      getOptionAsString(concurrent_kernels);
+      llvm::errs() << "\n  Asynchronous memory transfers: ";
+      getOptionAsString(async_transfers);
+      llvm::errs() << "\n  Specialization of kernels for constant image sizes: ";
+      getOptionAsString(specialize_sizes);
       llvm::errs() << "\n  Vectorization of kernels: ";
       getOptionAsString(vectorize_kernels);
+      switch (vector_isa) {
+        case ISA_Native: break;
+        case ISA_SSE42: llvm::errs() << ": hints for SSE4.2"; break;
+        case ISA_AVX: llvm::errs() << ": hints for AVX"; break;
+        case ISA_AVX2: llvm::errs() << ": hints for AVX2"; break;
+        case ISA_AVX512: llvm::errs() << ": hints for AVX-512"; break;
+      }
+      if (emitC()) {
+        llvm::errs() << "\n  Multi-threading of kernels: ";
+        getOptionAsString(multi_threading, num_threads);
+        llvm::errs() << "\n  Band interleaving of producer/consumer kernels: ";
+        getOptionAsString(fuse_kernels);
+        llvm::errs() << "\n  Line buffers for images between fused kernels: ";
+        getOptionAsString(stream_lines);
+      }
       llvm::errs() << "\n\n";
     }
 };
@@ -150,14 +150,19 @@ class HipaccMemory : public HipaccSize {
 class HipaccImage : public HipaccMemory {
   private:
     ASTContext &Ctx;
+    // stride of the allocated image, 0 if not known at compile time
+    unsigned int stride;
 
   public:
     HipaccImage(ASTContext &Ctx, VarDecl *VD, QualType QT) :
       HipaccMemory(VD, VD->getNameAsString(), QT),
-      Ctx(Ctx)
+      Ctx(Ctx),
+      stride(0)
     {}
 
     unsigned int getPixelSize() { return Ctx.getTypeSize(type)/8; }
+    void setStride(unsigned int s) { stride = s; }
+    unsigned int getStride() { return stride; }
     std::string getTextureType();
     std::string getImageReadFunction();
 };
@@ -213,9 +218,15 @@ class HipaccAccessor {
     VarDecl *VD;
     std::string name;
     bool crop;
+    // read only at the pixels retained by a subsampling consumer:
+    // (int)(acc_scale * gid) + offset
+    bool decimated;
     // kernel parameter name for width, height, and stride
     DeclRefExpr *widthDecl, *heightDecl, *strideDecl, *scaleXDecl, *scaleYDecl;
     DeclRefExpr *offsetXDecl, *offsetYDecl;
+    // kernel parameter name for the image row stored in the first row of the
+    // memory passed to the kernel, e.g. a line buffer in the C back end
+    DeclRefExpr *memYDecl;
 
   public:
     HipaccAccessor(HipaccBoundaryCondition *bc, InterpolationMode mode, VarDecl
@@ -225,9 +236,11 @@ class HipaccAccessor {
       VD(VD),
       name(VD->getNameAsString()),
       crop(true),
+      decimated(false),
       widthDecl(nullptr), heightDecl(nullptr), strideDecl(nullptr),
       scaleXDecl(nullptr), scaleYDecl(nullptr),
-      offsetXDecl(nullptr), offsetYDecl(nullptr)
+      offsetXDecl(nullptr), offsetYDecl(nullptr),
+      memYDecl(nullptr)
     {}
 
     void setWidthDecl(DeclRefExpr *width) { widthDecl = width; }
@@ -237,7 +250,9 @@ class HipaccAccessor {
     void setScaleYDecl(DeclRefExpr *scale) { scaleYDecl = scale; }
     void setOffsetXDecl(DeclRefExpr *ox) { offsetXDecl = ox; }
     void setOffsetYDecl(DeclRefExpr *oy) { offsetYDecl = oy; }
+    void setMemYDecl(DeclRefExpr *my) { memYDecl = my; }
     void setNoCrop() { crop = false; }
+    void setDecimated() { decimated = true; }
     VarDecl *getDecl() { return VD; }
     const std::string &getName() const { return name; }
     HipaccBoundaryCondition *getBC() { return bc; }
@@ -254,11 +269,14 @@ class HipaccAccessor {
     DeclRefExpr *getScaleYDecl() { return scaleYDecl; }
     DeclRefExpr *getOffsetXDecl() { return offsetXDecl; }
     DeclRefExpr *getOffsetYDecl() { return offsetYDecl; }
+    DeclRefExpr *getMemYDecl() { return memYDecl; }
     void resetDecls() {
       widthDecl = heightDecl = strideDecl = nullptr;
       scaleXDecl = scaleYDecl = offsetXDecl = offsetYDecl = nullptr;
+      memYDecl = nullptr;
     }
     bool isCrop() { return crop; }
+    bool isDecimated() { return decimated; }
     BoundaryMode getBoundaryHandling() {
       return bc->getBoundaryHandling();
     }
@@ -266,12 +284,15 @@ class HipaccAccessor {
 };
 
 
-class HipaccIterationSpace {
+// the size of the iteration space is only set if known at compile time
+class HipaccIterationSpace : public HipaccSize {
   private:
     HipaccImage *img;
     VarDecl *VD;
     std::string name;
     bool crop;
+    std::string pyr_idx_str;
+    bool is_pyramid;
     // Accessor used during ASTTranslate to access the Output image
     HipaccAccessor *acc;
 
@@ -279,16 +300,25 @@ class HipaccIterationSpace {
 
   public:
     HipaccIterationSpace(HipaccImage *img, VarDecl *VD) :
+      HipaccSize(),
       img(img),
       VD(VD),
       name(VD->getNameAsString()),
       crop(true),
+      pyr_idx_str(),
+      is_pyramid(false),
       acc(nullptr)
     {
       createOutputAccessor();
     }
 
     void setNoCrop() { crop = false; }
+    void setPyramidIndex(std::string idx) {
+      is_pyramid = true;
+      pyr_idx_str = idx;
+    }
+    std::string getPyramidIndex() { return pyr_idx_str; }
+    bool isPyramid() { return is_pyramid; }
     VarDecl *getDecl() { return VD; }
     const std::string &getName() const { return name; }
     HipaccImage *getImage() { return img; }
@@ -551,9 +581,13 @@ class HipaccKernelFeatures : public HipaccDevice {
         }
       }
 
-      if (acc->getSizeX() * acc->getSizeY() >= local_memory_threshold) {
+      // decimated accessors do not read the tile around the block
+      if (acc->getSizeX() * acc->getSizeY() >= local_memory_threshold &&
+          !acc->isDecimated()) {
         mem_type = (MemoryType) (mem_type|Local);
       }
+      // vector loads read consecutive pixels
+      if (acc->isDecimated()) vectorization = false;
 
       memMap[acc] = mem_type;
       texMap[acc] = tex_type;
@@ -599,7 +633,7 @@ class HipaccKernel : public HipaccKernelFeatures {
     std::string name;
     std::string kernelName, reduceName;
     std::string fileName;
-    std::string reduceStr, infoStr;
+    std::string reduceStr, infoStr, bandStr;
     unsigned int infoStrCnt;
     HipaccIterationSpace *iterationSpace;
     std::map<FieldDecl *, HipaccAccessor *> imgMap;
@@ -619,26 +653,43 @@ class HipaccKernel : public HipaccKernelFeatures {
     unsigned int max_size_x_undef, max_size_y_undef;
     unsigned int num_threads_x, num_threads_y;
     unsigned int num_reg, num_lmem, num_smem, num_cmem;
+    // kernel fusion for the current execution
+    HipaccKernel *fusedProducer, *fusedConsumer;
+    unsigned int fusedHalo;
+    bool fusedStreaming, fusedReduction;
 
     void calcSizes();
     void calcConfig();
     void createArgInfo();
+    void resetArgInfo() {
+      argTypesC.clear();
+      argTypesCUDA.clear();
+      argTypesOpenCL.clear();
+      argTypeNames.clear();
+      argTypeNamesOpenCL.clear();
+      // hostArgNames are set later on
+      deviceArgNames.clear();
+      deviceArgFields.clear();
+      // recreate parameter information
+      createArgInfo();
+    }
     void addParam(QualType QT1, QualType QT2, QualType QT3, std::string typeC,
         std::string typeO, std::string name, FieldDecl *fd);
     void createHostArgInfo(ArrayRef<Expr *> hostArgs, std::string &hostLiterals,
         unsigned int &literalCount);
 
   public:
+    // the name defaults to the name of the kernel instance VD
     HipaccKernel(ASTContext &Ctx, VarDecl *VD, HipaccKernelClass *KC,
-        CompilerOptions &options) :
+        CompilerOptions &options, std::string instName=std::string()) :
       HipaccKernelFeatures(options, KC),
       Ctx(Ctx),
       VD(VD),
-      name(VD->getNameAsString()),
+      name(instName.empty() ? VD->getNameAsString() : instName),
       kernelName(options.getTargetPrefix() + KC->getName() + name + "Kernel"),
       reduceName(options.getTargetPrefix() + KC->getName() + name + "Reduce"),
-      fileName(options.getTargetPrefix() + KC->getName() + VD->getNameAsString()),
-      reduceStr(), infoStr(),
+      fileName(options.getTargetPrefix() + KC->getName() + name),
+      reduceStr(), infoStr(), bandStr(),
       infoStrCnt(0),
       iterationSpace(nullptr),
       imgMap(),
@@ -660,7 +711,12 @@ class HipaccKernel : public HipaccKernelFeatures {
       num_reg(0),
       num_lmem(0),
       num_smem(0),
-      num_cmem(0)
+      num_cmem(0),
+      fusedProducer(nullptr),
+      fusedConsumer(nullptr),
+      fusedHalo(0),
+      fusedStreaming(false),
+      fusedReduction(false)
     {
       switch (options.getTargetCode()) {
         case TARGET_Renderscript:
@@ -685,9 +741,42 @@ class HipaccKernel : public HipaccKernelFeatures {
       LSS << infoStrCnt++;
       infoStr = name + "_info" + LSS.str();
       reduceStr = name + "_red" + LSS.str();
+      bandStr = name + "_band" + LSS.str();
     }
     const std::string &getInfoStr() const { return infoStr; }
     const std::string &getReduceStr() const { return reduceStr; }
+    const std::string &getBandStr() const { return bandStr; }
+
+    // the consumer reads the output of the producer with a vertical offset of
+    // at most halo rows; both are executed by one launch. In streaming mode,
+    // the output of the producer is only kept in a line buffer
+    void setFusedProducer(HipaccKernel *K, unsigned int halo, bool stream) {
+      fusedProducer = K;
+      fusedHalo = halo;
+      fusedStreaming = stream;
+    }
+    void setFusedConsumer(HipaccKernel *K, bool stream) {
+      fusedConsumer = K;
+      fusedStreaming = stream;
+    }
+    // the reduction is applied to each band of rows right after the kernel
+    // computed it. In streaming mode, the output of the kernel is only kept in
+    // a line buffer
+    void setFusedReduction(bool stream) {
+      fusedReduction = true;
+      fusedStreaming = stream;
+    }
+    void resetFusion() {
+      fusedProducer = fusedConsumer = nullptr;
+      fusedHalo = 0;
+      fusedStreaming = false;
+      fusedReduction = false;
+    }
+    HipaccKernel *getFusedProducer() { return fusedProducer; }
+    HipaccKernel *getFusedConsumer() { return fusedConsumer; }
+    unsigned int getFusedHalo() { return fusedHalo; }
+    bool getFusedStreaming() { return fusedStreaming; }
+    bool getFusedReduction() { return fusedReduction; }
 
     // keep track of variables used within kernel
     void setUsed(std::string name) { usedVars.insert(name); }
@@ -739,6 +828,14 @@ class HipaccKernel : public HipaccKernelFeatures {
       if (iter == maskMap.end()) return nullptr;
       else return iter->second;
     }
+    // images are only read at the pixels retained by a subsampling consumer
+    bool readsDecimated() {
+      for (auto iter = imgMap.begin(), eiter=imgMap.end(); iter!=eiter; ++iter)
+      {
+        if (iter->second->isDecimated()) return true;
+      }
+      return false;
+    }
 
     unsigned int getNumArgs() {
       createArgInfo();
@@ -797,19 +894,24 @@ class HipaccKernel : public HipaccKernelFeatures {
       calcConfig();
       // reset parameter information since the tiling and corresponding
       // variables may have been changed
-      argTypesC.clear();
-      argTypesCUDA.clear();
-      argTypesOpenCL.clear();
-      argTypeNames.clear();
-      argTypeNamesOpenCL.clear();
-      // hostArgNames are set later on
-      deviceArgNames.clear();
-      deviceArgFields.clear();
-      // recreate parameter information
-      createArgInfo();
+      resetArgInfo();
     }
 
     void setDefaultConfig();
+    void setTunedConfig(unsigned int bsx, unsigned int bsy, unsigned int ppt,
+        bool local, TextureType tex);
+    // memory configuration stored in the tuning database: local memory used
+    // for any image and texture memory type of the images
+    void getMemoryConfig(bool &local, TextureType &tex) {
+      local = false;
+      tex = NoTexture;
+      for (auto iter=imgMap.begin(), eiter=imgMap.end(); iter!=eiter; ++iter) {
+        if (useLocalMemory(iter->second)) local = true;
+        if (useTextureMemory(iter->second))
+          tex = useTextureMemory(iter->second);
+      }
+    }
+    void printCostModel();
 
     void printStats() {
       llvm::errs() << "Statistics for Kernel '" << fileName << "'\n";
@@ -825,6 +927,7 @@ class HipaccKernel : public HipaccKernelFeatures {
         if (iter->second & Local) llvm::errs() << "local ";
         llvm::errs() << "\n";
       }
+      printCostModel();
     }
 
     unsigned int getMaxThreadsForKernel() { return max_threads_for_kernel; }
@@ -242,6 +242,10 @@ class HipaccDevice : public HipaccDeviceOptions {
     // NVIDIA only device properties
     unsigned int num_alus;
     unsigned int num_sfus;
+    // peak single-precision performance (GFLOPS) and memory bandwidth (GB/s)
+    // of a representative device, used by the cost model
+    float peak_gflops;
+    float peak_bandwidth;
 
   public:
     HipaccDevice(CompilerOptions &options) :
@@ -251,7 +255,9 @@ class HipaccDevice : public HipaccDeviceOptions {
       max_blocks_per_multiprocessor(8),
       warp_register_alloc_size(2),
       num_alus(0),
-      num_sfus(0)
+      num_sfus(0),
+      peak_gflops(0),
+      peak_bandwidth(0)
     {
       switch (target_device) {
         case TESLA_10:
@@ -267,6 +273,8 @@ class HipaccDevice : public HipaccDeviceOptions {
           allocation_granularity = BLOCK;
           num_alus = 8;
           num_sfus = 2;
+          peak_gflops = 345.6f;     // GeForce 8800 GTX
+          peak_bandwidth = 86.4f;
           break;
         case TESLA_12:
         case TESLA_13:
@@ -281,6 +289,8 @@ class HipaccDevice : public HipaccDeviceOptions {
           allocation_granularity = BLOCK;
           num_alus = 8;
           num_sfus = 2;
+          peak_gflops = 622.1f;     // GeForce GTX 280
+          peak_bandwidth = 141.7f;
           break;
         case FERMI_20:
           max_threads_per_block = 1024;
@@ -294,6 +304,8 @@ class HipaccDevice : public HipaccDeviceOptions {
           allocation_granularity = WARP;
           num_alus = 32;
           num_sfus = 4;
+          peak_gflops = 1345.0f;    // GeForce GTX 480
+          peak_bandwidth = 177.4f;
           break;
         case FERMI_21:
           max_threads_per_block = 1024;
@@ -307,6 +319,8 @@ class HipaccDevice : public HipaccDeviceOptions {
           allocation_granularity = WARP;
           num_alus = 48;
           num_sfus = 8;
+          peak_gflops = 1263.4f;    // GeForce GTX 560 Ti
+          peak_bandwidth = 128.3f;
           break;
         case KEPLER_30:
         case KEPLER_35:
@@ -325,6 +339,13 @@ class HipaccDevice : public HipaccDeviceOptions {
           num_alus = 192;
           num_sfus = 32;
           // plus 8 CUDA FP64 cores according to andatech
+          if (target_device==KEPLER_30) {
+            peak_gflops = 3090.4f;  // GeForce GTX 680
+            peak_bandwidth = 192.2f;
+          } else {
+            peak_gflops = 3519.3f;  // Tesla K20
+            peak_bandwidth = 208.0f;
+          }
           break;
         case EVERGREEN:
         case NORTHERN_ISLAND:
@@ -345,6 +366,13 @@ class HipaccDevice : public HipaccDeviceOptions {
           // Stack size? FCStacks? -> depth of branch stack ?
           num_alus = 4; // 5 on 58; 4 on 69
           num_sfus = 1; // 1 sfu -> 1 alu
+          if (target_device==EVERGREEN) {
+            peak_gflops = 2720.0f;  // Radeon HD 5870
+            peak_bandwidth = 153.6f;
+          } else {
+            peak_gflops = 2703.4f;  // Radeon HD 6970
+            peak_bandwidth = 176.0f;
+          }
           break;
         case MIDGARD:
           max_threads_per_warp = 4,
@@ -359,6 +387,8 @@ class HipaccDevice : public HipaccDeviceOptions {
           allocation_granularity = BLOCK; // unknown
           num_alus = 4; // vector 4
           num_sfus = 1; // just a guess
+          peak_gflops = 68.0f;      // Mali-T604
+          peak_bandwidth = 12.8f;
           break;
         case KNIGHTSCORNER:
           max_threads_per_warp = 4,
@@ -373,8 +403,18 @@ class HipaccDevice : public HipaccDeviceOptions {
           allocation_granularity = BLOCK; // unknown
           num_alus = 16; // 512 bit vector units - for single precision
           num_sfus = 0;
+          peak_gflops = 2416.6f;    // Xeon Phi 7120
+          peak_bandwidth = 352.0f;
           break;
       }
+
+      // C/C++ code is executed on the host CPU
+      if (options.emitC()) {
+        num_alus = 0;
+        num_sfus = 0;
+        peak_gflops = 435.2f;       // Core i7-4770, 4 cores with AVX2/FMA
+        peak_bandwidth = 25.6f;
+      }
     }
 
     bool isAMDGPU() {
@@ -60,6 +60,15 @@ enum TextureType {
   Array2D           = 0x4,
   Ldg               = 0x8
 };
+
+// instruction set for the vectorization hints emitted in C/C++ code
+enum VectorISA {
+  ISA_Native        = 0x0,
+  ISA_SSE42         = 0x1,
+  ISA_AVX           = 0x2,
+  ISA_AVX2          = 0x4,
+  ISA_AVX512        = 0x8
+};
 } // end namespace hipacc
 } // end namespace clang
 
@@ -58,6 +58,16 @@ class CreateHostStrings {
       if (cur_indent < 0) cur_indent = 0;
       indent = std::string(cur_indent, ' ');
     }
+    // transfers ordered only by the images they access for asynchronous
+    // transfers, blocking transfers otherwise
+    std::string getWriteMemoryStr() {
+      return options.asyncTransfers() ? "hipaccWriteMemoryConcurrent(" :
+                                        "hipaccWriteMemory(";
+    }
+    std::string getReadMemoryStr() {
+      return options.asyncTransfers() ? "hipaccReadMemoryConcurrent(" :
+                                        "hipaccReadMemory(";
+    }
 
   public:
     CreateHostStrings(CompilerOptions &options) :
@@ -167,8 +167,11 @@ T *ASTTranslate::lookup(std::string name, QualType QT, NamespaceDecl *NS) {
 void ASTTranslate::initCPU(SmallVector<Stmt *, 16> &kernelBody, Stmt *S) {
   VarDecl *gid_x = nullptr, *gid_y = nullptr;
 
-  // C/C++: int gid_x = offset_x;
-  if (Kernel->getIterationSpace()->getAccessor()->getOffsetXDecl()) {
+  // C/C++: int gid_x = band_start_x; or int gid_x = offset_x;
+  if (band_start_x) {
+    gid_x = createVarDecl(Ctx, kernelDecl, "gid_x", Ctx.IntTy,
+        getBandStartX());
+  } else if (Kernel->getIterationSpace()->getAccessor()->getOffsetXDecl()) {
     gid_x = createVarDecl(Ctx, kernelDecl, "gid_x", Ctx.IntTy,
         getOffsetXDecl(Kernel->getIterationSpace()->getAccessor()));
   } else {
@@ -176,8 +179,11 @@ void ASTTranslate::initCPU(SmallVector<Stmt *, 16> &kernelBody, Stmt *S) {
         createIntegerLiteral(Ctx, 0));
   }
 
-  // C/C++: int gid_y = offset_y;
-  if (Kernel->getIterationSpace()->getAccessor()->getOffsetYDecl()) {
+  // C/C++: int gid_y = band_start_y; or int gid_y = offset_y;
+  if (band_start_y) {
+    gid_y = createVarDecl(Ctx, kernelDecl, "gid_y", Ctx.IntTy,
+        getBandStartY());
+  } else if (Kernel->getIterationSpace()->getAccessor()->getOffsetYDecl()) {
     gid_y = createVarDecl(Ctx, kernelDecl, "gid_y", Ctx.IntTy,
         getOffsetYDecl(Kernel->getIterationSpace()->getAccessor()));
   } else {
@@ -205,6 +211,8 @@ void ASTTranslate::initCPU(SmallVector<Stmt *, 16> &kernelBody, Stmt *S) {
   tileVars.local_size_y = createIntegerLiteral(Ctx, 0);
 
   // check if we need border handling
+  bool kernel_x = false;
+  bool kernel_y = false;
   for (size_t i=0; i<KernelClass->getNumImages(); ++i) {
     FieldDecl *FD = KernelClass->getImgFields().data()[i];
     HipaccAccessor *Acc = Kernel->getImgFromMapping(FD);
@@ -214,21 +222,11 @@ void ASTTranslate::initCPU(SmallVector<Stmt *, 16> &kernelBody, Stmt *S) {
 
     // check if we need border handling
     if (Acc->getBoundaryHandling() != BOUNDARY_UNDEFINED) {
-      if (Acc->getSizeX() > 1) {
-          bh_variant.borders.left = 1;
-          bh_variant.borders.right = 1;
-      }
-      if (Acc->getSizeY() > 1) {
-          bh_variant.borders.top = 1;
-          bh_variant.borders.bottom = 1;
-      }
+      if (Acc->getSizeX() > 1) kernel_x = true;
+      if (Acc->getSizeY() > 1) kernel_y = true;
     }
   }
 
-  // convert the function body to kernel syntax
-  Stmt *clonedStmt = Clone(S);
-  assert(isa<CompoundStmt>(clonedStmt) && "CompoundStmt for kernel function body expected!");
-
   //
   // for (int gid_y=offset_y; gid_y<is_height+offset_y; gid_y++) {
   //     for (int gid_x=offset_x; gid_x<is_width+offset_x; gid_x++) {
@@ -236,27 +234,154 @@ void ASTTranslate::initCPU(SmallVector<Stmt *, 16> &kernelBody, Stmt *S) {
   //     }
   // }
   //
-  Expr *upper_x = getWidthDecl(Kernel->getIterationSpace()->getAccessor());
-  Expr *upper_y = getHeightDecl(Kernel->getIterationSpace()->getAccessor());
-  if (Kernel->getIterationSpace()->getAccessor()->getOffsetXDecl()) {
-    upper_x = createBinaryOperator(Ctx, upper_x,
-        getOffsetXDecl(Kernel->getIterationSpace()->getAccessor()), BO_Add,
-        Ctx.IntTy);
+  // in case of multi-threading, the row band is passed to the kernel:
+  // for (int gid_y=band_start_y; gid_y<band_end_y; gid_y++)
+  //
+  // during exploration, also the columns of a tile are passed to the kernel:
+  // for (int gid_x=band_start_x; gid_x<band_end_x; gid_x++)
+  //
+  Expr *upper_x = nullptr;
+  Expr *upper_y = nullptr;
+  if (band_end_x) {
+    upper_x = getBandEndX();
+  } else {
+    upper_x = getWidthDecl(Kernel->getIterationSpace()->getAccessor());
+    if (Kernel->getIterationSpace()->getAccessor()->getOffsetXDecl()) {
+      upper_x = createBinaryOperator(Ctx, upper_x,
+          getOffsetXDecl(Kernel->getIterationSpace()->getAccessor()), BO_Add,
+          Ctx.IntTy);
+    }
   }
-  if (Kernel->getIterationSpace()->getAccessor()->getOffsetYDecl()) {
-    upper_y = createBinaryOperator(Ctx, upper_y,
-        getOffsetYDecl(Kernel->getIterationSpace()->getAccessor()), BO_Add,
-        Ctx.IntTy);
+  if (band_end_y) {
+    upper_y = getBandEndY();
+  } else {
+    upper_y = getHeightDecl(Kernel->getIterationSpace()->getAccessor());
+    if (Kernel->getIterationSpace()->getAccessor()->getOffsetYDecl()) {
+      upper_y = createBinaryOperator(Ctx, upper_y,
+          getOffsetYDecl(Kernel->getIterationSpace()->getAccessor()), BO_Add,
+          Ctx.IntTy);
+    }
   }
-  ForStmt *innerLoop = createForStmt(Ctx, gid_x_stmt, createBinaryOperator(Ctx,
-        tileVars.global_id_x, upper_x, BO_LT, Ctx.BoolTy),
-      createUnaryOperator(Ctx, tileVars.global_id_x, UO_PostInc,
-        tileVars.global_id_x->getType()), clonedStmt);
+  Expr *inc_x = createUnaryOperator(Ctx, tileVars.global_id_x, UO_PostInc,
+      tileVars.global_id_x->getType());
+
+  Stmt *rowBody = nullptr;
+  if (!kernel_x && !kernel_y) {
+    // convert the function body to kernel syntax; separable convolutions may
+    // add statements initializing their sliding windows before the loop.
+    // Sliding windows advance by one pixel, not for decimated reads
+    sepLoopBody = Kernel->readsDecimated() ? nullptr : S;
+    Stmt *clonedStmt = Clone(S);
+    sepLoopBody = nullptr;
+    assert(isa<CompoundStmt>(clonedStmt) && "CompoundStmt for kernel function body expected!");
+
+    if (sepInitStmts.empty()) {
+      rowBody = createForStmt(Ctx, gid_x_stmt, createBinaryOperator(Ctx,
+            tileVars.global_id_x, upper_x, BO_LT, Ctx.BoolTy), inc_x,
+          clonedStmt);
+    } else {
+      SmallVector<Stmt *, 16> rowStmts;
+      rowStmts.push_back(gid_x_stmt);
+      rowStmts.append(sepInitStmts.begin(), sepInitStmts.end());
+      sepInitStmts.clear();
+      rowStmts.push_back(createForStmt(Ctx, nullptr, createBinaryOperator(Ctx,
+              tileVars.global_id_x, upper_x, BO_LT, Ctx.BoolTy), inc_x,
+            clonedStmt));
+      rowBody = createCompoundStmt(Ctx, rowStmts);
+    }
+  } else {
+    //
+    // split the iteration space into border regions and the interior; the
+    // region bounds are calculated by hipaccPrepareKernelLaunch:
+    // for (int gid_y=offset_y; gid_y<is_height+offset_y; gid_y++) {
+    //     int gid_x = offset_x;
+    //     if (bh_fall_back || gid_y < bh_start_top || gid_y >= bh_start_bottom) {
+    //         for (; gid_x<is_width+offset_x; gid_x++) body (all borders)
+    //     } else {
+    //         for (; gid_x<bh_start_left; gid_x++) body (left border)
+    //         for (; gid_x<bh_start_right; gid_x++) body (no border)
+    //         for (; gid_x<is_width+offset_x; gid_x++) body (right border)
+    //     }
+    // }
+    //
+    SmallVector<Stmt *, 16> rowStmts;
+    SmallVector<Stmt *, 16> interiorStmts;
+    rowStmts.push_back(gid_x_stmt);
+
+    // body with border handling for all borders
+    if (kernel_x) {
+      bh_variant.borders.left = 1;
+      bh_variant.borders.right = 1;
+    }
+    if (kernel_y) {
+      bh_variant.borders.top = 1;
+      bh_variant.borders.bottom = 1;
+    }
+    Stmt *borderLoop = createForStmt(Ctx, nullptr, createBinaryOperator(Ctx,
+          tileVars.global_id_x, upper_x, BO_LT, Ctx.BoolTy), inc_x,
+        Clone(S));
+    bh_variant.borderVal = 0;
+
+    // left border
+    if (kernel_x) {
+      bh_variant.borders.left = 1;
+      interiorStmts.push_back(createForStmt(Ctx, nullptr,
+            createBinaryOperator(Ctx, tileVars.global_id_x, getBHStartLeft(),
+              BO_LT, Ctx.BoolTy), inc_x, Clone(S)));
+      bh_variant.borderVal = 0;
+    }
+
+    // interior without border handling
+    sepLoopBody = Kernel->readsDecimated() ? nullptr : S;
+    Stmt *interiorBody = Clone(S);
+    sepLoopBody = nullptr;
+    interiorStmts.append(sepInitStmts.begin(), sepInitStmts.end());
+    sepInitStmts.clear();
+    Expr *interior_cond = createBinaryOperator(Ctx, tileVars.global_id_x,
+        kernel_x ? (Expr *)getBHStartRight() : upper_x, BO_LT, Ctx.BoolTy);
+    if (kernel_x && band_end_x) {
+      // the border columns belong to the first and last tile; tiles in
+      // between end within the interior
+      interior_cond = createBinaryOperator(Ctx, interior_cond,
+          createBinaryOperator(Ctx, tileVars.global_id_x, getBandEndX(),
+            BO_LT, Ctx.BoolTy), BO_LAnd, Ctx.BoolTy);
+    }
+    interiorStmts.push_back(createForStmt(Ctx, nullptr, interior_cond, inc_x,
+          interiorBody));
+
+    // right border
+    if (kernel_x) {
+      bh_variant.borders.right = 1;
+      interiorStmts.push_back(createForStmt(Ctx, nullptr,
+            createBinaryOperator(Ctx, tileVars.global_id_x, upper_x, BO_LT,
+              Ctx.BoolTy), inc_x, Clone(S)));
+      bh_variant.borderVal = 0;
+    }
+
+    // if (bh_fall_back || gid_y < bh_start_top || gid_y >= bh_start_bottom)
+    Expr *check_bop = getBHFallBack();
+    if (kernel_y) {
+      check_bop = createBinaryOperator(Ctx, check_bop,
+          createBinaryOperator(Ctx, tileVars.global_id_y, getBHStartTop(),
+            BO_LT, Ctx.BoolTy), BO_LOr, Ctx.BoolTy);
+      check_bop = createBinaryOperator(Ctx, check_bop,
+          createBinaryOperator(Ctx, tileVars.global_id_y, getBHStartBottom(),
+            BO_GE, Ctx.BoolTy), BO_LOr, Ctx.BoolTy);
+    }
+    rowStmts.push_back(createIfStmt(Ctx, check_bop, borderLoop,
+          createCompoundStmt(Ctx, interiorStmts)));
+
+    rowBody = createCompoundStmt(Ctx, rowStmts);
+  }
+
   ForStmt *outerLoop = createForStmt(Ctx, gid_y_stmt, createBinaryOperator(Ctx,
         tileVars.global_id_y, upper_y, BO_LT, Ctx.BoolTy),
       createUnaryOperator(Ctx, tileVars.global_id_y, UO_PostInc,
-        tileVars.global_id_y->getType()), innerLoop);
+        tileVars.global_id_y->getType()), rowBody);
 
+  // running sums of box filters are kept across rows
+  kernelBody.append(kernelInitStmts.begin(), kernelInitStmts.end());
+  kernelInitStmts.clear();
   kernelBody.push_back(outerLoop);
 }
 
@@ -571,9 +696,48 @@ void ASTTranslate::updateTileVars() {
 }
 
 
+// replace the width, height, and stride parameters of an Accessor covering
+// the whole image by constants in case the image size is known at compile
+// time. The parameters are not used afterwards and hence neither emitted for
+// the kernel nor passed at kernel launch.
+void ASTTranslate::specializeSizes(HipaccAccessor *Acc, bool crop,
+    SmallVector<Stmt *, 16> &kernelBody) {
+  HipaccImage *Img = Acc->getImage();
+  if (crop || !Img->getSizeX() || !Img->getSizeY() || !Img->getStride() ||
+      !Acc->getWidthDecl() || !Acc->getHeightDecl())
+    return;
+
+  DeclContext *DC = FunctionDecl::castToDeclContext(kernelDecl);
+  auto createConstant = [&] (DeclRefExpr *param, unsigned int val) {
+    VarDecl *VD = createVarDecl(Ctx, kernelDecl,
+        param->getNameInfo().getAsString() + "_const",
+        Ctx.getConstType(Ctx.IntTy), createIntegerLiteral(Ctx, (int32_t)val));
+    DC->addDecl(VD);
+    kernelBody.push_back(createDeclStmt(Ctx, VD));
+    return createDeclRefExpr(Ctx, VD);
+  };
+
+  bool strideIsWidth = Acc->getStrideDecl() == Acc->getWidthDecl();
+  Acc->setWidthDecl(createConstant(Acc->getWidthDecl(), Img->getSizeX()));
+  Acc->setHeightDecl(createConstant(Acc->getHeightDecl(), Img->getSizeY()));
+  if (strideIsWidth) {
+    Acc->setStrideDecl(Acc->getWidthDecl());
+  } else if (Acc->getStrideDecl()) {
+    Acc->setStrideDecl(createConstant(Acc->getStrideDecl(), Img->getStride()));
+  }
+}
+
+
 Stmt *ASTTranslate::Hipacc(Stmt *S) {
   if (S==nullptr) return nullptr;
 
+  // Accessors may be shared with other kernels: forget their parameters
+  Kernel->getIterationSpace()->getAccessor()->resetDecls();
+  for (size_t i=0; i<KernelClass->getNumImages(); ++i) {
+    FieldDecl *FD = KernelClass->getImgFields().data()[i];
+    Kernel->getImgFromMapping(FD)->resetDecls();
+  }
+
   // search for image width and height parameters
   for (auto I=kernelDecl->param_begin(), E=kernelDecl->param_end(); I!=E; ++I) {
     ParmVarDecl *PVD = *I;
@@ -610,6 +774,11 @@ Stmt *ASTTranslate::Hipacc(Stmt *S) {
             PVD));
       continue;
     }
+    if (PVD->getName().equals("is_mem_y")) {
+      Kernel->getIterationSpace()->getAccessor()->setMemYDecl(createDeclRefExpr(Ctx,
+            PVD));
+      continue;
+    }
     if (PVD->getName().equals("bh_start_left")) {
       bh_start_left = createDeclRefExpr(Ctx, PVD);
       continue;
@@ -630,6 +799,22 @@ Stmt *ASTTranslate::Hipacc(Stmt *S) {
       bh_fall_back = createDeclRefExpr(Ctx, PVD);
       continue;
     }
+    if (PVD->getName().equals("band_start_y")) {
+      band_start_y = createDeclRefExpr(Ctx, PVD);
+      continue;
+    }
+    if (PVD->getName().equals("band_end_y")) {
+      band_end_y = createDeclRefExpr(Ctx, PVD);
+      continue;
+    }
+    if (PVD->getName().equals("band_start_x")) {
+      band_start_x = createDeclRefExpr(Ctx, PVD);
+      continue;
+    }
+    if (PVD->getName().equals("band_end_x")) {
+      band_end_x = createDeclRefExpr(Ctx, PVD);
+      continue;
+    }
 
     if (compilerOptions.emitRenderscript() ||
         compilerOptions.emitFilterscript()) {
@@ -670,6 +855,10 @@ Stmt *ASTTranslate::Hipacc(Stmt *S) {
         Acc->setOffsetYDecl(createDeclRefExpr(Ctx, PVD));
         continue;
       }
+      if (PVD->getName().equals(FD->getNameAsString() + "_mem_y")) {
+        Acc->setMemYDecl(createDeclRefExpr(Ctx, PVD));
+        continue;
+      }
     }
   }
 
@@ -687,6 +876,17 @@ Stmt *ASTTranslate::Hipacc(Stmt *S) {
   // to kernel body
   DeclContext *DC = FunctionDecl::castToDeclContext(kernelDecl);
   SmallVector<Stmt *, 16> kernelBody;
+
+  // use constants for image sizes known at compile time
+  if (compilerOptions.specializeSizes()) {
+    specializeSizes(Kernel->getIterationSpace()->getAccessor(),
+        Kernel->getIterationSpace()->isCrop(), kernelBody);
+    for (size_t i=0; i<KernelClass->getNumImages(); ++i) {
+      FieldDecl *FD = KernelClass->getImgFields().data()[i];
+      HipaccAccessor *Acc = Kernel->getImgFromMapping(FD);
+      specializeSizes(Acc, Acc->isCrop(), kernelBody);
+    }
+  }
   FunctionDecl *barrier;
   switch (compilerOptions.getTargetCode()) {
     default:
@@ -718,10 +918,10 @@ Stmt *ASTTranslate::Hipacc(Stmt *S) {
     FieldDecl *FD = KernelClass->getImgFields().data()[i];
     HipaccAccessor *Acc = Kernel->getImgFromMapping(FD);
 
-    // add scale factor calculations for interpolation:
+    // add scale factor calculations for interpolation and decimation:
     // float acc_scale_x = (float)acc_width/is_width;
     // float acc_scale_y = (float)acc_height/is_height;
-    if (Acc->getInterpolation()!=InterpolateNO) {
+    if (Acc->getInterpolation()!=InterpolateNO || Acc->isDecimated()) {
       Expr *scaleExprX = createBinaryOperator(Ctx, createCStyleCastExpr(Ctx,
             Ctx.FloatTy, CK_IntegralToFloating, getWidthDecl(Acc), nullptr,
             Ctx.getTrivialTypeSourceInfo(Ctx.FloatTy)),
@@ -1586,6 +1786,10 @@ Stmt *ASTTranslate::VisitCompoundStmtTranslate(CompoundStmt *S) {
 
 
 Stmt *ASTTranslate::VisitReturnStmtTranslate(ReturnStmt *S) {
+  // within median lambda-functions, return statements store the value for
+  // sorting networks or update the histogram
+  if (medianTap || medianHist) return getMedianStmt(Clone(S->getRetValue()));
+
   // within convolve lambda-functions, return statements are replaced by
   // reductions
   if (convMask && convTmp) {
@@ -2350,7 +2554,7 @@ Expr *ASTTranslate::VisitCXXMemberCallExprTranslate(CXXMemberCallExpr *E) {
       // Acc.getX() method -> acc_scale_x * (gid_x - is_offset_x)
       if (ME->getMemberNameInfo().getAsString() == "getX") {
         // remove is_offset_x and scale index to Accessor size
-        if (Acc->getInterpolation()!=InterpolateNO) {
+        if (Acc->getInterpolation()!=InterpolateNO || Acc->isDecimated()) {
           return createCStyleCastExpr(Ctx, Ctx.IntTy, CK_FloatingToIntegral,
               createParenExpr(Ctx, addNNInterpolationX(Acc,
                   tileVars.global_id_x)), nullptr,
@@ -2364,7 +2568,7 @@ Expr *ASTTranslate::VisitCXXMemberCallExprTranslate(CXXMemberCallExpr *E) {
       if (ME->getMemberNameInfo().getAsString() == "getY") {
         Expr *idx_y = gidYRef;
         // scale index to Accessor size
-        if (Acc->getInterpolation()!=InterpolateNO) {
+        if (Acc->getInterpolation()!=InterpolateNO || Acc->isDecimated()) {
           idx_y = createCStyleCastExpr(Ctx, Ctx.IntTy, CK_FloatingToIntegral,
               createParenExpr(Ctx, addNNInterpolationY(Acc, idx_y)), nullptr,
               Ctx.getTrivialTypeSourceInfo(Ctx.IntTy));
@@ -171,13 +171,20 @@ Expr *ASTTranslate::addBorderHandling(DeclRefExpr *LHS, Expr *local_offset_x,
   Expr *idx_x = tileVars.global_id_x;
   Expr *idx_y = gidYRef;
 
-  // step 0: add local offset: gid_[x|y] + local_offset_[x|y]
+  // step 0: select the retained pixel for decimated reads and add local
+  // offset: gid_[x|y] + local_offset_[x|y]
+  if (Acc->isDecimated()) {
+    idx_x = addDecimationX(Acc, idx_x);
+    idx_y = addDecimationY(Acc, idx_y);
+  }
   idx_x = addLocalOffset(idx_x, local_offset_x);
   idx_y = addLocalOffset(idx_y, local_offset_y);
 
   // step 1: remove is_offset and add interpolation & boundary handling
   switch (Acc->getInterpolation()) {
     case InterpolateNO:
+      // decimation removed is_offset already
+      if (Acc->isDecimated()) break;
       if (Acc!=Kernel->getIterationSpace()->getAccessor()) {
         idx_x = removeISOffsetX(idx_x, Acc);
       }
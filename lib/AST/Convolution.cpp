@@ -33,6 +33,10 @@
 #include <limits.h>
 #include <float.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
 #include "hipacc/AST/ASTTranslate.h"
 
 using namespace clang;
@@ -225,6 +229,827 @@ Stmt *ASTTranslate::addDomainCheck(HipaccMask *Domain, DeclRefExpr *domain_var,
 }
 
 
+// check if the expression is a Mask coefficient access: mask()
+static bool isMaskCoefficient(Expr *E, FieldDecl *FD) {
+  CXXOperatorCallExpr *OCE = dyn_cast<CXXOperatorCallExpr>(
+      E->IgnoreParenImpCasts());
+  if (!OCE || OCE->getNumArgs()!=1) return false;
+
+  MemberExpr *ME = dyn_cast<MemberExpr>(OCE->getArg(0)->IgnoreParenImpCasts());
+  return ME && ME->getMemberDecl()==FD;
+}
+
+
+// check if the statement contains a Mask coefficient access
+static bool usesMaskCoefficient(Stmt *S, FieldDecl *FD) {
+  if (isa<Expr>(S) && isMaskCoefficient(dyn_cast<Expr>(S), FD)) return true;
+
+  for (auto I=S->child_begin(), E=S->child_end(); I!=E; ++I) {
+    if (*I && usesMaskCoefficient(*I, FD)) return true;
+  }
+
+  return false;
+}
+
+
+// check if a value can be evaluated ahead of the pixel it is used for, e.g.
+// before the loop over the image: its leaves have to be Accessor reads,
+// kernel members, or constants. Local variables may change per pixel or are
+// not in scope and side effects must not be moved or repeated
+bool ASTTranslate::isHoistableValue(Stmt *S) {
+  if (isa<IntegerLiteral>(S) || isa<FloatingLiteral>(S) ||
+      isa<CharacterLiteral>(S) || isa<CXXBoolLiteralExpr>(S) ||
+      isa<CXXThisExpr>(S))
+    return true;
+
+  if (DeclRefExpr *DRE = dyn_cast<DeclRefExpr>(S)) {
+    ValueDecl *VD = DRE->getDecl();
+    if (isa<EnumConstantDecl>(VD) || isa<FunctionDecl>(VD)) return true;
+
+    // only constant globals, no local variables or parameters
+    VarDecl *Var = dyn_cast<VarDecl>(VD);
+    return Var && !isa<ParmVarDecl>(Var) && !Var->isLocalVarDecl() &&
+           Var->hasGlobalStorage() && Var->getType().isConstQualified();
+  }
+
+  // kernel members are constant for the execution of the kernel
+  if (MemberExpr *ME = dyn_cast<MemberExpr>(S))
+    return isa<FieldDecl>(ME->getMemberDecl()) &&
+           isHoistableValue(ME->getBase());
+
+  // Accessor read: input(), input(dx, dy), or input(mask)
+  if (CXXOperatorCallExpr *OCE = dyn_cast<CXXOperatorCallExpr>(S)) {
+    MemberExpr *ME =
+      dyn_cast<MemberExpr>(OCE->getArg(0)->IgnoreParenImpCasts());
+    FieldDecl *FD = ME ? dyn_cast<FieldDecl>(ME->getMemberDecl()) : nullptr;
+    if (!FD || !Kernel->getImgFromMapping(FD)) return false;
+
+    for (size_t i=1, e=OCE->getNumArgs(); i<e; ++i) {
+      if (!isHoistableValue(OCE->getArg(i))) return false;
+    }
+    return true;
+  }
+
+  // member functions (output(), getX(), x(), ...) depend on the pixel
+  if (isa<CXXMemberCallExpr>(S) || isa<LambdaExpr>(S) || isa<StmtExpr>(S))
+    return false;
+
+  // no side effects
+  if (BinaryOperator *BO = dyn_cast<BinaryOperator>(S))
+    if (BO->isAssignmentOp()) return false;
+  if (UnaryOperator *UO = dyn_cast<UnaryOperator>(S))
+    if (UO->isIncrementDecrementOp()) return false;
+
+  for (auto I=S->child_begin(), E=S->child_end(); I!=E; ++I) {
+    if (*I && !isHoistableValue(*I)) return false;
+  }
+
+  return true;
+}
+
+
+// check if a constant Mask is separable, i.e. has rank 1, and get the
+// coefficients of the column and row vectors
+bool ASTTranslate::getSeparableMask(HipaccMask *Mask, SmallVector<double, 16>
+    &col, SmallVector<double, 16> &row) {
+  size_t size_x = Mask->getSizeX();
+  size_t size_y = Mask->getSizeY();
+  QualType QT = Mask->getType();
+  bool isFloat = QT->isRealFloatingType();
+
+  if (!isFloat && !QT->isIntegerType()) return false;
+
+  SmallVector<double, 64> vals;
+  size_t piv_x = 0, piv_y = 0;
+  double max_val = 0;
+  for (size_t y=0; y<size_y; ++y) {
+    for (size_t x=0; x<size_x; ++x) {
+      Expr::EvalResult result;
+      if (!Mask->getInitExpr(x, y)->EvaluateAsRValue(result, Ctx)) return false;
+
+      double val = 0;
+      if (result.Val.isFloat()) {
+        bool loses_info;
+        llvm::APFloat fval = result.Val.getFloat();
+        fval.convert(llvm::APFloat::IEEEdouble,
+            llvm::APFloat::rmNearestTiesToEven, &loses_info);
+        val = fval.convertToDouble();
+      } else if (result.Val.isInt()) {
+        val = result.Val.getInt().getSExtValue();
+      } else {
+        return false;
+      }
+
+      if (std::fabs(val) > max_val) {
+        max_val = std::fabs(val);
+        piv_x = x;
+        piv_y = y;
+      }
+      vals.push_back(val);
+    }
+  }
+  if (max_val == 0) return false;
+
+  // mask(x, y) = col[y] * row[x], normalized by the pivot element
+  double piv = vals[piv_y*size_x + piv_x];
+  double norm = piv;
+  if (!isFloat) {
+    // keep integer coefficients: divide the pivot row by its gcd
+    int64_t gcd = 0;
+    for (size_t x=0; x<size_x; ++x) {
+      int64_t a = std::abs((int64_t)vals[piv_y*size_x + x]), b = gcd;
+      while (b) { int64_t t = a % b; a = b; b = t; }
+      gcd = a;
+    }
+    norm = (double)gcd;
+  }
+
+  col.clear();
+  row.clear();
+  for (size_t x=0; x<size_x; ++x) {
+    row.push_back(vals[piv_y*size_x + x] / norm);
+  }
+  for (size_t y=0; y<size_y; ++y) {
+    col.push_back(vals[y*size_x + piv_x] * norm / piv);
+    if (!isFloat && col.back() != std::floor(col.back())) return false;
+  }
+
+  for (size_t y=0; y<size_y; ++y) {
+    for (size_t x=0; x<size_x; ++x) {
+      double diff = std::fabs(vals[y*size_x + x] - col[y]*row[x]);
+      if (isFloat ? diff > 1e-6*max_val : diff != 0) return false;
+    }
+  }
+
+  return true;
+}
+
+
+// create literal for Mask coefficient
+Expr *ASTTranslate::createMaskCoefficient(double val, QualType QT) {
+  if (!QT->isRealFloatingType()) return createIntegerLiteral(Ctx, (int32_t)val);
+
+  if (QT->isSpecificBuiltinType(BuiltinType::Float)) {
+    return FloatingLiteral::Create(Ctx, llvm::APFloat((float)val), false, QT,
+        SourceLocation());
+  }
+  return FloatingLiteral::Create(Ctx, llvm::APFloat(val), false, QT,
+      SourceLocation());
+}
+
+
+// create weighted sum of column idx_x of a separable convolution
+Expr *ASTTranslate::getSeparableColumn(Expr *val, int idx_x,
+    SmallVector<double, 16> &col, QualType QT, QualType MQT) {
+  Expr *sum = nullptr;
+
+  for (size_t y=0; y<col.size(); ++y) {
+    if (col[y] == 0) continue;
+
+    convIdxX = idx_x;
+    convIdxY = y;
+    Expr *term = createBinaryOperator(Ctx, createMaskCoefficient(col[y], MQT),
+        Clone(val), BO_Mul, QT);
+    // clear decls added while cloning last iteration
+    LambdaDeclMap.clear();
+
+    if (sum) sum = createBinaryOperator(Ctx, sum, term, BO_Add, QT);
+    else sum = term;
+  }
+
+  return sum;
+}
+
+
+// convert convolution with a constant separable Mask within the inner loop of
+// the C back end: the column sums of the last size_x columns are kept in a
+// sliding window, so that only one new column sum is computed per pixel. The
+// window is initialized before the loop (sepInitStmts)
+//
+// T _winN = col(0); ...
+// for (...) {
+//     _win0 = _win1; ... _winM = col(size_x-1);
+//     _tmp = row[0]*_win0 + ... + row[size_x-1]*_winM;
+// }
+bool ASTTranslate::convertSeparableConvolution(HipaccMask *Mask, FieldDecl *FD,
+    LambdaExpr *LE, DeclRefExpr *tmp_var, CompoundStmt *CStmt) {
+  // the window is updated once per iteration: the convolution has to be part
+  // of a top-level statement of the loop body
+  if (!sepLoopBody || CStmt!=sepLoopBody || convMode!=HipaccSUM ||
+      !Mask->isConstant() || Mask->getSizeX()<2 || Mask->getSizeY()<2)
+    return false;
+
+  // lambda-function has to be: return mask() * val;
+  CompoundStmt *body = dyn_cast<CompoundStmt>(LE->getBody());
+  if (!body || body->size()!=1 || !isa<ReturnStmt>(body->body_back()))
+    return false;
+  Expr *ret = dyn_cast<ReturnStmt>(body->body_back())->getRetValue();
+  BinaryOperator *BO = ret ?
+    dyn_cast<BinaryOperator>(ret->IgnoreParenImpCasts()) : nullptr;
+  if (!BO || BO->getOpcode()!=BO_Mul) return false;
+
+  Expr *val = nullptr;
+  if (isMaskCoefficient(BO->getLHS(), FD)) val = BO->getRHS();
+  else if (isMaskCoefficient(BO->getRHS(), FD)) val = BO->getLHS();
+  if (!val || usesMaskCoefficient(val, FD) || !isHoistableValue(val))
+    return false;
+
+  SmallVector<double, 16> col, row;
+  if (!getSeparableMask(Mask, col, row)) return false;
+
+  QualType QT = BO->getType();
+  QualType MQT = Mask->getType();
+  int size_x = Mask->getSizeX();
+  DeclContext *DC = FunctionDecl::castToDeclContext(kernelDecl);
+
+  // window of column sums, initialized with the first size_x-1 columns
+  SmallVector<DeclRefExpr *, 16> window;
+  for (int x=0; x<size_x; ++x) {
+    std::stringstream LSST;
+    LSST << "_win" << literalCount++;
+    Expr *init = x ? getSeparableColumn(val, x-1, col, QT, MQT) : nullptr;
+    VarDecl *win_decl = createVarDecl(Ctx, kernelDecl, LSST.str(), QT, init);
+    DC->addDecl(win_decl);
+    window.push_back(createDeclRefExpr(Ctx, win_decl));
+    sepInitStmts.push_back(createDeclStmt(Ctx, win_decl));
+  }
+
+  // shift window and add column sum of the new column
+  for (int x=0; x<size_x-1; ++x) {
+    preStmts.push_back(createBinaryOperator(Ctx, window[x], window[x+1],
+          BO_Assign, QT));
+    preCStmt.push_back(CStmt);
+  }
+  preStmts.push_back(createBinaryOperator(Ctx, window[size_x-1],
+        getSeparableColumn(val, size_x-1, col, QT, MQT), BO_Assign, QT));
+  preCStmt.push_back(CStmt);
+
+  // weighted sum of the column sums
+  Expr *sum = nullptr;
+  for (int x=0; x<size_x; ++x) {
+    if (row[x] == 0) continue;
+
+    Expr *term = createBinaryOperator(Ctx, createMaskCoefficient(row[x], MQT),
+        window[x], BO_Mul, QT);
+    if (sum) sum = createBinaryOperator(Ctx, sum, term, BO_Add, QT);
+    else sum = term;
+  }
+  preStmts.push_back(createBinaryOperator(Ctx, tmp_var, sum, BO_Assign,
+        tmp_var->getType()));
+  preCStmt.push_back(CStmt);
+
+  return true;
+}
+
+
+// check if the expression uses the current Mask/Domain index: getX()/getY()
+static bool usesMaskIndex(Stmt *S) {
+  if (CXXMemberCallExpr *MCE = dyn_cast<CXXMemberCallExpr>(S)) {
+    MemberExpr *ME = dyn_cast<MemberExpr>(MCE->getCallee());
+    if (ME && (ME->getMemberNameInfo().getAsString() == "getX" ||
+               ME->getMemberNameInfo().getAsString() == "getY"))
+      return true;
+  }
+
+  for (auto I=S->child_begin(), E=S->child_end(); I!=E; ++I) {
+    if (*I && usesMaskIndex(*I)) return true;
+  }
+
+  return false;
+}
+
+
+// access element idx of a local array
+static Expr *accessArray(ASTContext &Ctx, DeclRefExpr *array, Expr *idx) {
+  QualType QT = array->getType()->getAsArrayTypeUnsafe()->getElementType();
+  return new (Ctx) ArraySubscriptExpr(createImplicitCastExpr(Ctx,
+        Ctx.getPointerType(QT), CK_ArrayToPointerDecay, array, nullptr,
+        VK_RValue), idx, QT, VK_LValue, OK_Ordinary, SourceLocation());
+}
+
+
+// clone the value of a box filter for the tap at (x, y); y=-1 denotes the row
+// above the Mask/Domain
+Expr *ASTTranslate::cloneBoxTap(ConvolveMethod method, Expr *val, int x, int
+    y) {
+  Expr *result = nullptr;
+  if (method==Convolve) {
+    convIdxX = x;
+    convIdxY = y;
+    result = Clone(val);
+  } else {
+    redIdxX.push_back(x);
+    redIdxY.push_back(y);
+    result = Clone(val);
+    redIdxX.pop_back();
+    redIdxY.pop_back();
+  }
+  // clear decls added while cloning last iteration
+  LambdaDeclMap.clear();
+
+  return result;
+}
+
+
+// convert convolution with a uniform Mask or sum reduction over a full
+// constant Domain (box filter) within the inner loop of the C back end to
+// running sums, so that the costs per pixel do not depend on the window size:
+// column sums are kept per image column across rows and updated by the row
+// entering and the row leaving the window; the window sum is updated by the
+// column sum entering and the column sum leaving the window. Column sums are
+// recomputed if they were not updated for the previous row, i.e. for the first
+// row of a band and the first row after the top border. Only integer sums are
+// supported, running sums of floating-point values would accumulate rounding
+// errors over the image. The size of the image is known at compile time in C.
+//
+// T _col[SizeX+size_x]; int _row = -2;                     (kernelInitStmts)
+// for (gid_y ...) {
+//     int _vld = _row == gid_y-1; _row = gid_y;            (sepInitStmts)
+//     T _acc = 0; update(0); _acc += _col[gid_x+0]; ...
+//     for (...) {
+//         update(size_x-1); _acc += _col[gid_x+size_x-1];
+//         _tmp = c * _acc;
+//         _acc -= _col[gid_x];
+//     }
+// }
+//
+// update(x): if (_vld) { _col[gid_x+x] += val(x, size_y-1);
+//                       _col[gid_x+x] -= val(x, -1); }
+//            else _col[gid_x+x] = val(x, 0) + ... + val(x, size_y-1);
+bool ASTTranslate::convertBoxFilter(ConvolveMethod method, HipaccMask
+    *Mask, FieldDecl *FD, LambdaExpr *LE, DeclRefExpr *tmp_var, CompoundStmt
+    *CStmt) {
+  int size_x = Mask->getSizeX();
+  int size_y = Mask->getSizeY();
+
+  // the running sums are updated once per iteration: the convolution has to be
+  // part of a top-level statement of the loop body
+  if (!sepLoopBody || CStmt!=sepLoopBody || size_x*size_y < 9) return false;
+  switch (method) {
+    case Convolve:
+      if (convMode!=HipaccSUM) return false;
+      break;
+    case Reduce:
+      if (redModes.back()!=HipaccSUM || !Mask->isConstant()) return false;
+      for (int y=0; y<size_y; ++y)
+        for (int x=0; x<size_x; ++x)
+          if (!Mask->isDomainDefined(x, y)) return false;
+      break;
+    case Iterate:
+      return false;
+  }
+
+  // lambda-function has to be: return val; or return mask() * val;
+  CompoundStmt *body = dyn_cast<CompoundStmt>(LE->getBody());
+  if (!body || body->size()!=1 || !isa<ReturnStmt>(body->body_back()))
+    return false;
+  Expr *val = dyn_cast<ReturnStmt>(body->body_back())->getRetValue();
+  if (!val) return false;
+
+  QualType QT = LE->getCallOperator()->getResultType();
+  QualType MQT = Mask->getType();
+  double coefficient = 1;
+  bool weighted = false;
+  if (method==Convolve) {
+    BinaryOperator *BO = dyn_cast<BinaryOperator>(val->IgnoreParenImpCasts());
+    if (BO && BO->getOpcode()==BO_Mul) {
+      if (isMaskCoefficient(BO->getLHS(), FD)) {
+        val = BO->getRHS();
+        weighted = true;
+      } else if (isMaskCoefficient(BO->getRHS(), FD)) {
+        val = BO->getLHS();
+        weighted = true;
+      }
+    }
+    if (usesMaskCoefficient(val, FD)) return false;
+
+    if (weighted) {
+      // all coefficients of the Mask have to be the same
+      SmallVector<double, 16> col, row;
+      if (!Mask->isConstant() || !getSeparableMask(Mask, col, row))
+        return false;
+      for (auto c : col) if (c != col[0]) return false;
+      for (auto r : row) if (r != row[0]) return false;
+      coefficient = col[0] * row[0];
+
+      // the weighted terms must not be truncated to the result type
+      QT = BO->getType();
+      if (MQT->isRealFloatingType() &&
+          !LE->getCallOperator()->getResultType()->isRealFloatingType() &&
+          !LE->getCallOperator()->getResultType()->isVectorType())
+        return false;
+    }
+  }
+  if (usesMaskIndex(val) || !isHoistableValue(val)) return false;
+  if (QT->isVectorType() && Ctx.getCanonicalType(val->getType()) !=
+      Ctx.getCanonicalType(QT))
+    return false;
+  QualType EQT = QT->isVectorType() ?
+    QT->getAs<VectorType>()->getElementType() : QT;
+  if (!EQT->isIntegerType()) return false;
+
+  DeclContext *DC = FunctionDecl::castToDeclContext(kernelDecl);
+  HipaccAccessor *Acc = Kernel->getIterationSpace()->getAccessor();
+  unsigned int image_width = Acc->getImage()->getSizeX();
+  if (!image_width) return false;
+
+  // column sums and the last row they are valid for
+  std::stringstream LSSTC, LSSTR, LSSTV, LSSTA;
+  LSSTC << "_col" << literalCount++;
+  LSSTR << "_row" << literalCount++;
+  LSSTV << "_vld" << literalCount++;
+  LSSTA << "_acc" << literalCount++;
+  VarDecl *col_decl = createVarDecl(Ctx, kernelDecl, LSSTC.str(),
+      Ctx.getConstantArrayType(QT, llvm::APInt(32, image_width+size_x),
+        ArrayType::Normal, 0));
+  VarDecl *row_decl = createVarDecl(Ctx, kernelDecl, LSSTR.str(), Ctx.IntTy,
+      createIntegerLiteral(Ctx, -2));
+  DC->addDecl(col_decl);
+  DC->addDecl(row_decl);
+  DeclRefExpr *col = createDeclRefExpr(Ctx, col_decl);
+  DeclRefExpr *row = createDeclRefExpr(Ctx, row_decl);
+  kernelInitStmts.push_back(createDeclStmt(Ctx, col_decl));
+  kernelInitStmts.push_back(createDeclStmt(Ctx, row_decl));
+
+  // int _vld = _row == gid_y-1; _row = gid_y; T _acc = 0;
+  VarDecl *vld_decl = createVarDecl(Ctx, kernelDecl, LSSTV.str(), Ctx.IntTy,
+      createBinaryOperator(Ctx, row, createBinaryOperator(Ctx,
+          tileVars.global_id_y, createIntegerLiteral(Ctx, 1), BO_Sub,
+          Ctx.IntTy), BO_EQ, Ctx.BoolTy));
+  VarDecl *acc_decl = createVarDecl(Ctx, kernelDecl, LSSTA.str(), QT,
+      getInitExpr(HipaccSUM, QT));
+  DC->addDecl(vld_decl);
+  DC->addDecl(acc_decl);
+  DeclRefExpr *vld = createDeclRefExpr(Ctx, vld_decl);
+  DeclRefExpr *acc = createDeclRefExpr(Ctx, acc_decl);
+  sepInitStmts.push_back(createDeclStmt(Ctx, vld_decl));
+  sepInitStmts.push_back(createBinaryOperator(Ctx, row, tileVars.global_id_y,
+        BO_Assign, Ctx.IntTy));
+  sepInitStmts.push_back(createDeclStmt(Ctx, acc_decl));
+
+  auto getColumn = [&] (int x) {
+    return accessArray(Ctx, col, createBinaryOperator(Ctx,
+          tileVars.global_id_x, createIntegerLiteral(Ctx, x), BO_Add,
+          Ctx.IntTy));
+  };
+  auto updateColumn = [&] (int x) {
+    SmallVector<Stmt *, 16> update;
+    update.push_back(createCompoundAssignOperator(Ctx, getColumn(x),
+          cloneBoxTap(method, val, x, size_y-1), BO_AddAssign, QT));
+    update.push_back(createCompoundAssignOperator(Ctx, getColumn(x),
+          cloneBoxTap(method, val, x, -1), BO_SubAssign, QT));
+    Expr *sum = nullptr;
+    for (int y=0; y<size_y; ++y) {
+      Expr *term = cloneBoxTap(method, val, x, y);
+      if (sum) sum = createBinaryOperator(Ctx, sum, term, BO_Add, QT);
+      else sum = term;
+    }
+    return createIfStmt(Ctx, vld, createCompoundStmt(Ctx, update),
+        createBinaryOperator(Ctx, getColumn(x), sum, BO_Assign, QT));
+  };
+
+  // column sums of the first size_x-1 columns
+  for (int x=0; x<size_x-1; ++x) {
+    sepInitStmts.push_back(updateColumn(x));
+    sepInitStmts.push_back(createCompoundAssignOperator(Ctx, acc,
+          getColumn(x), BO_AddAssign, QT));
+  }
+
+  // add the entering column, remove the leaving column
+  preStmts.push_back(updateColumn(size_x-1));
+  preCStmt.push_back(CStmt);
+  preStmts.push_back(createCompoundAssignOperator(Ctx, acc,
+        getColumn(size_x-1), BO_AddAssign, QT));
+  preCStmt.push_back(CStmt);
+  Expr *result = acc;
+  if (weighted && coefficient != 1)
+    result = createBinaryOperator(Ctx, createMaskCoefficient(coefficient,
+          MQT), acc, BO_Mul, QT);
+  preStmts.push_back(createBinaryOperator(Ctx, tmp_var, result, BO_Assign,
+        tmp_var->getType()));
+  preCStmt.push_back(CStmt);
+  preStmts.push_back(createCompoundAssignOperator(Ctx, acc, getColumn(0),
+        BO_SubAssign, QT));
+  preCStmt.push_back(CStmt);
+
+  return true;
+}
+
+
+// comparators of Batcher's odd-even merge sort for n elements, pruned to the
+// comparators contributing to the median at index n/2. For each comparator,
+// the flags denote whether the minimum and/or maximum are required
+static void getMedianNetwork(int n, SmallVector<std::pair<std::pair<int, int>,
+    std::pair<bool, bool> >, 128> &network) {
+  SmallVector<std::pair<int, int>, 128> cmps;
+  for (int p=1; p<n; p<<=1) {
+    for (int k=p; k>=1; k>>=1) {
+      for (int j=k%p; j+k<n; j+=2*k) {
+        for (int i=0; i<std::min(k, n-j-k); ++i) {
+          if ((i+j)/(2*p) == (i+j+k)/(2*p))
+            cmps.push_back(std::make_pair(i+j, i+j+k));
+        }
+      }
+    }
+  }
+
+  // walk backwards from the median and keep required comparators only
+  SmallVector<bool, 64> needed(n, false);
+  needed[n/2] = true;
+  for (auto I=cmps.rbegin(), E=cmps.rend(); I!=E; ++I) {
+    int a = I->first, b = I->second;
+    if (!needed[a] && !needed[b]) continue;
+    network.push_back(std::make_pair(*I, std::make_pair((bool)needed[a],
+            (bool)needed[b])));
+    needed[a] = needed[b] = true;
+  }
+  std::reverse(network.begin(), network.end());
+}
+
+
+// replace return statement of median lambda-functions
+Stmt *ASTTranslate::getMedianStmt(Expr *ret_val) {
+  // sorting network: _medN = val;
+  if (medianTap) {
+    return createBinaryOperator(Ctx, medianTap, ret_val, BO_Assign,
+        medianTap->getType());
+  }
+
+  // histogram: { int _binN = val; _hist[_binN]++; _coarse[_binN >> 4]++; }
+  std::stringstream LSST;
+  LSST << "_bin" << literalCount++;
+  VarDecl *bin_decl = createVarDecl(Ctx, kernelDecl, LSST.str(), Ctx.IntTy,
+      ret_val);
+  DeclContext *DC = FunctionDecl::castToDeclContext(kernelDecl);
+  DC->addDecl(bin_decl);
+  DeclRefExpr *bin = createDeclRefExpr(Ctx, bin_decl);
+
+  SmallVector<Stmt *, 16> stmts;
+  stmts.push_back(createDeclStmt(Ctx, bin_decl));
+  stmts.push_back(createUnaryOperator(Ctx, accessArray(Ctx, medianHist,
+          bin), medianHistOp, Ctx.UnsignedShortTy));
+  stmts.push_back(createUnaryOperator(Ctx, accessArray(Ctx, medianCoarse,
+          createBinaryOperator(Ctx, bin, createIntegerLiteral(Ctx, 4), BO_Shr,
+            Ctx.IntTy)), medianHistOp, Ctx.UnsignedShortTy));
+
+  return createCompoundStmt(Ctx, stmts);
+}
+
+
+// clone the lambda-function for the tap at (x, y) of the Mask/Domain
+Stmt *ASTTranslate::cloneMedianTap(ConvolveMethod method, LambdaExpr *LE,
+    int x, int y) {
+  Stmt *iteration = nullptr;
+  if (method==Convolve) {
+    convIdxX = x;
+    convIdxY = y;
+    iteration = Clone(LE->getBody());
+  } else {
+    redIdxX.push_back(x);
+    redIdxY.push_back(y);
+    iteration = Clone(LE->getBody());
+    redIdxX.pop_back();
+    redIdxY.pop_back();
+  }
+  // clear decls added while cloning last iteration
+  LambdaDeclMap.clear();
+
+  return iteration;
+}
+
+
+// compute the median using a sorting network: the value of each tap is stored
+// in a separate variable and min/max comparators move the median to _med[n/2]
+//
+// T _med0, ..., _medN;
+// _med0 = val(0); ...
+// _m = _med0; _med0 = min(_m, _med1); _med1 = max(_m, _med1); ...
+// _tmp = _med[n/2];
+void ASTTranslate::convertMedianSortingNetwork(ConvolveMethod method,
+    LambdaExpr *LE, SmallVector<std::pair<int, int>, 64> &taps, DeclRefExpr
+    *tmp_var, CompoundStmt *CStmt) {
+  QualType QT = LE->getCallOperator()->getResultType();
+  DeclContext *DC = FunctionDecl::castToDeclContext(kernelDecl);
+  int n = taps.size();
+
+  FunctionDecl *min_fun = lookup<FunctionDecl>(std::string("min"), QT,
+      hipaccMathNS);
+  FunctionDecl *max_fun = lookup<FunctionDecl>(std::string("max"), QT,
+      hipaccMathNS);
+  assert(min_fun && max_fun && "could not lookup 'min'/'max'");
+
+  SmallVector<DeclRefExpr *, 64> vals;
+  for (int i=0; i<n; ++i) {
+    std::stringstream LSST;
+    LSST << "_med" << literalCount++;
+    VarDecl *med_decl = createVarDecl(Ctx, kernelDecl, LSST.str(), QT);
+    DC->addDecl(med_decl);
+    vals.push_back(createDeclRefExpr(Ctx, med_decl));
+    preStmts.push_back(createDeclStmt(Ctx, med_decl));
+    preCStmt.push_back(CStmt);
+  }
+
+  for (int i=0; i<n; ++i) {
+    medianTap = vals[i];
+    preStmts.push_back(cloneMedianTap(method, LE, taps[i].first,
+          taps[i].second));
+    preCStmt.push_back(CStmt);
+  }
+  medianTap = nullptr;
+
+  std::stringstream LSST;
+  LSST << "_med" << literalCount++;
+  VarDecl *swap_decl = createVarDecl(Ctx, kernelDecl, LSST.str(), QT);
+  DC->addDecl(swap_decl);
+  DeclRefExpr *swap = createDeclRefExpr(Ctx, swap_decl);
+  preStmts.push_back(createDeclStmt(Ctx, swap_decl));
+  preCStmt.push_back(CStmt);
+
+  auto getCall = [&] (FunctionDecl *fun, DeclRefExpr *a, DeclRefExpr *b) {
+    SmallVector<Expr *, 16> funArgs;
+    funArgs.push_back(createImplicitCastExpr(Ctx, QT, CK_LValueToRValue, a,
+          nullptr, VK_RValue));
+    funArgs.push_back(createImplicitCastExpr(Ctx, QT, CK_LValueToRValue, b,
+          nullptr, VK_RValue));
+    return createFunctionCall(Ctx, fun, funArgs);
+  };
+
+  SmallVector<std::pair<std::pair<int, int>, std::pair<bool, bool> >, 128>
+    network;
+  getMedianNetwork(n, network);
+  for (auto cmp : network) {
+    DeclRefExpr *a = vals[cmp.first.first];
+    DeclRefExpr *b = vals[cmp.first.second];
+    bool need_min = cmp.second.first, need_max = cmp.second.second;
+
+    if (need_min && need_max) {
+      preStmts.push_back(createBinaryOperator(Ctx, swap, a, BO_Assign, QT));
+      preCStmt.push_back(CStmt);
+      preStmts.push_back(createBinaryOperator(Ctx, a, getCall(min_fun, swap,
+              b), BO_Assign, QT));
+      preCStmt.push_back(CStmt);
+      preStmts.push_back(createBinaryOperator(Ctx, b, getCall(max_fun, swap,
+              b), BO_Assign, QT));
+      preCStmt.push_back(CStmt);
+    } else if (need_min) {
+      preStmts.push_back(createBinaryOperator(Ctx, a, getCall(min_fun, a, b),
+            BO_Assign, QT));
+      preCStmt.push_back(CStmt);
+    } else {
+      preStmts.push_back(createBinaryOperator(Ctx, b, getCall(max_fun, a, b),
+            BO_Assign, QT));
+      preCStmt.push_back(CStmt);
+    }
+  }
+
+  preStmts.push_back(createBinaryOperator(Ctx, tmp_var, vals[n/2], BO_Assign,
+        tmp_var->getType()));
+  preCStmt.push_back(CStmt);
+}
+
+
+// compute the median of uchar values using a two-level histogram with 16
+// coarse and 256 fine bins: the coarse bins are scanned first and only the
+// selected 16 fine bins afterwards. Within the inner loop of the C back end,
+// the histogram slides along the row (Huang's algorithm): per pixel, only the
+// new right column is added and the leftmost column removed. The histogram
+// and the first size_x-1 columns are initialized before the loop
+// (sepInitStmts)
+//
+// unsigned short _hist[256] = {0}, _coarse[16] = {0};
+// add(column(size_x-1));
+// int _bin = 0, _cnt = 0;
+// while (_cnt + _coarse[_bin] <= n/2) _cnt += _coarse[_bin++];
+// _bin <<= 4;
+// while (_cnt + _hist[_bin] <= n/2) _cnt += _hist[_bin++];
+// _tmp = _bin;
+// remove(column(0));
+void ASTTranslate::convertMedianHistogram(ConvolveMethod method, HipaccMask
+    *Mask, LambdaExpr *LE, SmallVector<std::pair<int, int>, 64> &taps,
+    DeclRefExpr *tmp_var, CompoundStmt *CStmt) {
+  DeclContext *DC = FunctionDecl::castToDeclContext(kernelDecl);
+  int n = taps.size();
+  int size_x = Mask->getSizeX(), size_y = Mask->getSizeY();
+  // the first columns are added ahead of the loop: the lambda-function may
+  // only read Accessors and constants
+  bool sliding = sepLoopBody && CStmt==sepLoopBody && n==size_x*size_y &&
+                 isHoistableValue(LE->getBody());
+
+  SmallVector<Stmt *, 16> &initStmts = sliding ? sepInitStmts : preStmts;
+  auto addInit = [&] (Stmt *S) {
+    initStmts.push_back(S);
+    if (!sliding) preCStmt.push_back(CStmt);
+  };
+  auto addStmt = [&] (Stmt *S) {
+    preStmts.push_back(S);
+    preCStmt.push_back(CStmt);
+  };
+
+  // histograms
+  SmallVector<DeclRefExpr *, 2> hists;
+  for (int bins : { 256, 16 }) {
+    std::stringstream LSST;
+    LSST << (bins==256 ? "_hist" : "_coarse") << literalCount++;
+    QualType QT = Ctx.getConstantArrayType(Ctx.UnsignedShortTy,
+        llvm::APInt(32, bins), ArrayType::Normal, 0);
+    SmallVector<Expr *, 16> initExprs;
+    initExprs.push_back(createIntegerLiteral(Ctx, 0));
+    Expr *init = new (Ctx) InitListExpr(Ctx, SourceLocation(),
+        llvm::makeArrayRef(initExprs.data(), initExprs.size()),
+        SourceLocation());
+    init->setType(QT);
+    VarDecl *hist_decl = createVarDecl(Ctx, kernelDecl, LSST.str(), QT, init);
+    DC->addDecl(hist_decl);
+    hists.push_back(createDeclRefExpr(Ctx, hist_decl));
+    addInit(createDeclStmt(Ctx, hist_decl));
+  }
+  medianHist = hists[0];
+  medianCoarse = hists[1];
+
+  // add values to the histogram
+  medianHistOp = UO_PostInc;
+  if (sliding) {
+    for (int x=0; x<size_x-1; ++x)
+      for (int y=0; y<size_y; ++y)
+        addInit(cloneMedianTap(method, LE, x, y));
+    for (int y=0; y<size_y; ++y)
+      addStmt(cloneMedianTap(method, LE, size_x-1, y));
+  } else {
+    for (auto tap : taps)
+      addStmt(cloneMedianTap(method, LE, tap.first, tap.second));
+  }
+
+  // scan coarse and fine histogram
+  std::stringstream LSSTB, LSSTC;
+  LSSTB << "_bin" << literalCount++;
+  LSSTC << "_cnt" << literalCount++;
+  VarDecl *bin_decl = createVarDecl(Ctx, kernelDecl, LSSTB.str(), Ctx.IntTy,
+      createIntegerLiteral(Ctx, 0));
+  VarDecl *cnt_decl = createVarDecl(Ctx, kernelDecl, LSSTC.str(), Ctx.IntTy,
+      createIntegerLiteral(Ctx, 0));
+  DC->addDecl(bin_decl);
+  DC->addDecl(cnt_decl);
+  DeclRefExpr *bin = createDeclRefExpr(Ctx, bin_decl);
+  DeclRefExpr *cnt = createDeclRefExpr(Ctx, cnt_decl);
+  addStmt(createDeclStmt(Ctx, bin_decl));
+  addStmt(createDeclStmt(Ctx, cnt_decl));
+
+  for (DeclRefExpr *hist : { medianCoarse, medianHist }) {
+    // while (_cnt + _hist[_bin] <= n/2) _cnt += _hist[_bin++];
+    Expr *cond = createBinaryOperator(Ctx, createBinaryOperator(Ctx, cnt,
+          accessArray(Ctx, hist, bin), BO_Add, Ctx.IntTy),
+        createIntegerLiteral(Ctx, n/2), BO_LE, Ctx.BoolTy);
+    Stmt *body = createCompoundAssignOperator(Ctx, cnt, accessArray(Ctx,
+          hist, createUnaryOperator(Ctx, bin, UO_PostInc, Ctx.IntTy)),
+        BO_AddAssign, Ctx.IntTy);
+    addStmt(createWhileStmt(Ctx, nullptr, cond, body));
+    // _bin <<= 4;
+    if (hist == medianCoarse)
+      addStmt(createCompoundAssignOperator(Ctx, bin, createIntegerLiteral(Ctx,
+              4), BO_ShlAssign, Ctx.IntTy));
+  }
+  addStmt(createBinaryOperator(Ctx, tmp_var, createImplicitCastExpr(Ctx,
+          tmp_var->getType(), CK_IntegralCast, bin, nullptr, VK_RValue),
+        BO_Assign, tmp_var->getType()));
+
+  // remove leftmost column from the sliding histogram
+  if (sliding) {
+    medianHistOp = UO_PostDec;
+    for (int y=0; y<size_y; ++y)
+      addStmt(cloneMedianTap(method, LE, 0, y));
+  }
+
+  medianHist = medianCoarse = nullptr;
+  medianHistOp = UO_PostInc;
+}
+
+
+// convert convolution/reduction computing the median (upper median for an even
+// number of taps). Sorting networks are used for all targets; large windows of
+// uchar values use histograms in the C back end instead
+void ASTTranslate::convertMedian(ConvolveMethod method, HipaccMask *Mask,
+    LambdaExpr *LE, DeclRefExpr *tmp_var, CompoundStmt *CStmt) {
+  SmallVector<std::pair<int, int>, 64> taps;
+  for (size_t y=0; y<Mask->getSizeY(); ++y) {
+    for (size_t x=0; x<Mask->getSizeX(); ++x) {
+      if (Mask->isDomain() && !Mask->isDomainDefined(x, y)) continue;
+      taps.push_back(std::make_pair(x, y));
+    }
+  }
+  assert(!taps.empty() && "median of empty Mask/Domain.");
+
+  QualType QT = LE->getCallOperator()->getResultType();
+  bool isUChar = QT->isSpecificBuiltinType(BuiltinType::UChar) ||
+                 QT->isSpecificBuiltinType(BuiltinType::Char_U);
+
+  if (compilerOptions.emitC() && isUChar && taps.size() > 25) {
+    convertMedianHistogram(method, Mask, LE, taps, tmp_var, CStmt);
+  } else {
+    convertMedianSortingNetwork(method, LE, taps, tmp_var, CStmt);
+  }
+}
+
+
 // check if we have a convolve/reduce/iterate method and convert it
 Expr *ASTTranslate::convertConvolution(CXXMemberCallExpr *E) {
   // check if this is a convolve function call
@@ -321,11 +1146,13 @@ Expr *ASTTranslate::convertConvolution(CXXMemberCallExpr *E) {
         case HipaccMEDIAN:
           if (method==Convolve) convMode = HipaccMEDIAN;
           else redModes.push_back(HipaccMEDIAN);
+          break;
         default:
           unsigned int DiagIDConvMode =
             Diags.getCustomDiagID(DiagnosticsEngine::Error,
                 "%0 mode not supported, allowed modes are: "
-                "HipaccSUM, HipaccMIN, HipaccMAX, and HipaccPROD.");
+                "HipaccSUM, HipaccMIN, HipaccMAX, HipaccPROD, and "
+                "HipaccMEDIAN.");
           Diags.Report(E->getArg(1)->getExprLoc(), DiagIDConvMode)
             << (const char *)(Mask->isDomain()?"reduction":"convolution");
           exit(EXIT_FAILURE);
@@ -385,7 +1212,7 @@ Expr *ASTTranslate::convertConvolution(CXXMemberCallExpr *E) {
   std::stringstream LSST;
   LSST << "_tmp" << literalCount++;
   Expr *init = nullptr;
-  if (method==Reduce) {
+  if (method==Reduce && redModes.back()!=HipaccMEDIAN) {
     // init temporary variable depending on aggregation mode
     init = getInitExpr(redModes.back(),
         LE->getCallOperator()->getResultType());
@@ -414,8 +1241,28 @@ Expr *ASTTranslate::convertConvolution(CXXMemberCallExpr *E) {
       break;
   }
 
-  // unroll Mask/Domain
-  for (size_t y=0; y<Mask->getSizeY(); ++y) {
+  // select the median using sorting networks or histograms
+  bool median = (method==Convolve && convMode==HipaccMEDIAN) ||
+                (method==Reduce && redModes.back()==HipaccMEDIAN);
+  if (median) {
+    if (Mask->isDomain() && !Mask->isConstant()) {
+      unsigned int DiagIDMedian =
+        Diags.getCustomDiagID(DiagnosticsEngine::Error,
+            "HipaccMEDIAN requires a constant Domain.");
+      Diags.Report(E->getArg(0)->getExprLoc(), DiagIDMedian);
+      exit(EXIT_FAILURE);
+    }
+    convertMedian(method, Mask, LE, tmp_dre, outerCompountStmt);
+  }
+
+  // use running sums for box filters, sliding window for separable masks,
+  // unroll Mask/Domain otherwise
+  bool box = !median &&
+    convertBoxFilter(method, Mask, FD, LE, tmp_dre, outerCompountStmt);
+  bool separable = method==Convolve && !median && !box &&
+    convertSeparableConvolution(Mask, FD, LE, tmp_dre, outerCompountStmt);
+  for (size_t y=0; y<Mask->getSizeY() && !separable && !median && !box;
+       ++y) {
     for (size_t x=0; x<Mask->getSizeX(); ++x) {
       bool doIterate = true;
 
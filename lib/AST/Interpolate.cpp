@@ -120,6 +120,21 @@ Expr *ASTTranslate::addNNInterpolationY(HipaccAccessor *Acc, Expr *idx_y) {
 }
 
 
+// calculate index of the pixel retained by subsampling for decimated reads
+Expr *ASTTranslate::addDecimationX(HipaccAccessor *Acc, Expr *idx_x) {
+  // (int)(acc_scale_x * (gid_x - is_offset_x))
+  return createCStyleCastExpr(Ctx, Ctx.IntTy, CK_FloatingToIntegral,
+      createParenExpr(Ctx, addNNInterpolationX(Acc, idx_x)), nullptr,
+      Ctx.getTrivialTypeSourceInfo(Ctx.IntTy));
+}
+Expr *ASTTranslate::addDecimationY(HipaccAccessor *Acc, Expr *idx_y) {
+  // (int)(acc_scale_y * gid_y)
+  return createCStyleCastExpr(Ctx, Ctx.IntTy, CK_FloatingToIntegral,
+      createParenExpr(Ctx, addNNInterpolationY(Acc, idx_y)), nullptr,
+      Ctx.getTrivialTypeSourceInfo(Ctx.IntTy));
+}
+
+
 // create interpolation function declaration
 FunctionDecl *ASTTranslate::getInterpolationFunction(HipaccAccessor *Acc) {
   // interpolation function is constructed as follows:
@@ -100,13 +100,20 @@ Expr *ASTTranslate::accessMem(DeclRefExpr *LHS, HipaccAccessor *Acc,
   Expr *idx_x = tileVars.global_id_x;
   Expr *idx_y = gidYRef;
 
-  // step 0: add local offset: gid_[x|y] + local_offset_[x|y]
+  // step 0: select the retained pixel for decimated reads and add local
+  // offset: gid_[x|y] + local_offset_[x|y]
+  if (Acc->isDecimated()) {
+    idx_x = addDecimationX(Acc, idx_x);
+    idx_y = addDecimationY(Acc, idx_y);
+  }
   idx_x = addLocalOffset(idx_x, local_offset_x);
   idx_y = addLocalOffset(idx_y, local_offset_y);
 
   // step 1: remove is_offset and add interpolation & boundary handling
   switch (Acc->getInterpolation()) {
     case InterpolateNO:
+      // decimation removed is_offset already
+      if (Acc->isDecimated()) break;
       if (Acc!=Kernel->getIterationSpace()->getAccessor()) {
         idx_x = removeISOffsetX(idx_x, Acc);
       }
@@ -230,11 +237,36 @@ Expr *ASTTranslate::accessMemArrAt(DeclRefExpr *LHS, Expr *stride, Expr *idx_x,
 // access 2D memory array at given index
 Expr *ASTTranslate::accessMem2DAt(DeclRefExpr *LHS, Expr *idx_x, Expr *idx_y) {
   QualType QT = LHS->getType();
-  QualType QT2 = QT->getPointeeType()->getAsArrayTypeUnsafe()->getElementType();
 
   // mark image as being used within the kernel
   Kernel->setUsed(LHS->getNameInfo().getAsString());
 
+  // images passed as line buffer store row mem_y at row 0 of the buffer
+  HipaccAccessor *Acc = nullptr;
+  if (outputImage && LHS->getDecl() == outputImage->getDecl()) {
+    Acc = Kernel->getIterationSpace()->getAccessor();
+  } else {
+    for (auto FD : KernelClass->getImgFields()) {
+      if (LHS->getDecl()->getName().equals(FD->getName())) {
+        Acc = Kernel->getImgFromMapping(FD);
+        break;
+      }
+    }
+  }
+  if (Acc && Acc->getMemYDecl()) {
+    Kernel->setUsed(Acc->getMemYDecl()->getNameInfo().getAsString());
+    idx_y = createBinaryOperator(Ctx, createParenExpr(Ctx, idx_y),
+        Acc->getMemYDecl(), BO_Sub, Ctx.IntTy);
+  }
+
+  // images without width known at compile time, e.g. pyramid levels, are
+  // passed as plain pointer and accessed using their stride
+  if (!QT->getPointeeType()->isArrayType()) {
+    assert(Acc && "no Accessor for image passed as pointer");
+    return accessMemArrAt(LHS, getStrideDecl(Acc), idx_x, idx_y);
+  }
+  QualType QT2 = QT->getPointeeType()->getAsArrayTypeUnsafe()->getElementType();
+
   Expr *result = new (Ctx) ArraySubscriptExpr(createImplicitCastExpr(Ctx, QT,
         CK_LValueToRValue, LHS, nullptr, VK_RValue), idx_y,
         QT->getPointeeType(), VK_LValue, OK_Ordinary, SourceLocation());
@@ -29,13 +29,17 @@
 //
 // This file implements various statistics and analysis for source-level CFGs of
 // kernel functions.
-// Statistics include number of instructions (ALU/SPU) and memory operations
-// (global memory, constant memory).
+// Statistics include number of instructions (ALU/SFU) and memory operations
+// (global memory, constant memory) per output pixel and per iteration of
+// lambda functions passed to convolve(), reduce(), and iterate().
 // Analysis include use-def analysis for vectorization.
 //
 //===----------------------------------------------------------------------===//
 
 #include "hipacc/Analysis/KernelStatistics.h"
+
+#include <clang/AST/ParentMap.h>
+#include <llvm/ADT/StringSwitch.h>
 //#define DEBUG_ANALYSIS
 
 using namespace clang;
@@ -62,14 +66,17 @@ class KernelStatsImpl {
     unsigned int DiagIDUnsupportedBO, DiagIDUnsupportedUO,
                  DiagIDUnsupportedCSCE, DiagIDUnsupportedTerm,
                  DiagIDImageAccess, DiagIDMemIncons;
-    unsigned int num_ops, num_sops;
-    unsigned int num_img_loads, num_img_stores;
-    unsigned int num_mask_loads, num_mask_stores;
+    // operation counts of the kernel body and of lambda functions; counts
+    // points to the counts of the function currently analyzed
+    OperationCounts bodyCounts;
+    std::map<const FieldDecl *, OperationCounts> lambdaCounts;
+    OperationCounts *counts;
     VectorInfo curStmtVectorize;
     bool inLambdaFunction;
 
     void runOnBlock(const CFGBlock *block);
     void runOnAllBlocks();
+    void printCounts(OperationCounts &OC, StringRef indent);
 
 
     KernelStatsImpl(AnalysisDeclContext &ac, StringRef name,
@@ -93,12 +100,9 @@ class KernelStatsImpl {
             "Accessing image pixels only supported via Accessors and output() function: %0.")),
       DiagIDMemIncons(Diags.getCustomDiagID(DiagnosticsEngine::Error,
             "Pre/post-increment/decrement not supported to assure memory consistency on GPUs: %0.")),
-      num_ops(0),
-      num_sops(0),
-      num_img_loads(0),
-      num_img_stores(0),
-      num_mask_loads(0),
-      num_mask_stores(0),
+      bodyCounts(),
+      lambdaCounts(),
+      counts(&bodyCounts),
       curStmtVectorize(SCALAR),
       inLambdaFunction(false)
     {}
@@ -139,6 +143,8 @@ class TransferFunctions : public StmtVisitor<TransferFunctions> {
     void VisitLambdaExpr(LambdaExpr *E);
     void VisitReturnStmt(ReturnStmt *S);
 
+    static bool isTranscendental(StringRef name);
+
     // TODO
     #ifdef DEBUG_ANALYSIS
     void VisitBinaryConditionalOperator(BinaryConditionalOperator *E) { llvm::errs() << "BinaryConditionalOperator:\n"; E->dump(); llvm::errs() << "\n"; }
@@ -227,6 +233,16 @@ void KernelStatsImpl::runOnBlock(const CFGBlock *block) {
 }
 
 
+void KernelStatsImpl::printCounts(OperationCounts &OC, StringRef indent) {
+  llvm::errs() << indent << "operations (ALU): "  << OC.ops << "\n"
+               << indent << "operations (SFU): "  << OC.sfu_ops << "\n"
+               << indent << "image loads: "       << OC.img_loads << "\n"
+               << indent << "image stores: "      << OC.img_stores << "\n"
+               << indent << "mask loads: "        << OC.mask_loads << "\n"
+               << indent << "mask stores: "       << OC.mask_stores << "\n";
+}
+
+
 void KernelStatsImpl::runOnAllBlocks() {
   PostOrderCFGView *POV = analysisContext.getAnalysis<PostOrderCFGView>();
   for (auto it=POV->begin(), ei=POV->end(); it!=ei; ++it) {
@@ -241,12 +257,13 @@ void KernelStatsImpl::runOnAllBlocks() {
     default:
     case UserOperator:    llvm::errs() << "Custom Operator\n"; break;
   }
-  llvm::errs() << "  operations (ALU): "    << num_ops << "\n"
-               << "  operations (SFU): "    << num_sops << "\n"
-               << "  image loads: "         << num_img_loads << "\n"
-               << "  image stores: "        << num_img_stores << "\n"
-               << "  mask loads: "          << num_mask_loads << "\n"
-               << "  mask stores: "         << num_mask_stores << "\n";
+  printCounts(bodyCounts, "  ");
+  for (auto it=lambdaCounts.begin(), ei=lambdaCounts.end(); it!=ei; ++it) {
+    llvm::errs() << "  per iteration over '"
+                 << (it->first ? it->first->getNameAsString() : "<unknown>")
+                 << "':\n";
+    printCounts(it->second, "    ");
+  }
 
   llvm::errs() << "  images:\n";
   for (auto it=imagesToAccessDetail.begin(), ei=imagesToAccessDetail.end();
@@ -314,6 +331,17 @@ KernelType KernelStatistics::getKernelType() {
 }
 
 
+OperationCounts &KernelStatistics::getOperationCounts() {
+  return getImpl(impl).bodyCounts;
+}
+
+
+std::map<const FieldDecl *, OperationCounts>
+&KernelStatistics::getLambdaOperationCounts() {
+  return getImpl(impl).lambdaCounts;
+}
+
+
 MemoryAccessDetail TransferFunctions::checkStride(Expr *EX, Expr *EY) {
   bool stride_x=true, stride_y=true;
 
@@ -369,8 +397,11 @@ bool TransferFunctions::checkImageAccess(Expr *E, MemoryAccess curMemAcc) {
         // access to Accessor
         if (KS.compilerClasses.isTypeOfTemplateClass(FD->getType(),
               KS.compilerClasses.Accessor)) {
-          if (curMemAcc & READ_ONLY) KS.num_img_loads++;
-          if (curMemAcc & WRITE_ONLY) KS.num_img_stores++;
+          if (curMemAcc & READ_ONLY) {
+            KS.counts->img_loads++;
+            KS.counts->acc_loads[FD]++;
+          }
+          if (curMemAcc & WRITE_ONLY) KS.counts->img_stores++;
 
           switch (COCE->getNumArgs()) {
             default:
@@ -401,8 +432,8 @@ bool TransferFunctions::checkImageAccess(Expr *E, MemoryAccess curMemAcc) {
         // access to Mask
         if (KS.compilerClasses.isTypeOfTemplateClass(FD->getType(),
               KS.compilerClasses.Mask)) {
-          if (curMemAcc & READ_ONLY) KS.num_mask_loads++;
-          if (curMemAcc & WRITE_ONLY) KS.num_mask_stores++;
+          if (curMemAcc & READ_ONLY) KS.counts->mask_loads++;
+          if (curMemAcc & WRITE_ONLY) KS.counts->mask_stores++;
 
           if (KS.inLambdaFunction) {
             // TODO: check for Mask as parameter and check if we need only
@@ -426,8 +457,8 @@ bool TransferFunctions::checkImageAccess(Expr *E, MemoryAccess curMemAcc) {
         // access to Domain
         if (KS.compilerClasses.isTypeOfClass(FD->getType(),
               KS.compilerClasses.Domain)) {
-          if (curMemAcc & READ_ONLY) KS.num_mask_loads++;
-          if (curMemAcc & WRITE_ONLY) KS.num_mask_stores++;
+          if (curMemAcc & READ_ONLY) KS.counts->mask_loads++;
+          if (curMemAcc & WRITE_ONLY) KS.counts->mask_stores++;
 
           if (KS.inLambdaFunction) {
             // TODO: check for Domain as parameter and check if we need only
@@ -488,8 +519,11 @@ bool TransferFunctions::checkImageAccess(Expr *E, MemoryAccess curMemAcc) {
               KS.imagesToAccessDetail[FD] = memAccDetail;
               KS.kernelType = UserOperator;
 
-              if (curMemAcc & READ_ONLY) KS.num_img_loads++;
-              if (curMemAcc & WRITE_ONLY) KS.num_img_stores++;
+              if (curMemAcc & READ_ONLY) {
+                KS.counts->img_loads++;
+                KS.counts->acc_loads[FD]++;
+              }
+              if (curMemAcc & WRITE_ONLY) KS.counts->img_stores++;
 
               return true;
             }
@@ -499,8 +533,8 @@ bool TransferFunctions::checkImageAccess(Expr *E, MemoryAccess curMemAcc) {
 
       // output()
       if (ME->getMemberNameInfo().getAsString()=="output") {
-        if (curMemAcc & READ_ONLY) KS.num_img_loads++;
-        if (curMemAcc & WRITE_ONLY) KS.num_img_stores++;
+        if (curMemAcc & READ_ONLY) KS.counts->img_loads++;
+        if (curMemAcc & WRITE_ONLY) KS.counts->img_stores++;
         MemoryAccessDetail cur = KS.outputAccessDetail;
         KS.outputAccessDetail = (MemoryAccessDetail)(cur|NO_STRIDE);
         if (KS.kernelType < PointOperator) KS.kernelType = PointOperator;
@@ -510,8 +544,8 @@ bool TransferFunctions::checkImageAccess(Expr *E, MemoryAccess curMemAcc) {
 
       // outputAtPixel()
       if (ME->getMemberNameInfo().getAsString()=="outputAtPixel") {
-        if (curMemAcc & READ_ONLY) KS.num_img_loads++;
-        if (curMemAcc & WRITE_ONLY) KS.num_img_stores++;
+        if (curMemAcc & READ_ONLY) KS.counts->img_loads++;
+        if (curMemAcc & WRITE_ONLY) KS.counts->img_stores++;
         MemoryAccessDetail cur = KS.outputAccessDetail;
         KS.outputAccessDetail = (MemoryAccessDetail)(cur|USER_XY);
         KS.kernelType = UserOperator;
@@ -532,7 +566,7 @@ void TransferFunctions::VisitBinaryOperator(BinaryOperator *E) {
     case BO_PtrMemD:
     case BO_PtrMemI:
     default:
-      KS.num_ops++;
+      KS.counts->ops++;
       if (checkImageAccess(E->getLHS(), READ_WRITE) ||
           checkImageAccess(E->getRHS(), READ_WRITE)) {
         // not supported on image objects
@@ -558,7 +592,7 @@ void TransferFunctions::VisitBinaryOperator(BinaryOperator *E) {
     case BO_Or:
     case BO_LAnd:
     case BO_LOr:
-      KS.num_ops++;
+      KS.counts->ops++;
       if (checkImageAccess(E->getLHS(), READ_ONLY)) {
         KS.curStmtVectorize = (VectorInfo) (KS.curStmtVectorize|VECTORIZE);
       }
@@ -567,7 +601,7 @@ void TransferFunctions::VisitBinaryOperator(BinaryOperator *E) {
       }
       break;
     case BO_Assign:
-      KS.num_ops++;
+      KS.counts->ops++;
       if (checkImageAccess(E->getRHS(), READ_ONLY)) {
         KS.curStmtVectorize = (VectorInfo) (KS.curStmtVectorize|VECTORIZE);
       } else {
@@ -614,7 +648,7 @@ void TransferFunctions::VisitBinaryOperator(BinaryOperator *E) {
     case BO_AndAssign:
     case BO_XorAssign:
     case BO_OrAssign:
-      KS.num_ops+=2;
+      KS.counts->ops+=2;
       if (checkImageAccess(E->getRHS(), READ_ONLY)) {
         KS.curStmtVectorize = (VectorInfo) (KS.curStmtVectorize|VECTORIZE);
       } else {
@@ -664,7 +698,7 @@ void TransferFunctions::VisitUnaryOperator(UnaryOperator *E) {
     case UO_Imag:
     case UO_Extension:
     default:
-      KS.num_ops++;
+      KS.counts->ops++;
       if (checkImageAccess(E->getSubExpr(), READ_WRITE)) {
         // not supported on image objects
         KS.Diags.Report(E->getOperatorLoc(), KS.DiagIDUnsupportedUO) <<
@@ -675,7 +709,7 @@ void TransferFunctions::VisitUnaryOperator(UnaryOperator *E) {
     case UO_PostDec:
     case UO_PreInc:
     case UO_PreDec:
-      KS.num_ops++;
+      KS.counts->ops++;
       if (checkImageAccess(E->getSubExpr(), READ_WRITE)) {
         // not supported - memory inconsistency
         KS.Diags.Report(E->getOperatorLoc(), KS.DiagIDMemIncons) <<
@@ -687,7 +721,7 @@ void TransferFunctions::VisitUnaryOperator(UnaryOperator *E) {
     case UO_Minus:
     case UO_Not:
     case UO_LNot:
-      KS.num_ops++;
+      KS.counts->ops++;
       checkImageAccess(E->getSubExpr(), READ_ONLY);
       break;
   }
@@ -699,7 +733,15 @@ void TransferFunctions::VisitCallExpr(CallExpr *E) {
   for (size_t I=0, N=E->getNumArgs(); I!=N; ++I) {
     checkImageAccess(E->getArg(I), READ_ONLY);
   }
-  KS.num_sops++;
+
+  // transcendental functions are executed on special function units (SFUs)
+  // on GPUs, all other function calls are counted as ALU operation
+  FunctionDecl *FD = E->getDirectCallee();
+  if (FD && FD->getIdentifier() && isTranscendental(FD->getName())) {
+    KS.counts->sfu_ops++;
+  } else {
+    KS.counts->ops++;
+  }
 }
 
 void TransferFunctions::VisitCStyleCastExpr(CStyleCastExpr *E) {
@@ -712,7 +754,7 @@ void TransferFunctions::VisitCStyleCastExpr(CStyleCastExpr *E) {
     case CK_FloatingToIntegral:
     case CK_FloatingToBoolean:
     case CK_FloatingCast:
-      KS.num_ops++;
+      KS.counts->ops++;
       break;
     default:
       KS.Diags.Report(E->getLParenLoc(), KS.DiagIDUnsupportedCSCE) <<
@@ -753,7 +795,54 @@ void TransferFunctions::VisitDeclRefExpr(DeclRefExpr *E) {
   }
 }
 
+bool TransferFunctions::isTranscendental(StringRef name) {
+  // strip prefix of OpenCL native and half precision variants
+  if (name.startswith("native_")) name = name.substr(7);
+  if (name.startswith("half_")) name = name.substr(5);
+
+  return llvm::StringSwitch<bool>(name)
+    .Cases("exp", "exp2", "exp10", "expm1", true)
+    .Cases("expf", "exp2f", "exp10f", "expm1f", true)
+    .Cases("log", "log2", "log10", "log1p", true)
+    .Cases("logf", "log2f", "log10f", "log1pf", true)
+    .Cases("pow", "powr", "hypot", true)
+    .Cases("powf", "hypotf", true)
+    .Cases("sqrt", "rsqrt", "cbrt", true)
+    .Cases("sqrtf", "rsqrtf", "cbrtf", true)
+    .Cases("sin", "cos", "tan", "sincos", true)
+    .Cases("sinf", "cosf", "tanf", "sincosf", true)
+    .Cases("asin", "acos", "atan", "atan2", true)
+    .Cases("asinf", "acosf", "atanf", "atan2f", true)
+    .Cases("sinh", "cosh", "tanh", true)
+    .Cases("sinhf", "coshf", "tanhf", true)
+    .Default(false);
+}
+
 void TransferFunctions::VisitLambdaExpr(LambdaExpr *E) {
+  // the lambda function is executed for each element of the Mask or Domain
+  // passed to the enclosing convolve(), reduce(), or iterate() call
+  const FieldDecl *iterDecl = nullptr;
+  ParentMap &PM = KS.analysisContext.getParentMap();
+  Stmt *parent = PM.getParent(E);
+  while (parent && !isa<CallExpr>(parent)) parent = PM.getParent(parent);
+  if (parent) {
+    CallExpr *CE = dyn_cast<CallExpr>(parent);
+    for (size_t I=0, N=CE->getNumArgs(); I!=N; ++I) {
+      MemberExpr *ME = dyn_cast<MemberExpr>(CE->getArg(I)->IgnoreParenImpCasts());
+      if (!ME || !isa<FieldDecl>(ME->getMemberDecl())) continue;
+      FieldDecl *FD = dyn_cast<FieldDecl>(ME->getMemberDecl());
+      if (KS.compilerClasses.isTypeOfTemplateClass(FD->getType(),
+            KS.compilerClasses.Mask) ||
+          KS.compilerClasses.isTypeOfClass(FD->getType(),
+            KS.compilerClasses.Domain)) {
+        iterDecl = FD;
+        break;
+      }
+    }
+  }
+  OperationCounts *outerCounts = KS.counts;
+  KS.counts = &KS.lambdaCounts[iterDecl];
+
   AnalysisDeclContext AC(/* AnalysisDeclContextManager */ 0, E->getCallOperator());
   KernelStatistics::setAnalysisOptions(AC);
 
@@ -768,6 +857,7 @@ void TransferFunctions::VisitLambdaExpr(LambdaExpr *E) {
     KS.runOnBlock(*it);
   }
   KS.inLambdaFunction = false;
+  KS.counts = outerCounts;
 }
 
 void TransferFunctions::VisitReturnStmt(ReturnStmt *S) {
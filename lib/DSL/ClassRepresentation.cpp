@@ -492,6 +492,145 @@ void HipaccKernel::setDefaultConfig() {
   num_threads_y = default_num_threads_y;
 }
 
+// configuration found by exploration; options given by the user take
+// precedence over the tuned values
+void HipaccKernel::setTunedConfig(unsigned int bsx, unsigned int bsy,
+    unsigned int ppt, bool local, TextureType tex) {
+  max_threads_for_kernel = max_threads_per_block;
+  num_threads_x = bsx;
+  num_threads_y = bsy;
+  if (options.useKernelConfig(USER_ON)) {
+    num_threads_x = default_num_threads_x;
+    num_threads_y = default_num_threads_y;
+  }
+
+  if (!options.multiplePixelsPerThread((CompilerOption)(USER_ON|USER_OFF))) {
+    pixels_per_thread[KC->getKernelType()] = ppt;
+  }
+  if (!options.useLocalMemory((CompilerOption)(USER_ON|USER_OFF))) {
+    local_memory_threshold = local ? 2 : 9999;
+  }
+  // Array2D is selected for all kernels and can't be changed per kernel
+  if (!options.useTextureMemory((CompilerOption)(USER_ON|USER_OFF)) &&
+      tex != Array2D) {
+    for (size_t i=0; i<NumOperatorTypes; ++i) {
+      require_textures[i] = tex;
+    }
+  }
+
+  // update memory types of the images and the resulting parameters
+  for (auto iter=imgMap.begin(), eiter=imgMap.end(); iter!=eiter; ++iter) {
+    calcImgFeature(iter->first, iter->second);
+  }
+  resetArgInfo();
+}
+
+// static cost model: operations and memory accesses per output pixel based on
+// the kernel statistics, where lambda functions are executed once per element
+// of the Mask or Domain they iterate over. Each input pixel is assumed to be
+// fetched once from device memory if served from texture memory, local memory,
+// or a cache; on devices without cache for global memory (Tesla), each global
+// load is fetched from device memory. The C++ back end is rated using the peak
+// values of the target device as well
+void HipaccKernel::printCostModel() {
+  KernelStatistics &stats = KC->getKernelStatistics();
+  OperationCounts &body = stats.getOperationCounts();
+  float ops = body.ops, sfu_ops = body.sfu_ops;
+  float mask_loads = body.mask_loads, img_stores = body.img_stores;
+  std::map<const FieldDecl *, float> acc_loads(body.acc_loads.begin(),
+      body.acc_loads.end());
+
+  // number of elements of a Mask or Domain
+  auto getTripCount = [] (HipaccMask *Mask) {
+    float trip_count = Mask->getSizeX() * Mask->getSizeY();
+    if (Mask->isDomain()) {
+      trip_count = 0;
+      for (size_t y=0; y<Mask->getSizeY(); ++y) {
+        for (size_t x=0; x<Mask->getSizeX(); ++x) {
+          if (Mask->isDomainDefined(x, y)) trip_count++;
+        }
+      }
+    }
+    return trip_count;
+  };
+
+  // lambda-functions not associated with a known Mask or Domain are assumed
+  // to iterate over the largest Mask/Domain or window of the kernel
+  float max_trip_count = max_size_x_undef * max_size_y_undef;
+  for (auto iter=maskMap.begin(), eiter=maskMap.end(); iter!=eiter; ++iter) {
+    max_trip_count = std::max(max_trip_count, getTripCount(iter->second));
+  }
+  max_trip_count = std::max(max_trip_count, 1.0f);
+
+  auto &lambdas = stats.getLambdaOperationCounts();
+  for (auto iter=lambdas.begin(), eiter=lambdas.end(); iter!=eiter; ++iter) {
+    HipaccMask *Mask = iter->first ?
+      getMaskFromMapping(const_cast<FieldDecl *>(iter->first)) : nullptr;
+    float trip_count = Mask ? getTripCount(Mask) : max_trip_count;
+    OperationCounts &OC = iter->second;
+    ops += trip_count * OC.ops;
+    sfu_ops += trip_count * OC.sfu_ops;
+    mask_loads += trip_count * OC.mask_loads;
+    img_stores += trip_count * OC.img_stores;
+    for (auto it=OC.acc_loads.begin(), eit=OC.acc_loads.end(); it!=eit;
+         ++it) {
+      acc_loads[it->first] += trip_count * it->second;
+    }
+  }
+
+  // classify loads by memory type and estimate bytes from device memory
+  float global_loads = 0, local_loads = 0, tex_loads = 0;
+  float bytes = img_stores > 0 ?
+    iterationSpace->getImage()->getPixelSize() : 0;
+  bool cached = options.emitC() || target_device >= FERMI_20;
+  for (auto iter=acc_loads.begin(), eiter=acc_loads.end(); iter!=eiter;
+       ++iter) {
+    HipaccAccessor *Acc =
+      getImgFromMapping(const_cast<FieldDecl *>(iter->first));
+    if (!Acc) continue;
+    unsigned int pixel_size = Acc->getImage()->getPixelSize();
+    if (useLocalMemory(Acc) && !options.emitC()) {
+      local_loads += iter->second;
+      bytes += pixel_size;
+    } else if (useTextureMemory(Acc)) {
+      tex_loads += iter->second;
+      bytes += pixel_size;
+    } else {
+      global_loads += iter->second;
+      bytes += cached ? pixel_size : iter->second * pixel_size;
+    }
+  }
+
+  // transcendental functions are weighted by the ALU/SFU throughput ratio on
+  // GPUs; on CPUs, they are implemented in software with about 20 operations
+  float sfu_cost = num_sfus ? (float)num_alus / num_sfus : 1;
+  if (options.emitC()) sfu_cost = 20;
+  float flops = ops + sfu_cost * sfu_ops;
+  float intensity = bytes > 0 ? flops / bytes : 0;
+  float balance = peak_gflops / peak_bandwidth;
+  float gflops = bytes > 0 ? std::min(peak_gflops, intensity * peak_bandwidth)
+                           : peak_gflops;
+  float mpixels = 0;
+  if (flops > 0) mpixels = gflops * 1.0e3f / flops;
+  else if (bytes > 0) mpixels = peak_bandwidth * 1.0e3f / bytes;
+
+  llvm::errs() << "Cost model for Kernel '" << kernelName << "' on '"
+               << (options.emitC() ? "host CPU" : getTargetDeviceName())
+               << "'\n";
+  llvm::errs() << "  Per output pixel: " << ops << " ALU ops, " << sfu_ops
+               << " SFU ops, " << global_loads << " global loads, "
+               << local_loads << " local loads, " << tex_loads
+               << " texture loads, " << mask_loads << " mask loads, "
+               << img_stores << " stores\n";
+  llvm::errs() << "  Operational intensity: " << intensity << " ops/byte ("
+               << flops << " ops, " << bytes << " bytes from memory)\n";
+  llvm::errs() << "  Machine balance: " << balance << " ops/byte ("
+               << peak_gflops << " GFLOPS, " << peak_bandwidth << " GB/s)\n";
+  llvm::errs() << "  Predicted: "
+               << (intensity < balance ? "bandwidth-bound" : "compute-bound")
+               << ", " << gflops << " GFLOPS, " << mpixels << " MPixel/s\n";
+}
+
 void HipaccKernel::addParam(QualType QT1, QualType QT2, QualType QT3,
     std::string typeC, std::string typeO, std::string name, FieldDecl *fd) {
   argTypesCUDA.push_back(QT1);
@@ -524,12 +663,14 @@ void HipaccKernel::createArgInfo() {
 
         break;
       case HipaccKernelClass::IterationSpace:
-        // add output image
+        // add output image; pass images without width known at compile time
+        // as plain pointer to C kernels
         addParam(Ctx.getPointerType(QT), Ctx.getPointerType(QT),
+            iterationSpace->getImage()->getSizeX() ?
             Ctx.getPointerType(Ctx.getConstantArrayType(QT, llvm::APInt(32,
                   iterationSpace->getImage()->getSizeX()), ArrayType::Normal,
-                false)), Ctx.getPointerType(QT).getAsString(), "cl_mem", name,
-            nullptr);
+                false)) : Ctx.getPointerType(QT),
+            Ctx.getPointerType(QT).getAsString(), "cl_mem", name, nullptr);
 
         break;
       case HipaccKernelClass::Image:
@@ -545,9 +686,10 @@ void HipaccKernel::createArgInfo() {
               FD);
         } else {
           addParam(Ctx.getPointerType(QT), Ctx.getPointerType(QT),
+              getImgFromMapping(FD)->getImage()->getSizeX() ?
               Ctx.getPointerType(Ctx.getConstantArrayType(QT, llvm::APInt(32,
                     getImgFromMapping(FD)->getImage()->getSizeX()),
-                  ArrayType::Normal, false)),
+                  ArrayType::Normal, false)) : Ctx.getPointerType(QT),
               Ctx.getPointerType(QT).getAsString(), "cl_mem", name, FD);
         }
 
@@ -563,8 +705,11 @@ void HipaccKernel::createArgInfo() {
             Ctx.getConstType(Ctx.IntTy).getAsString(), name + "_height",
             nullptr);
 
-        // stride
-        if (options.emitPadding() || getImgFromMapping(FD)->isCrop()) {
+        // stride; also required for C kernels if the width is not known at
+        // compile time, e.g. for pyramid levels
+        if (options.emitPadding() || getImgFromMapping(FD)->isCrop() ||
+            (options.emitC() &&
+             !getImgFromMapping(FD)->getImage()->getSizeX())) {
           addParam(Ctx.getConstType(Ctx.IntTy), Ctx.getConstType(Ctx.IntTy),
               Ctx.getConstType(Ctx.IntTy),
               Ctx.getConstType(Ctx.IntTy).getAsString(),
@@ -586,6 +731,15 @@ void HipaccKernel::createArgInfo() {
               nullptr);
         }
 
+        // mem_y: the image may be passed as line buffer in the C back end
+        if (options.emitC() && options.streamLines()) {
+          addParam(Ctx.getConstType(Ctx.IntTy), Ctx.getConstType(Ctx.IntTy),
+              Ctx.getConstType(Ctx.IntTy),
+              Ctx.getConstType(Ctx.IntTy).getAsString(),
+              Ctx.getConstType(Ctx.IntTy).getAsString(), name + "_mem_y",
+              nullptr);
+        }
+
         break;
       case HipaccKernelClass::Mask:
         QTtmp = Ctx.getPointerType(Ctx.getConstantArrayType(QT, llvm::APInt(32,
@@ -626,6 +780,33 @@ void HipaccKernel::createArgInfo() {
         Ctx.getConstType(Ctx.IntTy).getAsString(), "is_offset_y", nullptr);
   }
 
+  // band_start_y, band_end_y: rows processed by one thread of the C back end
+  if (options.emitRowBands()) {
+    addParam(Ctx.getConstType(Ctx.IntTy), Ctx.getConstType(Ctx.IntTy),
+        Ctx.getConstType(Ctx.IntTy), Ctx.getConstType(Ctx.IntTy).getAsString(),
+        Ctx.getConstType(Ctx.IntTy).getAsString(), "band_start_y", nullptr);
+    addParam(Ctx.getConstType(Ctx.IntTy), Ctx.getConstType(Ctx.IntTy),
+        Ctx.getConstType(Ctx.IntTy), Ctx.getConstType(Ctx.IntTy).getAsString(),
+        Ctx.getConstType(Ctx.IntTy).getAsString(), "band_end_y", nullptr);
+  }
+
+  // is_mem_y: the output image may be passed as line buffer in the C back end
+  if (options.emitC() && options.streamLines()) {
+    addParam(Ctx.getConstType(Ctx.IntTy), Ctx.getConstType(Ctx.IntTy),
+        Ctx.getConstType(Ctx.IntTy), Ctx.getConstType(Ctx.IntTy).getAsString(),
+        Ctx.getConstType(Ctx.IntTy).getAsString(), "is_mem_y", nullptr);
+  }
+
+  // band_start_x, band_end_x: columns processed during exploration
+  if (options.emitColumnTiles()) {
+    addParam(Ctx.getConstType(Ctx.IntTy), Ctx.getConstType(Ctx.IntTy),
+        Ctx.getConstType(Ctx.IntTy), Ctx.getConstType(Ctx.IntTy).getAsString(),
+        Ctx.getConstType(Ctx.IntTy).getAsString(), "band_start_x", nullptr);
+    addParam(Ctx.getConstType(Ctx.IntTy), Ctx.getConstType(Ctx.IntTy),
+        Ctx.getConstType(Ctx.IntTy), Ctx.getConstType(Ctx.IntTy).getAsString(),
+        Ctx.getConstType(Ctx.IntTy).getAsString(), "band_end_x", nullptr);
+  }
+
   // bh_start_left
   if (getMaxSizeX() || options.exploreConfig()) {
     addParam(Ctx.getConstType(Ctx.IntTy), Ctx.getConstType(Ctx.IntTy),
@@ -707,7 +888,8 @@ void HipaccKernel::createHostArgInfo(ArrayRef<Expr *> hostArgs, std::string
         hostArgNames.push_back(Acc->getName() + ".height");
 
         // stride
-        if (options.emitPadding() || Acc->isCrop()) {
+        if (options.emitPadding() || Acc->isCrop() ||
+            (options.emitC() && !Acc->getImage()->getSizeX())) {
           hostArgNames.push_back(Acc->getName() + ".img.stride");
         }
 
@@ -717,6 +899,11 @@ void HipaccKernel::createHostArgInfo(ArrayRef<Expr *> hostArgs, std::string
           hostArgNames.push_back(Acc->getName() + ".offset_y");
         }
 
+        // mem_y: the image is stored starting at row 0
+        if (options.emitC() && options.streamLines()) {
+          hostArgNames.push_back("0");
+        }
+
         break;
         }
       case HipaccKernelClass::Mask:
@@ -738,6 +925,23 @@ void HipaccKernel::createHostArgInfo(ArrayRef<Expr *> hostArgs, std::string
     hostArgNames.push_back(iterationSpace->getName() + ".offset_y");
   }
 
+  // band_start_y, band_end_y: set by the thread pool of the C runtime
+  if (options.emitRowBands()) {
+    hostArgNames.push_back("_band_start_y");
+    hostArgNames.push_back("_band_end_y");
+  }
+
+  // is_mem_y: the output image is stored starting at row 0
+  if (options.emitC() && options.streamLines()) {
+    hostArgNames.push_back("0");
+  }
+
+  // band_start_x, band_end_x: set by the exploration of the C runtime
+  if (options.emitColumnTiles()) {
+    hostArgNames.push_back("_band_start_x");
+    hostArgNames.push_back("_band_end_x");
+  }
+
   setInfoStr();
   // bh_start_left, bh_start_right
   if (getMaxSizeX() || options.exploreConfig()) {
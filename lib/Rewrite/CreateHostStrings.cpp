@@ -62,6 +62,12 @@ void CreateHostStrings::writeHeaders(std::string &resultStr) {
 void CreateHostStrings::writeInitialization(std::string &resultStr) {
   switch (options.getTargetCode()) {
     case TARGET_C:
+      if (options.useThreads()) {
+        std::stringstream num_threads;
+        num_threads << options.getNumThreads();
+        resultStr += "hipaccInitThreads(" + num_threads.str() + ");\n";
+        resultStr += indent;
+      }
       break;
     case TARGET_CUDA:
       resultStr += "hipaccInitCUDA();\n";
@@ -273,12 +279,12 @@ void CreateHostStrings::writeMemoryTransfer(HipaccImage *Img, std::string mem,
     MemoryTransferDirection direction, std::string &resultStr) {
   switch (direction) {
     case HOST_TO_DEVICE:
-      resultStr += "hipaccWriteMemory(";
+      resultStr += getWriteMemoryStr();
       resultStr += Img->getName();
       resultStr += ", " + mem + ");";
       break;
     case DEVICE_TO_HOST:
-      resultStr += "hipaccReadMemory(";
+      resultStr += getReadMemoryStr();
       resultStr += mem;
       resultStr += ", " + Img->getName() + ");";
       break;
@@ -299,12 +305,12 @@ void CreateHostStrings::writeMemoryTransfer(
     MemoryTransferDirection direction, std::string &resultStr) {
   switch (direction) {
     case HOST_TO_DEVICE:
-      resultStr += "hipaccWriteMemory(";
+      resultStr += getWriteMemoryStr();
       resultStr += Pyr->getName() + "(" + idx + ")";
       resultStr += ", " + mem + ");";
       break;
     case DEVICE_TO_HOST:
-      resultStr += "hipaccReadMemory(";
+      resultStr += getReadMemoryStr();
       resultStr += mem;
       resultStr += ", " + Pyr->getName() + "(" + idx + "));";
       break;
@@ -467,7 +473,28 @@ void CreateHostStrings::writeKernelCall(std::string kernelName,
   }
   infoStr = K->getInfoStr();
 
-  if (options.exploreConfig() || options.timeKernels()) {
+  // C/C++ kernels are explored and timed by the lambda launching them
+  bool collectArgs = (options.exploreConfig() || options.timeKernels()) &&
+                     !options.emitC();
+
+  // record of timed kernels for the benchmark harness; the bandwidth is
+  // estimated from the pixel sizes of the images read or written
+  std::string benchmarkStr;
+  if (options.timeKernels()) {
+    unsigned int bytes_per_pixel =
+      K->getIterationSpace()->getImage()->getPixelSize();
+    for (size_t i=0; i<KC->getNumImages(); ++i) {
+      FieldDecl *FD = KC->getImgFields().data()[i];
+      if (!K->getUsed(FD->getNameAsString())) continue;
+      bytes_per_pixel += K->getImgFromMapping(FD)->getImage()->getPixelSize();
+    }
+    std::stringstream bytes;
+    bytes << bytes_per_pixel;
+    benchmarkStr = "hipaccWriteBenchmarkRecord(\"" + kernelName + "\", " +
+      infoStr + ", " + bytes.str() + ");\n";
+  }
+
+  if (collectArgs) {
     inc_indent();
     resultStr += "{\n";
     switch (options.getTargetCode()) {
@@ -496,26 +523,28 @@ void CreateHostStrings::writeKernelCall(std::string kernelName,
     resultStr += indent;
   }
 
-  if (options.getTargetCode() != TARGET_C) {
-    // hipacc_launch_info
-    resultStr += "hipacc_launch_info " + infoStr + "(";
-    resultStr += maxSizeXStr.str() + ", ";
-    resultStr += maxSizeYStr.str() + ", ";
-    resultStr += K->getIterationSpace()->getName() + ", ";
-    resultStr += PPTSS.str() + ", ";
-    if (K->vectorize()) {
-      // TODO set and calculate per kernel simd width ...
-      resultStr += "4);\n";
-    } else {
-      resultStr += "1);\n";
-    }
-    resultStr += indent;
+  // hipacc_launch_info
+  resultStr += "hipacc_launch_info " + infoStr + "(";
+  resultStr += maxSizeXStr.str() + ", ";
+  resultStr += maxSizeYStr.str() + ", ";
+  resultStr += K->getIterationSpace()->getName() + ", ";
+  resultStr += PPTSS.str() + ", ";
+  if (K->vectorize()) {
+    // TODO set and calculate per kernel simd width ...
+    resultStr += "4);\n";
+  } else {
+    resultStr += "1);\n";
   }
+  resultStr += indent;
 
   if (!options.exploreConfig()) {
     switch (options.getTargetCode()) {
       case TARGET_C:
-          break;
+        // hipaccPrepareKernelLaunch
+        resultStr += "hipaccPrepareKernelLaunch(";
+        resultStr += infoStr + ");\n\n";
+        resultStr += indent;
+        break;
       case TARGET_CUDA:
         // dim3 block
         resultStr += "dim3 " + blockStr + "(" + cX.str() + ", " + cY.str() + ");\n";
@@ -712,7 +741,7 @@ void CreateHostStrings::writeKernelCall(std::string kernelName,
     std::string img_mem;
     if (Acc || i==0) img_mem = ".mem";
 
-    if (options.exploreConfig() || options.timeKernels()) {
+    if (collectArgs) {
       // add kernel argument
       switch (options.getTargetCode()) {
         case TARGET_C:
@@ -757,30 +786,120 @@ void CreateHostStrings::writeKernelCall(std::string kernelName,
           break;
       }
     } else {
+      // the row of a streamed image stored first in its line buffer
+      bool streamedMemY = false;
+      if (options.emitC() && K->getFusedStreaming()) {
+        if (deviceArgNames[i] == "is_mem_y") {
+          streamedMemY = K->getFusedConsumer() || K->getFusedReduction();
+        } else if (K->getFusedProducer()) {
+          for (auto imgFD : KC->getImgFields()) {
+            if (deviceArgNames[i] == imgFD->getNameAsString() + "_mem_y") {
+              streamedMemY = K->getImgFromMapping(imgFD)->getImage() ==
+                K->getFusedProducer()->getIterationSpace()->getImage();
+            }
+          }
+        }
+      }
+
       // set kernel arguments
       switch (options.getTargetCode()) {
         case TARGET_C:
           if (i==0) {
-            resultStr += "hipaccStartTiming();\n";
-            resultStr += indent;
+            // the line buffer of a streamed image is passed to the lambda
+            std::string bandParams("int _band_start_y, int _band_end_y");
+            if (K->getFusedStreaming() || K->getFusedReduction())
+              bandParams += ", void *_band_mem, int _band_mem_y";
+            if (options.emitColumnTiles())
+              bandParams += ", int _band_start_x, int _band_end_x";
+
+            if (K->getFusedConsumer()) {
+              // producer of a fused kernel pair, launched by its consumer
+              resultStr += "auto " + K->getBandStr() + " = ";
+              resultStr += "[&] (" + bandParams + ") {\n";
+              resultStr += indent + "    ";
+            } else if (options.exploreConfig()) {
+              // hipaccKernelExploration times the kernel for different
+              // thread counts, tile widths, and band heights
+              resultStr += "hipaccKernelExploration(\"" + kernelName + "\", ";
+              resultStr += infoStr + ", ";
+              resultStr += "[&] (" + bandParams + ") {\n";
+              resultStr += indent + "    ";
+            } else if (options.timeKernels()) {
+              // hipaccLaunchKernelBenchmark executes the kernel repeatedly
+              resultStr += "hipaccLaunchKernelBenchmark([&] () {\n";
+              inc_indent();
+              resultStr += indent;
+            } else {
+              resultStr += "hipaccStartTiming();\n";
+              resultStr += indent;
+            }
+            if (options.emitRowBands() && !K->getFusedConsumer() &&
+                !options.exploreConfig()) {
+              // hipaccLaunchKernel splits the iteration space into row bands
+              std::string isName = K->getIterationSpace()->getName();
+              if (K->getFusedProducer()) {
+                std::stringstream halo;
+                halo << K->getFusedHalo();
+                if (K->getFusedStreaming()) {
+                  resultStr += "hipaccLaunchStreamedKernels(";
+                } else {
+                  resultStr += "hipaccLaunchFusedKernels(";
+                }
+                resultStr += isName + ".offset_y, ";
+                resultStr += isName + ".offset_y + " + isName + ".height, ";
+                resultStr += halo.str() + ", ";
+                if (K->getFusedStreaming()) {
+                  resultStr += K->getFusedProducer()->getIterationSpace()->
+                    getImage()->getName() + ", ";
+                }
+                resultStr += K->getFusedProducer()->getBandStr();
+                resultStr += ", ";
+              } else if (K->getFusedReduction()) {
+                // hipaccLaunchReducedKernel reduces each band of rows right
+                // after the kernel computed it
+                std::string typeStr =
+                  K->getIterationSpace()->getImage()->getTypeStr();
+                resultStr += typeStr + " " + K->getReduceStr() + " = ";
+                resultStr += "hipaccLaunchReducedKernel<" + typeStr + ">(";
+                resultStr += K->getReduceName() + ", " + isName + ", ";
+                resultStr += K->getFusedStreaming() ? "true, " : "false, ";
+              } else {
+                resultStr += "hipaccLaunchKernel(" + isName + ".offset_y, ";
+                resultStr += isName + ".offset_y + " + isName + ".height, ";
+              }
+              resultStr += "[&] (" + bandParams + ") {\n";
+              resultStr += indent + "    ";
+            }
             resultStr += kernelName + "(";
           } else {
             resultStr += ", ";
           }
-          if (i==0) {
-            HipaccImage *Img =
+          if (i==0 || Acc) {
+            // images without width known at compile time, e.g. pyramid
+            // levels, are passed as plain pointer
+            HipaccImage *Img = Acc ? Acc->getImage() :
               K->getIterationSpace()->getAccessor()->getImage();
-            resultStr += "(" + Img->getTypeStr();
-            resultStr += "(*)[" + Img->getSizeXStr() + "])";
-          }
-          if (Acc) {
-            resultStr += "(" + Acc->getImage()->getTypeStr();
-            resultStr += "(*)[" + Acc->getImage()->getSizeXStr() + "])";
+            if (Img->getSizeX()) {
+              resultStr += "(" + Img->getTypeStr();
+              resultStr += "(*)[" + Img->getSizeXStr() + "])";
+            } else {
+              resultStr += "(" + Img->getTypeStr() + " *)";
+            }
           }
           if (Mask) {
             resultStr += "(" + argTypeNames[i] + ")";
           }
-          resultStr += hostArgNames[i] + img_mem;
+          if (K->getFusedStreaming() &&
+              ((i==0 && (K->getFusedConsumer() || K->getFusedReduction())) ||
+               (Acc && K->getFusedProducer() && Acc->getImage() ==
+                K->getFusedProducer()->getIterationSpace()->getImage()))) {
+            // streamed image between fused kernels or into the reduction
+            resultStr += "_band_mem";
+          } else if (streamedMemY) {
+            resultStr += "_band_mem_y";
+          } else {
+            resultStr += hostArgNames[i] + img_mem;
+          }
           break;
         case TARGET_CUDA:
           resultStr += "hipaccSetupArgument(&";
@@ -825,14 +944,32 @@ void CreateHostStrings::writeKernelCall(std::string kernelName,
   if (options.getTargetCode()==TARGET_C) {
     // close parenthesis for function call
     resultStr += ");\n";
-    resultStr += indent;
-    resultStr += "hipaccStopTiming();\n";
+    if (K->getFusedConsumer()) {
+      // close lambda of the producer
+      resultStr += indent + "};\n";
+    } else if (options.exploreConfig()) {
+      // close lambda passed to hipaccKernelExploration
+      resultStr += indent + "});\n";
+    } else {
+      if (options.emitRowBands()) {
+        // close lambda passed to hipaccLaunchKernel
+        resultStr += indent + "});\n";
+      }
+      if (options.timeKernels()) {
+        // close lambda passed to hipaccLaunchKernelBenchmark
+        dec_indent();
+        resultStr += indent + "});\n";
+        resultStr += indent + benchmarkStr;
+      } else {
+        resultStr += indent + "hipaccStopTiming(\"" + kernelName + "\");\n";
+      }
+    }
     resultStr += indent;
   }
   resultStr += "\n" + indent;
 
   // launch kernel
-  if (options.exploreConfig() || options.timeKernels()) {
+  if (collectArgs) {
     std::stringstream max_threads_per_block, max_threads_for_kernel, warp_size, max_shared_memory_per_block;
     max_threads_per_block << K->getMaxThreadsPerBlock();
     max_threads_for_kernel << K->getMaxThreadsForKernel();
@@ -898,6 +1035,18 @@ void CreateHostStrings::writeKernelCall(std::string kernelName,
         cc_string << options.getTargetDevice();
         resultStr += ", " + cc_string.str();
       }
+      if (options.useTuningDB()) {
+        // key of the tuning database: kernel, device, and configuration the
+        // kernel is compiled with
+        bool local;
+        TextureType tex;
+        K->getMemoryConfig(local, tex);
+        std::stringstream key;
+        key << kernelName << " " << options.getTargetDevice() << " "
+            << K->getPixelsPerThread() << " " << local << " " << tex;
+        resultStr += ", \"" + options.getTuningDB() + "\"";
+        resultStr += ", \"" + key.str() + "\"";
+      }
       if (0 != (options.getTargetCode() & (TARGET_Renderscript |
                                            TARGET_Filterscript))) {
         resultStr += ", " + gridStr;
@@ -908,6 +1057,7 @@ void CreateHostStrings::writeKernelCall(std::string kernelName,
       resultStr += ", true";
     }
     resultStr += ");\n";
+    if (options.timeKernels()) resultStr += indent + benchmarkStr;
     dec_indent();
     resultStr += indent + "}\n";
   } else {
@@ -924,12 +1074,18 @@ void CreateHostStrings::writeKernelCall(std::string kernelName,
         resultStr += "hipaccLaunchScriptKernel(&" + kernelName + ", ";
         resultStr += "&ScriptC_" + K->getFileName() + "::forEach_" + kernelName;
         resultStr += ", " + gridStr;
-        resultStr += ", " + blockStr + ");";
+        resultStr += ", " + blockStr;
+        resultStr += ", true, \"" + kernelName + "\");";
         break;
       case TARGET_OpenCLACC:
       case TARGET_OpenCLCPU:
       case TARGET_OpenCLGPU:
-        resultStr += "hipaccEnqueueKernel(";
+        if (options.concurrentKernels()) {
+          // the launch waits only for operations on the images it accesses
+          resultStr += "hipaccEnqueueKernelConcurrent(";
+        } else {
+          resultStr += "hipaccEnqueueKernel(";
+        }
         resultStr += kernelName;
         break;
     }
@@ -937,6 +1093,17 @@ void CreateHostStrings::writeKernelCall(std::string kernelName,
                                          TARGET_Filterscript))) {
       resultStr += ", " + gridStr;
       resultStr += ", " + blockStr;
+      if (options.emitOpenCL() && options.concurrentKernels()) {
+        // images read and written by the kernel
+        resultStr += ", {";
+        for (size_t i=0; i<KC->getNumImages(); ++i) {
+          HipaccAccessor *Acc =
+            K->getImgFromMapping(KC->getImgFields().data()[i]);
+          if (i) resultStr += ", ";
+          resultStr += Acc->getName() + ".img";
+        }
+        resultStr += "}, {" + K->getIterationSpace()->getName() + ".img}";
+      }
       resultStr += ");";
     }
   }
@@ -951,7 +1118,14 @@ void CreateHostStrings::writeReduceCall(HipaccKernelClass *KC, HipaccKernel *K,
   // print runtime function name plus name of reduction function
   switch (options.getTargetCode()) {
     case TARGET_C:
-      break;
+      // the fused reduction is part of the kernel launch
+      if (K->getFusedReduction()) return;
+      // reduction is executed on the host using the thread pool
+      resultStr += red_decl;
+      resultStr += "hipaccApplyReduction<" + typeStr + ">(";
+      resultStr += K->getReduceName() + ", ";
+      resultStr += K->getIterationSpace()->getName() + ");";
+      return;
     case TARGET_CUDA:
       resultStr += red_decl;
       if (options.getTargetDevice() >= FERMI_20 && !options.exploreConfig()) {
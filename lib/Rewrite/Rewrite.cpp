@@ -39,6 +39,72 @@ using namespace ASTNode;
 
 
 namespace {
+// count references to declarations and kernel executions within a function
+class DeclRefCounter : public RecursiveASTVisitor<DeclRefCounter> {
+  private:
+    llvm::DenseMap<ValueDecl *, unsigned int> refs;
+    llvm::DenseMap<ValueDecl *, unsigned int> executions;
+    // references not accessing pixel data: size and level queries and
+    // arguments to traverse
+    llvm::DenseMap<ValueDecl *, unsigned int> queries;
+    // assignments to images
+    llvm::DenseMap<ValueDecl *, unsigned int> writes;
+    unsigned int traversals;
+
+  public:
+    DeclRefCounter() : traversals(0) {}
+
+    bool VisitDeclRefExpr(DeclRefExpr *E) {
+      refs[E->getDecl()]++;
+      return true;
+    }
+    bool VisitCXXMemberCallExpr(CXXMemberCallExpr *E) {
+      if (E->getImplicitObjectArgument() && E->getDirectCallee()) {
+        if (DeclRefExpr *DRE = dyn_cast<DeclRefExpr>(
+              E->getImplicitObjectArgument()->IgnoreParenCasts())) {
+          std::string name = E->getDirectCallee()->getNameAsString();
+          if (name == "execute") executions[DRE->getDecl()]++;
+          if (name == "getWidth" || name == "getHeight" ||
+              name == "getLevel" || name == "isTopLevel" ||
+              name == "isBottomLevel") queries[DRE->getDecl()]++;
+        }
+      }
+      return true;
+    }
+    bool VisitCXXOperatorCallExpr(CXXOperatorCallExpr *E) {
+      if (E->getOperator() == OO_Equal && E->getNumArgs() == 2) {
+        if (DeclRefExpr *DRE =
+            dyn_cast<DeclRefExpr>(E->getArg(0)->IgnoreParenCasts())) {
+          writes[DRE->getDecl()]++;
+        }
+      }
+      return true;
+    }
+    bool VisitCallExpr(CallExpr *E) {
+      if (!isa<CXXMemberCallExpr>(E) && E->getDirectCallee() &&
+          E->getDirectCallee()->getNameAsString() == "traverse") {
+        traversals++;
+        for (size_t i=0; i<E->getNumArgs(); ++i) {
+          if (DeclRefExpr *DRE =
+              dyn_cast<DeclRefExpr>(E->getArg(i)->IgnoreParenCasts())) {
+            queries[DRE->getDecl()]++;
+          }
+        }
+      }
+      return true;
+    }
+
+    unsigned int getRefs(ValueDecl *VD) { return refs.lookup(VD); }
+    unsigned int getExecutions(ValueDecl *VD) { return executions.lookup(VD); }
+    // references that may read pixel data
+    unsigned int getReads(ValueDecl *VD) {
+      return refs.lookup(VD) - queries.lookup(VD) - writes.lookup(VD);
+    }
+    unsigned int getWrites(ValueDecl *VD) { return writes.lookup(VD); }
+    bool executesKernels() { return !executions.empty() || traversals; }
+};
+
+
 class Rewrite : public ASTConsumer,  public RecursiveASTVisitor<Rewrite> {
   private:
     // Clang internals
@@ -79,6 +145,18 @@ class Rewrite : public ASTConsumer,  public RecursiveASTVisitor<Rewrite> {
     unsigned int literalCount;
     unsigned int isLiteralCount;
 
+    // kernel execution not rewritten yet, candidate for kernel fusion
+    HipaccKernel *pendingKernel;
+    CXXMemberCallExpr *pendingCall;
+    // kernel execution not rewritten yet, candidate for fusion with a
+    // subsampling consumer
+    HipaccKernel *samplingKernel;
+    CXXMemberCallExpr *samplingCall;
+    // references within main, used to decide on line buffers
+    DeclRefCounter *mainRefs;
+    // parents of the statements within main
+    ParentMap *mainParents;
+
   public:
     Rewrite(CompilerInstance &CI, CompilerOptions &options, llvm::raw_ostream*
         o=nullptr, bool dump=false) :
@@ -95,7 +173,13 @@ class Rewrite : public ASTConsumer,  public RecursiveASTVisitor<Rewrite> {
       compilerClasses(CompilerKnownClasses()),
       mainFD(nullptr),
       literalCount(0),
-      isLiteralCount(0)
+      isLiteralCount(0),
+      pendingKernel(nullptr),
+      pendingCall(nullptr),
+      samplingKernel(nullptr),
+      samplingCall(nullptr),
+      mainRefs(nullptr),
+      mainParents(nullptr)
     {}
 
     void HandleTranslationUnit(ASTContext &Context);
@@ -120,7 +204,26 @@ class Rewrite : public ASTConsumer,  public RecursiveASTVisitor<Rewrite> {
       TextRewriteOptions.RemoveLineIfEmpty = true;
     }
 
+    void translateKernel(HipaccKernelClass *KC, HipaccKernel *K);
+    void executeKernel(HipaccKernel *K, CXXMemberCallExpr *E);
+    void rewriteKernelExecution(HipaccKernel *K, CXXMemberCallExpr *E);
+    bool isNextStatement(CXXMemberCallExpr *first, CXXMemberCallExpr *second);
+    bool checkKernelFusion(HipaccKernel *P, HipaccKernel *C, unsigned int
+        &halo, bool &stream);
+    bool checkLineStreaming(HipaccKernel *P, HipaccKernel *C, HipaccAccessor
+        *Acc);
+    bool checkReductionFusion(HipaccKernel *K, bool &stream);
+    HipaccImage *getPyramidImage(HipaccImage *Pyr);
+    bool getImageExtent(HipaccImage *Img, std::string idx, int &width, int
+        &height, int &level);
+    int compareImageExtent(HipaccImage *A, std::string idxA, HipaccImage *B,
+        std::string idxB);
+    bool checkSamplingProducer(HipaccKernel *P);
+    bool checkSamplingFusion(HipaccKernel *P, CXXMemberCallExpr *PE,
+        HipaccKernel *C, CXXMemberCallExpr *E);
+    HipaccKernel *createSamplingKernel(HipaccKernel *P, HipaccKernel *C);
     void setKernelConfiguration(HipaccKernelClass *KC, HipaccKernel *K);
+    bool setTunedConfiguration(HipaccKernel *K);
     void printReductionFunction(HipaccKernelClass *KC, HipaccKernel *K,
         PrintingPolicy Policy, llvm::raw_ostream *OS);
     void printKernelFunction(FunctionDecl *D, HipaccKernelClass *KC,
@@ -231,6 +334,18 @@ void Rewrite::HandleTranslationUnit(ASTContext &Context) {
   }
 
 
+  // rewrite kernel executions left over from kernel fusion
+  if (samplingKernel) {
+    executeKernel(samplingKernel, samplingCall);
+    samplingKernel = nullptr;
+    samplingCall = nullptr;
+  }
+  if (pendingKernel) {
+    rewriteKernelExecution(pendingKernel, pendingCall);
+    pendingKernel = nullptr;
+    pendingCall = nullptr;
+  }
+
   // add include files for CUDA
   std::string newStr;
 
@@ -700,6 +815,27 @@ bool Rewrite::VisitDeclStmt(DeclStmt *D) {
           }
           Img->setSizeX(CCE->getArg(0)->EvaluateKnownConstInt(Context).getSExtValue());
           Img->setSizeY(CCE->getArg(1)->EvaluateKnownConstInt(Context).getSExtValue());
+        } else if ((compilerOptions.specializeSizes() ||
+              compilerOptions.useTuningDB()) &&
+            CCE->getArg(0)->isEvaluatable(Context) &&
+            CCE->getArg(1)->isEvaluatable(Context)) {
+          Img->setSizeX(CCE->getArg(0)->EvaluateKnownConstInt(Context).getSExtValue());
+          Img->setSizeY(CCE->getArg(1)->EvaluateKnownConstInt(Context).getSExtValue());
+        }
+
+        // stride of the image as computed by the runtime for the allocation
+        // created below
+        if (compilerOptions.specializeSizes() && Img->getSizeX()) {
+          unsigned int stride = Img->getSizeX();
+          if (!(compilerOptions.useTextureMemory() &&
+                (compilerOptions.emitOpenCL() ||
+                 compilerOptions.getTextureType()==Array2D)) &&
+              compilerOptions.emitPadding()) {
+            unsigned int alignment = (targetDevice.alignment +
+                Img->getPixelSize() - 1) / Img->getPixelSize();
+            stride = (stride + alignment - 1) / alignment * alignment;
+          }
+          Img->setStride(stride);
         }
 
 
@@ -1058,6 +1194,7 @@ bool Rewrite::VisitDeclStmt(DeclStmt *D) {
           }
           LSS << *(IL->getValue().getRawData());
           Parms += "(" + LSS.str() + ")";
+          BC->setPyramidIndex(LSS.str());
         } else {
           if (BC->isPyramid()) {
             // add call expression to pyramid argument (from boundary condition)
@@ -1167,11 +1304,24 @@ bool Rewrite::VisitDeclStmt(DeclStmt *D) {
           }
           LSS << *(IL->getValue().getRawData());
           Parms += "(" + LSS.str() + ")";
+          IS->setPyramidIndex(LSS.str());
         }
 
         // img[, is_width, is_height[, offset_x, offset_y]]
         if (CCE->getNumArgs()<4) IS->setNoCrop();
 
+        // size of the iteration space, if known at compile time
+        if (CCE->getNumArgs()>=3) {
+          if (CCE->getArg(1)->isEvaluatable(Context) &&
+              CCE->getArg(2)->isEvaluatable(Context)) {
+            IS->setSizeX(CCE->getArg(1)->EvaluateKnownConstInt(Context).getSExtValue());
+            IS->setSizeY(CCE->getArg(2)->EvaluateKnownConstInt(Context).getSExtValue());
+          }
+        } else if (Img && Img->getSizeX() && Img->getSizeY()) {
+          IS->setSizeX(Img->getSizeX());
+          IS->setSizeY(Img->getSizeY());
+        }
+
         // get text string for arguments, argument order is:
         for (size_t i=1; i<CCE->getNumArgs(); ++i) {
           std::string Str;
@@ -1466,37 +1616,7 @@ bool Rewrite::VisitDeclStmt(DeclStmt *D) {
             }
           }
 
-          // set kernel configuration
-          setKernelConfiguration(KC, K);
-
-          // kernel declaration
-          FunctionDecl *kernelDecl = createFunctionDecl(Context,
-              Context.getTranslationUnitDecl(), K->getKernelName(), Context.VoidTy,
-              K->getArgTypes(Context, compilerOptions.getTargetCode()),
-              K->getDeviceArgNames());
-
-          // write CUDA/OpenCL kernel function to file clone old body,
-          // replacing member variables
-          ASTTranslate *Hipacc = new ASTTranslate(Context, kernelDecl, K, KC,
-              builtins, compilerOptions);
-          Stmt *kernelStmts =
-            Hipacc->Hipacc(KC->getKernelFunction()->getBody());
-          kernelDecl->setBody(kernelStmts);
-          K->printStats();
-
-          #ifdef USE_POLLY
-          if (!compilerOptions.exploreConfig() && compilerOptions.emitC()) {
-            llvm::errs() << "\nPassing the following function to Polly:\n";
-            kernelDecl->print(llvm::errs(), Context.getPrintingPolicy());
-            llvm::errs() << "\n";
-
-            Polly *polly_analysis = new Polly(Context, CI, kernelDecl);
-            polly_analysis->analyzeKernel();
-          }
-          #endif
-
-          // write kernel to file
-          printKernelFunction(kernelDecl, KC, K, K->getFileName(), true);
+          translateKernel(KC, K);
 
           break;
         }
@@ -1508,6 +1628,40 @@ bool Rewrite::VisitDeclStmt(DeclStmt *D) {
 }
 
 
+void Rewrite::translateKernel(HipaccKernelClass *KC, HipaccKernel *K) {
+  // set kernel configuration
+  setKernelConfiguration(KC, K);
+
+  // kernel declaration
+  FunctionDecl *kernelDecl = createFunctionDecl(Context,
+      Context.getTranslationUnitDecl(), K->getKernelName(), Context.VoidTy,
+      K->getArgTypes(Context, compilerOptions.getTargetCode()),
+      K->getDeviceArgNames());
+
+  // write CUDA/OpenCL kernel function to file clone old body, replacing member
+  // variables
+  ASTTranslate *Hipacc = new ASTTranslate(Context, kernelDecl, K, KC, builtins,
+      compilerOptions);
+  Stmt *kernelStmts = Hipacc->Hipacc(KC->getKernelFunction()->getBody());
+  kernelDecl->setBody(kernelStmts);
+  K->printStats();
+
+  #ifdef USE_POLLY
+  if (!compilerOptions.exploreConfig() && compilerOptions.emitC()) {
+    llvm::errs() << "\nPassing the following function to Polly:\n";
+    kernelDecl->print(llvm::errs(), Context.getPrintingPolicy());
+    llvm::errs() << "\n";
+
+    Polly *polly_analysis = new Polly(Context, CI, kernelDecl);
+    polly_analysis->analyzeKernel();
+  }
+  #endif
+
+  // write kernel to file
+  printKernelFunction(kernelDecl, KC, K, K->getFileName(), true);
+}
+
+
 bool Rewrite::VisitFunctionDecl(FunctionDecl *D) {
   if (D->isMain()) {
     assert(D->getBody() && "main function has no body.");
@@ -1872,38 +2026,38 @@ bool Rewrite::VisitCXXMemberCallExpr(CXXMemberCallExpr *E) {
       // get the user Kernel class
       if (KernelDeclMap.count(DRE->getDecl())) {
         HipaccKernel *K = KernelDeclMap[DRE->getDecl()];
-        VarDecl *VD = K->getDecl();
-        std::string newStr;
 
-        // this was checked before, when the user class was parsed
-        CXXConstructExpr *CCE = dyn_cast<CXXConstructExpr>(VD->getInit());
-        assert(CCE->getNumArgs()==K->getKernelClass()->getNumArgs() &&
-            "number of arguments doesn't match!");
-
-        // set host argument names and retrieve literals stored to temporaries
-        K->setHostArgNames(llvm::makeArrayRef(CCE->getArgs(),
-              CCE->getNumArgs()), newStr, literalCount);
-
-        //
-        // TODO: handle the case when only reduce function is specified
-        //
-        // create kernel call string
-        stringCreator.writeKernelCall(K->getKernelName(), K->getKernelClass(),
-            K, newStr);
-
-        // create reduce call string
-        if (K->getKernelClass()->getReduceFunction()) {
-          newStr += "\n" + stringCreator.getIndent();
-          stringCreator.writeReductionDeclaration(K, newStr);
-          stringCreator.writeReduceCall(K->getKernelClass(), K, newStr);
+        // the execution of a kernel is rewritten once it is known whether the
+        // next kernel execution only subsamples its output; in this case, a
+        // single kernel evaluates the first kernel at the retained pixels
+        if (samplingKernel) {
+          HipaccKernel *P = samplingKernel;
+          CXXMemberCallExpr *PE = samplingCall;
+          samplingKernel = nullptr;
+          samplingCall = nullptr;
+
+          if (checkSamplingFusion(P, PE, K, E)) {
+            K = createSamplingKernel(P, K);
+
+            // remove execution of the producer
+            SourceLocation startLoc = PE->getLocStart();
+            const char *startBuf = SM.getCharacterData(startLoc);
+            const char *semiPtr = strchr(startBuf, ';');
+            TextRewriter.RemoveText(startLoc, semiPtr-startBuf+1,
+                TextRewriteOptions);
+
+            executeKernel(K, E);
+            return true;
+          }
+          executeKernel(P, PE);
         }
 
-        // rewrite kernel invocation
-        // get the start location and compute the semi location.
-        SourceLocation startLoc = E->getLocStart();
-        const char *startBuf = SM.getCharacterData(startLoc);
-        const char *semiPtr = strchr(startBuf, ';');
-        TextRewriter.ReplaceText(startLoc, semiPtr-startBuf+1, newStr);
+        if (checkSamplingProducer(K)) {
+          samplingKernel = K;
+          samplingCall = E;
+        } else {
+          executeKernel(K, E);
+        }
       }
     }
   }
@@ -1980,7 +2134,612 @@ bool Rewrite::VisitCallExpr (CallExpr *E) {
 }
 
 
+void Rewrite::executeKernel(HipaccKernel *K, CXXMemberCallExpr *E) {
+  if (!compilerOptions.fuseKernels()) {
+    rewriteKernelExecution(K, E);
+    return;
+  }
+
+  // the launch of a kernel is rewritten once it is known whether the next
+  // statement executes a kernel consuming its output
+  if (pendingKernel) {
+    unsigned int halo = 0;
+    bool stream = false;
+    if (isNextStatement(pendingCall, E) &&
+        checkKernelFusion(pendingKernel, K, halo, stream)) {
+      pendingKernel->setFusedConsumer(K, stream);
+      K->setFusedProducer(pendingKernel, halo, stream);
+    }
+    rewriteKernelExecution(pendingKernel, pendingCall);
+    pendingKernel = nullptr;
+    pendingCall = nullptr;
+  }
+
+  if (K->getFusedProducer() || K->getKernelClass()->getReduceFunction()) {
+    rewriteKernelExecution(K, E);
+  } else {
+    pendingKernel = K;
+    pendingCall = E;
+  }
+}
+
+
+void Rewrite::rewriteKernelExecution(HipaccKernel *K, CXXMemberCallExpr *E) {
+  VarDecl *VD = K->getDecl();
+  std::string newStr;
+
+  // this was checked before, when the user class was parsed
+  CXXConstructExpr *CCE = dyn_cast<CXXConstructExpr>(VD->getInit());
+  assert(CCE->getNumArgs()==K->getKernelClass()->getNumArgs() &&
+      "number of arguments doesn't match!");
+
+  // set host argument names and retrieve literals stored to temporaries
+  K->setHostArgNames(llvm::makeArrayRef(CCE->getArgs(),
+        CCE->getNumArgs()), newStr, literalCount);
+
+  //
+  // TODO: handle the case when only reduce function is specified
+  //
+  // apply the reduction to the bands of rows computed by the kernel
+  bool stream = false;
+  if (K->getKernelClass()->getReduceFunction() && !K->getFusedProducer() &&
+      checkReductionFusion(K, stream)) {
+    K->setFusedReduction(stream);
+  }
+
+  // create kernel call string
+  stringCreator.writeKernelCall(K->getKernelName(), K->getKernelClass(), K,
+      newStr);
+
+  // create reduce call string
+  if (K->getKernelClass()->getReduceFunction()) {
+    newStr += "\n" + stringCreator.getIndent();
+    stringCreator.writeReductionDeclaration(K, newStr);
+    stringCreator.writeReduceCall(K->getKernelClass(), K, newStr);
+  }
+  K->resetFusion();
+
+  // rewrite kernel invocation
+  // get the start location and compute the semi location.
+  SourceLocation startLoc = E->getLocStart();
+  const char *startBuf = SM.getCharacterData(startLoc);
+  const char *semiPtr = strchr(startBuf, ';');
+  TextRewriter.ReplaceText(startLoc, semiPtr-startBuf+1, newStr);
+}
+
+
+// check if the statement following the first call is the second call, i.e.
+// only white space and comments are in between
+bool Rewrite::isNextStatement(CXXMemberCallExpr *first, CXXMemberCallExpr
+    *second) {
+  if (SM.getFileID(first->getLocStart()) != mainFileID ||
+      SM.getFileID(second->getLocStart()) != mainFileID) return false;
+
+  const char *curPtr = strchr(SM.getCharacterData(first->getLocEnd()), ';');
+  const char *endPtr = SM.getCharacterData(second->getLocStart());
+  if (!curPtr || curPtr >= endPtr) return false;
+
+  for (++curPtr; curPtr < endPtr; ++curPtr) {
+    if (isspace(*curPtr)) continue;
+    if (!strncmp(curPtr, "//", 2)) {
+      curPtr = strchr(curPtr, '\n');
+      if (!curPtr) return false;
+      continue;
+    }
+    if (!strncmp(curPtr, "/*", 2)) {
+      curPtr = strstr(curPtr+2, "*/");
+      if (!curPtr) return false;
+      ++curPtr;
+      continue;
+    }
+    return false;
+  }
+
+  return true;
+}
+
+
+// check if the consumer kernel C can be fused with the producer kernel P that
+// is executed directly before: both have to process the same rows and C may
+// read the output of P only with a bounded vertical offset (halo)
+bool Rewrite::checkKernelFusion(HipaccKernel *P, HipaccKernel *C, unsigned int
+    &halo, bool &stream) {
+  HipaccIterationSpace *ISP = P->getIterationSpace();
+  HipaccIterationSpace *ISC = C->getIterationSpace();
+  HipaccImage *Img = ISP->getImage();
+
+  if (P == C || ISP->isCrop() || ISC->isCrop()) return false;
+  if (Img == ISC->getImage() || Img->getSizeY() != ISC->getImage()->getSizeY())
+    return false;
+
+  // each kernel has to write only to the pixel of the current iteration
+  if ((P->getKernelClass()->getKernelStatistics().getOutAccessDetail() |
+       C->getKernelClass()->getKernelStatistics().getOutAccessDetail()) &
+      USER_XY) return false;
+
+  // the consumer must not overwrite an image read by the producer
+  SmallVector<FieldDecl *, 16> imgFields = P->getKernelClass()->getImgFields();
+  for (size_t i=0; i<imgFields.size(); ++i) {
+    HipaccAccessor *Acc = P->getImgFromMapping(imgFields[i]);
+    if (Acc && Acc->getImage() == ISC->getImage()) return false;
+  }
+
+  HipaccAccessor *consumerAcc = nullptr;
+  unsigned int num_accs = 0;
+  halo = 0;
+  imgFields = C->getKernelClass()->getImgFields();
+  for (size_t i=0; i<imgFields.size(); ++i) {
+    HipaccAccessor *Acc = C->getImgFromMapping(imgFields[i]);
+    if (!Acc || Acc->getImage() != Img) continue;
+
+    if (Acc->isCrop() || Acc->getInterpolation() != InterpolateNO) return false;
+
+    MemoryAccessDetail detail =
+      C->getKernelClass()->getImgAccessDetail(imgFields[i]);
+    if (detail & USER_XY) return false;
+    if (detail & (STRIDE_Y|STRIDE_XY)) {
+      // the window size of the accessor bounds the vertical offset
+      if (Acc->getSizeY() < 2) return false;
+      halo = std::max(halo, Acc->getSizeY()/2);
+    }
+    consumerAcc = Acc;
+    num_accs++;
+  }
+
+  stream = num_accs==1 && checkLineStreaming(P, C, consumerAcc);
+
+  return num_accs > 0;
+}
+
+
+// check if the output image of the producer P can be kept in a line buffer
+// when fused with the consumer C: the image and its accessor must not be
+// referenced anywhere else and each kernel has to be executed only once
+bool Rewrite::checkLineStreaming(HipaccKernel *P, HipaccKernel *C,
+    HipaccAccessor *Acc) {
+  if (!compilerOptions.streamLines() || !mainFD) return false;
+
+  HipaccIterationSpace *IS = P->getIterationSpace();
+  HipaccImage *Img = IS->getImage();
+  HipaccBoundaryCondition *BC = Acc->getBC();
+
+  // rows from the other end of the image are not part of the line buffer
+  if (PyrDeclMap.count(Img->getDecl()) || BC->isPyramid() ||
+      Acc->getBoundaryHandling() == BOUNDARY_REPEAT) return false;
+
+  if (!mainRefs) {
+    mainRefs = new DeclRefCounter();
+    mainRefs->TraverseStmt(mainFD->getBody());
+  }
+
+  // the image is referenced by the iteration space of P and by the accessor
+  // of C or its boundary condition
+  if (mainRefs->getRefs(Img->getDecl()) != 2 ||
+      mainRefs->getRefs(IS->getDecl()) != 1 ||
+      mainRefs->getRefs(Acc->getDecl()) != 1) return false;
+  if (BC->getDecl() != Acc->getDecl() &&
+      mainRefs->getRefs(BC->getDecl()) != 1) return false;
+
+  return mainRefs->getExecutions(P->getDecl()) == 1 &&
+         mainRefs->getExecutions(C->getDecl()) == 1;
+}
+
+
+// check if the reduction of kernel K can be applied to each band of rows right
+// after the kernel computed it, so that the output is reduced while it is
+// still cached. The output image is only kept in a line buffer if it is not
+// referenced anywhere else and the kernel is executed only once
+bool Rewrite::checkReductionFusion(HipaccKernel *K, bool &stream) {
+  stream = false;
+  if (!compilerOptions.fuseKernels()) return false;
+
+  // the kernel has to write only to the pixel of the current iteration
+  if (K->getKernelClass()->getKernelStatistics().getOutAccessDetail() &
+      USER_XY) return false;
+
+  if (!compilerOptions.streamLines() || !mainFD) return true;
+
+  HipaccIterationSpace *IS = K->getIterationSpace();
+  HipaccImage *Img = IS->getImage();
+  if (PyrDeclMap.count(Img->getDecl())) return true;
+
+  if (!mainRefs) {
+    mainRefs = new DeclRefCounter();
+    mainRefs->TraverseStmt(mainFD->getBody());
+  }
+
+  stream = mainRefs->getRefs(Img->getDecl()) == 1 &&
+           mainRefs->getRefs(IS->getDecl()) == 1 &&
+           mainRefs->getExecutions(K->getDecl()) == 1;
+
+  return true;
+}
+
+
+// get the image a pyramid was created from
+HipaccImage *Rewrite::getPyramidImage(HipaccImage *Pyr) {
+  CXXConstructExpr *CCE = dyn_cast<CXXConstructExpr>(
+      Pyr->getDecl()->getInit());
+  if (!CCE || !CCE->getNumArgs()) return nullptr;
+
+  DeclRefExpr *DRE = dyn_cast<DeclRefExpr>(CCE->getArg(0)->IgnoreParenCasts());
+  if (!DRE || !ImgDeclMap.count(DRE->getDecl())) return nullptr;
+
+  return ImgDeclMap[DRE->getDecl()];
+}
+
+
+// get the size of an image if it is known at compile time. For pyramid levels,
+// the size of the image the pyramid was created from and the level relative
+// to the current level of the traversal are returned
+bool Rewrite::getImageExtent(HipaccImage *Img, std::string idx, int &width,
+    int &height, int &level) {
+  level = 0;
+  if (PyrDeclMap.count(Img->getDecl())) {
+    Img = getPyramidImage(Img);
+    if (!Img) return false;
+    level = atoi(idx.c_str());
+  }
+
+  CXXConstructExpr *CCE = dyn_cast<CXXConstructExpr>(
+      Img->getDecl()->getInit());
+  if (!CCE || CCE->getNumArgs() != 2 ||
+      !CCE->getArg(0)->isEvaluatable(Context) ||
+      !CCE->getArg(1)->isEvaluatable(Context)) return false;
+
+  width = CCE->getArg(0)->EvaluateKnownConstInt(Context).getSExtValue();
+  height = CCE->getArg(1)->EvaluateKnownConstInt(Context).getSExtValue();
+
+  return true;
+}
+
+
+// compare the sizes of two images or pyramid levels: returns 0 if they are of
+// the same size, -1 if A is smaller, 1 if A is larger, and 2 if unknown
+int Rewrite::compareImageExtent(HipaccImage *A, std::string idxA, HipaccImage
+    *B, std::string idxB) {
+  if (A == B && idxA == idxB) return 0;
+
+  int width_a, height_a, level_a, width_b, height_b, level_b;
+  if (!getImageExtent(A, idxA, width_a, height_a, level_a) ||
+      !getImageExtent(B, idxB, width_b, height_b, level_b)) return 2;
+
+  // levels of pyramids created from images of the same size
+  if (PyrDeclMap.count(A->getDecl()) || PyrDeclMap.count(B->getDecl())) {
+    if (!PyrDeclMap.count(A->getDecl()) || !PyrDeclMap.count(B->getDecl()) ||
+        width_a != width_b || height_a != height_b) return 2;
+    if (level_a == level_b) return 0;
+    return level_a > level_b ? -1 : 1;
+  }
+
+  if (width_a == width_b && height_a == height_b) return 0;
+  if (width_a <= width_b && height_a <= height_b) return -1;
+  if (width_a >= width_b && height_a >= height_b) return 1;
+  return 2;
+}
+
+
+// check if the kernel uses the coordinates of its output pixel: getX()/getY()
+static bool usesOutputIndex(Stmt *S) {
+  if (CXXMemberCallExpr *MCE = dyn_cast<CXXMemberCallExpr>(S)) {
+    MemberExpr *ME = dyn_cast<MemberExpr>(MCE->getCallee());
+    if (ME && isa<CXXThisExpr>(ME->getBase()->IgnoreParenImpCasts()) &&
+        (ME->getMemberNameInfo().getAsString() == "getX" ||
+         ME->getMemberNameInfo().getAsString() == "getY"))
+      return true;
+  }
+
+  for (auto I=S->child_begin(), E=S->child_end(); I!=E; ++I) {
+    if (*I && usesOutputIndex(*I)) return true;
+  }
+
+  return false;
+}
+
+
+// check if the kernel only copies the pixel of its Accessor: output() = acc();
+static bool isCopyKernel(HipaccKernelClass *KC) {
+  CompoundStmt *CS = dyn_cast<CompoundStmt>(
+      KC->getKernelFunction()->getBody());
+  if (!CS || CS->size() != 1 || !isa<Expr>(CS->body_back())) return false;
+
+  Expr *E = dyn_cast<Expr>(CS->body_back())->IgnoreImplicit();
+  Expr *LHS = nullptr, *RHS = nullptr;
+  if (BinaryOperator *BO = dyn_cast<BinaryOperator>(E)) {
+    if (BO->getOpcode() != BO_Assign) return false;
+    LHS = BO->getLHS();
+    RHS = BO->getRHS();
+  } else if (CXXOperatorCallExpr *OCE = dyn_cast<CXXOperatorCallExpr>(E)) {
+    if (OCE->getOperator() != OO_Equal || OCE->getNumArgs() != 2) return false;
+    LHS = OCE->getArg(0);
+    RHS = OCE->getArg(1);
+  } else {
+    return false;
+  }
+
+  CXXMemberCallExpr *Out =
+    dyn_cast<CXXMemberCallExpr>(LHS->IgnoreParenImpCasts());
+  if (!Out || !Out->getMethodDecl() ||
+      Out->getMethodDecl()->getNameAsString() != "output") return false;
+
+  CXXOperatorCallExpr *In =
+    dyn_cast<CXXOperatorCallExpr>(RHS->IgnoreParenImpCasts());
+  return In && In->getOperator() == OO_Call && In->getNumArgs() == 1 &&
+         isa<MemberExpr>(In->getArg(0)->IgnoreParenImpCasts());
+}
+
+
+// check if the kernel P can be evaluated at the pixels retained by a consumer
+// subsampling its output: P has to read all images without interpolation at
+// the pixel of the current iteration, only offset by the window of a local
+// operator
+bool Rewrite::checkSamplingProducer(HipaccKernel *P) {
+  if (!compilerOptions.fuseSampling()) return false;
+
+  HipaccKernelClass *KC = P->getKernelClass();
+  if (KC->getReduceFunction() || P->getIterationSpace()->isCrop()) return false;
+  if (KC->getKernelType() != PointOperator &&
+      KC->getKernelType() != LocalOperator) return false;
+  if (KC->getKernelStatistics().getOutAccessDetail() & USER_XY) return false;
+
+  // the coordinates of the output pixel change when evaluated at the
+  // retained pixels
+  if (usesOutputIndex(KC->getKernelFunction()->getBody())) return false;
+
+  SmallVector<FieldDecl *, 16> imgFields = KC->getImgFields();
+  for (size_t i=0; i<imgFields.size(); ++i) {
+    HipaccAccessor *Acc = P->getImgFromMapping(imgFields[i]);
+    if (!Acc || Acc->isCrop() || Acc->isDecimated() ||
+        Acc->getInterpolation() != InterpolateNO) return false;
+    if (KC->getImgAccessDetail(imgFields[i]) & USER_XY) return false;
+  }
+
+  return true;
+}
+
+
+// check if the consumer C executed by E only subsamples the output of the
+// producer P executed by PE: C copies the nearest neighbor of the output of P
+// to a smaller image. The output of P must not be read anywhere else, and
+// both executions are part of the same block, separated only by declarations
+// and statements not accessing the images involved
+bool Rewrite::checkSamplingFusion(HipaccKernel *P, CXXMemberCallExpr *PE,
+    HipaccKernel *C, CXXMemberCallExpr *E) {
+  HipaccKernelClass *KC = C->getKernelClass();
+  HipaccIterationSpace *ISP = P->getIterationSpace();
+  HipaccIterationSpace *ISC = C->getIterationSpace();
+  HipaccImage *Img = ISP->getImage();
+
+  if (P == C || !mainFD || KC->getReduceFunction() || ISC->isCrop() ||
+      KC->getNumImages() != 1 || !isCopyKernel(KC)) return false;
+
+  HipaccAccessor *Acc = C->getImgFromMapping(KC->getImgFields()[0]);
+  if (!Acc || Acc->isCrop() || Acc->getInterpolation() != InterpolateNN)
+    return false;
+
+  // the consumer reads the output of the producer and writes pixels of the
+  // same type to an image that is not larger
+  if (Acc->getImage() != Img ||
+      Acc->getBC()->getPyramidIndex() != ISP->getPyramidIndex() ||
+      !Context.hasSameType(Img->getType(), ISC->getImage()->getType()))
+    return false;
+  int cmp = compareImageExtent(ISC->getImage(), ISC->getPyramidIndex(), Img,
+      ISP->getPyramidIndex());
+  if (cmp != 0 && cmp != -1) return false;
+
+  // the producer reads images of the size of its output, but not the output
+  // of the consumer
+  SmallVector<ValueDecl *, 16> imgDecls;
+  imgDecls.push_back(Img->getDecl());
+  SmallVector<FieldDecl *, 16> imgFields =
+    P->getKernelClass()->getImgFields();
+  for (size_t i=0; i<imgFields.size(); ++i) {
+    HipaccAccessor *AccP = P->getImgFromMapping(imgFields[i]);
+    if (compareImageExtent(AccP->getImage(),
+          AccP->getBC()->getPyramidIndex(), Img, ISP->getPyramidIndex()) != 0)
+      return false;
+    if (AccP->getImage() == ISC->getImage() &&
+        AccP->getBC()->getPyramidIndex() == ISC->getPyramidIndex())
+      return false;
+    imgDecls.push_back(AccP->getImage()->getDecl());
+  }
+  for (size_t i=0, e=imgDecls.size(); i<e; ++i) {
+    if (PyrDeclMap.count(imgDecls[i])) {
+      HipaccImage *Base = getPyramidImage(PyrDeclMap[imgDecls[i]]);
+      if (!Base) return false;
+      imgDecls.push_back(Base->getDecl());
+    }
+  }
+
+  if (!mainRefs) {
+    mainRefs = new DeclRefCounter();
+    mainRefs->TraverseStmt(mainFD->getBody());
+  }
+
+  // the output of the producer is only read by the consumer: the image is
+  // referenced by the iteration space of P and by the accessor of C or its
+  // boundary condition; the image of a pyramid only by the pyramid
+  if (mainRefs->getReads(Img->getDecl()) != 2 ||
+      mainRefs->getWrites(Img->getDecl()) ||
+      mainRefs->getRefs(ISP->getDecl()) != 1 ||
+      mainRefs->getRefs(Acc->getDecl()) != 1) return false;
+  if (Acc->getBC()->getDecl() != Acc->getDecl() &&
+      mainRefs->getRefs(Acc->getBC()->getDecl()) != 1) return false;
+  if (PyrDeclMap.count(Img->getDecl()) &&
+      mainRefs->getReads(getPyramidImage(Img)->getDecl()) != 1) return false;
+  if (mainRefs->getExecutions(P->getDecl()) != 1 ||
+      mainRefs->getExecutions(C->getDecl()) != 1) return false;
+
+  // both executions are statements of the same block
+  if (!mainParents) mainParents = new ParentMap(mainFD->getBody());
+  Stmt *SP = PE, *SC = E;
+  while (mainParents->getParent(SP) &&
+         !isa<CompoundStmt>(mainParents->getParent(SP)))
+    SP = mainParents->getParent(SP);
+  while (mainParents->getParent(SC) &&
+         !isa<CompoundStmt>(mainParents->getParent(SC)))
+    SC = mainParents->getParent(SC);
+  if (!isa<Expr>(SP) || dyn_cast<Expr>(SP)->IgnoreImplicit() != PE ||
+      !isa<Expr>(SC) || dyn_cast<Expr>(SC)->IgnoreImplicit() != E) return false;
+  CompoundStmt *CS = dyn_cast_or_null<CompoundStmt>(
+      mainParents->getParent(SP));
+  if (!CS || CS != mainParents->getParent(SC)) return false;
+
+  // statements in between must not execute kernels or access the images; the
+  // declarations of Accessors, IterationSpaces, and kernels do not access them
+  bool between = false;
+  for (auto I=CS->body_begin(), N=CS->body_end(); I!=N; ++I) {
+    if (*I == SC) break;
+    if (*I == SP) {
+      between = true;
+      continue;
+    }
+    if (!between) continue;
+
+    if (DeclStmt *DS = dyn_cast<DeclStmt>(*I)) {
+      bool hipaccDecls = true;
+      for (auto DI=DS->decl_begin(), DE=DS->decl_end(); DI!=DE; ++DI) {
+        ValueDecl *VD = dyn_cast<ValueDecl>(*DI);
+        if (!VD || !(AccDeclMap.count(VD) || BCDeclMap.count(VD) ||
+              ISDeclMap.count(VD) || KernelDeclMap.count(VD) ||
+              MaskDeclMap.count(VD))) hipaccDecls = false;
+      }
+      if (hipaccDecls) continue;
+    }
+
+    DeclRefCounter refs;
+    refs.TraverseStmt(*I);
+    if (refs.executesKernels()) return false;
+    for (size_t i=0; i<imgDecls.size(); ++i) {
+      if (refs.getReads(imgDecls[i]) || refs.getWrites(imgDecls[i]))
+        return false;
+    }
+  }
+
+  return between;
+}
+
+
+// create the kernel evaluating the producer P at the pixels retained by the
+// subsampling consumer C: the kernel iterates over the iteration space of C and
+// reads the images of P at the scaled position of each pixel. The kernel
+// replaces P, the execution of C launches it instead
+HipaccKernel *Rewrite::createSamplingKernel(HipaccKernel *P, HipaccKernel *C) {
+  HipaccKernelClass *KC = P->getKernelClass();
+  HipaccKernel *K = new HipaccKernel(Context, P->getDecl(), KC,
+      compilerOptions, P->getName() + C->getName());
+
+  K->setIterationSpace(C->getIterationSpace());
+
+  SmallVector<FieldDecl *, 16> imgFields = KC->getImgFields();
+  for (size_t i=0; i<imgFields.size(); ++i) {
+    HipaccAccessor *Acc =
+      new HipaccAccessor(*P->getImgFromMapping(imgFields[i]));
+    Acc->resetDecls();
+    Acc->setDecimated();
+    K->insertMapping(imgFields[i], Acc);
+  }
+  SmallVector<FieldDecl *, 16> maskFields = KC->getMaskFields();
+  for (size_t i=0; i<maskFields.size(); ++i) {
+    HipaccMask *Mask = P->getMaskFromMapping(maskFields[i]);
+    if (Mask) K->insertMapping(maskFields[i], Mask);
+  }
+
+  translateKernel(KC, K);
+
+  KernelDeclMap[P->getDecl()] = K;
+  KernelDeclMap.erase(C->getDecl());
+
+  return K;
+}
+
+
+// Select the configuration of a kernel from the tuning database. Each line
+// of the database holds the result of one exploration:
+//   kernel device ppt local texture size_class block_x block_y time
+// where size_class is log2 of the number of pixels of the iteration space.
+// Only records compiled with the memory configuration the kernel will use are
+// considered: pixels per thread, local memory, and texture memory given by the
+// user, and Array2D textures, which are selected for all kernels.
+// The fastest configuration for the size class of the kernel is used; if the
+// size is not known at compile time or not in the database, the closest size
+// class is used instead, preferring large images
+bool Rewrite::setTunedConfiguration(HipaccKernel *K) {
+  FILE *fp = fopen(compilerOptions.getTuningDB().c_str(), "r");
+  if (!fp) return false;
+
+  HipaccIterationSpace *IS = K->getIterationSpace();
+  int size_class = -1;
+  if (IS->getSizeX() && IS->getSizeY()) {
+    size_class = (int)floor(log2((double)IS->getSizeX() * IS->getSizeY()));
+  }
+
+  bool kernel_local;
+  TextureType kernel_tex;
+  K->getMemoryConfig(kernel_local, kernel_tex);
+  CompilerOption user = (CompilerOption)(USER_ON|USER_OFF);
+
+  char line[FILENAME_MAX], name[FILENAME_MAX];
+  bool found = false;
+  int best_dist = 0, best_class = 0;
+  float best_time = 0.0f;
+  unsigned int bsx = 0, bsy = 0, ppt = 0;
+  int local = 0, tex = 0;
+  while (fgets(line, sizeof(char) * FILENAME_MAX, fp)) {
+    int device, cur_local, cur_tex, cur_class;
+    unsigned int cur_bsx, cur_bsy, cur_ppt;
+    float time;
+    if (line[0] == '#') continue;
+    if (sscanf(line, "%s %d %u %d %d %d %u %u %f", name, &device, &cur_ppt,
+          &cur_local, &cur_tex, &cur_class, &cur_bsx, &cur_bsy, &time) != 9)
+      continue;
+    if (K->getKernelName() != name ||
+        device != (int)compilerOptions.getTargetDevice()) continue;
+    if (!cur_bsx || !cur_bsy || !cur_ppt ||
+        cur_bsx * cur_bsy > K->getMaxThreadsPerBlock()) continue;
+
+    // memory configuration has to match
+    if (compilerOptions.multiplePixelsPerThread(user) &&
+        cur_ppt != K->getPixelsPerThread()) continue;
+    if (compilerOptions.useLocalMemory(user) && (bool)cur_local != kernel_local)
+      continue;
+    if (compilerOptions.useTextureMemory(user) && cur_tex != (int)kernel_tex)
+      continue;
+    if ((cur_tex == Array2D) != (kernel_tex == Array2D)) continue;
+
+    int dist = size_class < 0 ? 0 : abs(cur_class - size_class);
+    if (!found || dist < best_dist ||
+        (dist == best_dist && cur_class > best_class) ||
+        (dist == best_dist && cur_class == best_class && time < best_time)) {
+      found = true;
+      best_dist = dist;
+      best_class = cur_class;
+      best_time = time;
+      bsx = cur_bsx;
+      bsy = cur_bsy;
+      ppt = cur_ppt;
+      local = cur_local;
+      tex = cur_tex;
+    }
+  }
+  fclose(fp);
+
+  if (!found) return false;
+
+  K->setTunedConfig(bsx, bsy, ppt, local, (TextureType)tex);
+  llvm::errs() << "Using tuned configuration " << K->getNumThreadsX() << "x"
+               << K->getNumThreadsY() << "(x" << K->getPixelsPerThread()
+               << ") for kernel '" << K->getKernelName() << "'\n";
+
+  return true;
+}
+
+
 void Rewrite::setKernelConfiguration(HipaccKernelClass *KC, HipaccKernel *K) {
+  // configuration of a previous exploration
+  if (compilerOptions.useTuningDB() && !compilerOptions.exploreConfig() &&
+      setTunedConfiguration(K)) return;
+
   #ifdef USE_JIT_ESTIMATE
   bool jit_compile = false;
   switch (compilerOptions.getTargetCode()) {
@@ -2153,12 +2912,12 @@ void Rewrite::printReductionFunction(HipaccKernelClass *KC, HipaccKernel *K,
     PrintingPolicy Policy, llvm::raw_ostream *OS) {
   FunctionDecl *fun = KC->getReduceFunction();
 
-  // preprocessor defines
-  if (!compilerOptions.exploreConfig()) {
+  // preprocessor defines - the C++ reduction is implemented in the runtime
+  if (!compilerOptions.exploreConfig() && !compilerOptions.emitC()) {
     *OS << "#define BS " << K->getNumThreadsReduce() << "\n"
         << "#define PPT " << K->getPixelsPerThreadReduce() << "\n";
   }
-  if (K->getIterationSpace()->isCrop()) {
+  if (K->getIterationSpace()->isCrop() && !compilerOptions.emitC()) {
     *OS << "#define USE_OFFSETS\n";
   }
   switch (compilerOptions.getTargetCode()) {
@@ -2697,6 +3456,26 @@ void Rewrite::printKernelFunction(FunctionDecl *D, HipaccKernelClass *KC,
       }
       break;
     case TARGET_C:
+      // instruction set used by the host compiler to vectorize the kernel
+      if (compilerOptions.vectorizeKernels()) {
+        switch (compilerOptions.getVectorISA()) {
+          case ISA_Native:
+            break;
+          case ISA_SSE42:
+            *OS << "__attribute__((target(\"sse4.2\"))) ";
+            break;
+          case ISA_AVX:
+            *OS << "__attribute__((target(\"avx\"))) ";
+            break;
+          case ISA_AVX2:
+            *OS << "__attribute__((target(\"avx2,fma\"))) ";
+            break;
+          case ISA_AVX512:
+            *OS << "__attribute__((target(\"avx512f,avx512bw\"))) ";
+            break;
+        }
+      }
+      break;
     case TARGET_Renderscript:
       break;
     case TARGET_Filterscript:
@@ -2839,10 +3618,26 @@ void Rewrite::printKernelFunction(FunctionDecl *D, HipaccKernelClass *KC,
         case TARGET_C:
           if (comma++) *OS << ", ";
           if (memAcc==READ_ONLY) *OS << "const ";
+          if (!Acc->getImage()->getSizeX()) {
+            // width not known at compile time, e.g. for pyramid levels: the
+            // image is accessed using its stride
+            *OS << Acc->getImage()->getTypeStr() << " * ";
+            if (compilerOptions.vectorizeKernels()) *OS << "__restrict__ ";
+            *OS << Name;
+            break;
+          }
+          if (compilerOptions.vectorizeKernels()) {
+            // images do not alias, required by the host compiler to
+            // vectorize the loop over gid_x
+            *OS << Acc->getImage()->getTypeStr()
+                << " (* __restrict__ " << Name << ")"
+                << "[" << Acc->getImage()->getSizeXStr() << "]";
+            break;
+          }
           *OS << Acc->getImage()->getTypeStr()
               << " " << Name
-              << "[" << Acc->getImage()->getSizeXStr() << "]"
-              << "[" << Acc->getImage()->getSizeYStr() << "]";
+              << "[" << Acc->getImage()->getSizeYStr() << "]"
+              << "[" << Acc->getImage()->getSizeXStr() << "]";
           // alternative for Pencil:
           // *OS << "[static const restrict 2048][4096]";
           break;
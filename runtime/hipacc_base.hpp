@@ -26,13 +26,20 @@
 #ifndef __HIPACC_BASE_HPP__
 #define __HIPACC_BASE_HPP__
 
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #ifdef __APPLE__
 #include <mach/clock.h>
 #include <mach/mach.h>
 #endif
 
+#include <algorithm>
 #include <cassert>
+#include <map>
+#include <string>
 #include <vector>
 #if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
 #include <functional>
@@ -41,20 +48,47 @@
 #include "hipacc_math_functions.hpp"
 
 #define HIPACC_NUM_ITERATIONS 10
+// timed runs of kernel benchmarks written to HIPACC_BENCHMARK, unless set by
+// HIPACC_BENCHMARK_RUNS; fewer than HIPACC_MIN_BENCHMARK_RUNS would report the
+// maximum as 95th percentile
+#define HIPACC_NUM_BENCHMARK_RUNS 100
+#define HIPACC_MIN_BENCHMARK_RUNS 20
+// histogram of execution times in the profile: bucket i counts executions
+// taking less than 2^i * HIPACC_PROFILE_RESOLUTION ms, the last one all others
+#define HIPACC_PROFILE_BUCKETS 16
+#define HIPACC_PROFILE_RESOLUTION 0.01f
 
 extern float total_time;
 extern float last_gpu_timing;
+extern std::vector<float> benchmark_timings;
 float hipaccGetLastKernelTiming();
+size_t hipaccGetBenchmarkRuns();
 unsigned int nextPow2(unsigned int x);
 
 #ifndef EXCLUDE_IMPL
 float total_time = 0.0f;
 float last_gpu_timing = 0.0f;
+// timings of all iterations of the last kernel benchmark in ms
+std::vector<float> benchmark_timings;
 // get GPU timing of last executed Kernel in ms
 float hipaccGetLastKernelTiming() {
     return last_gpu_timing;
 }
 
+// get number of timed runs of a kernel benchmark
+size_t hipaccGetBenchmarkRuns() {
+    if (!getenv("HIPACC_BENCHMARK")) return HIPACC_NUM_ITERATIONS;
+
+    const char *runs = getenv("HIPACC_BENCHMARK_RUNS");
+    long num_runs = runs ? atol(runs) : HIPACC_NUM_BENCHMARK_RUNS;
+    if (num_runs < HIPACC_MIN_BENCHMARK_RUNS) {
+        fprintf(stderr, "<HIPACC:> Using %d benchmark runs instead of %ld\n",
+                HIPACC_MIN_BENCHMARK_RUNS, num_runs);
+        num_runs = HIPACC_MIN_BENCHMARK_RUNS;
+    }
+    return num_runs;
+}
+
 long getMicroTime() {
     struct timespec ts;
 
@@ -132,11 +166,65 @@ class HipaccAccessor {
 };
 
 
+typedef struct hipacc_pool_stats {
+    hipacc_pool_stats() :
+        allocations(0), reuses(0), releases(0), evictions(0),
+        pooled_bytes(0), peak_pooled_bytes(0) {}
+    // requests served by the allocator and from the pool
+    size_t allocations, reuses;
+    // buffers returned to the pool and freed due to the pool limit
+    size_t releases, evictions;
+    // bytes held by free buffers in the pool
+    size_t pooled_bytes, peak_pooled_bytes;
+} hipacc_pool_stats;
+
+
+typedef struct hipacc_profile_stats {
+    hipacc_profile_stats() :
+        calls(0), total_time(0.0f), min_time(FLT_MAX), max_time(0.0f),
+        bytes(0) {
+        for (size_t i=0; i<HIPACC_PROFILE_BUCKETS; ++i) histogram[i] = 0;
+    }
+    // number of executions and their execution time in ms
+    size_t calls;
+    float total_time, min_time, max_time;
+    size_t histogram[HIPACC_PROFILE_BUCKETS];
+    // bytes moved by memory transfers
+    size_t bytes;
+} hipacc_profile_stats;
+
+
 class HipaccContextBase {
     protected:
         std::vector<HipaccImage> imgs;
+        // free buffers by bucket size and alignment, and size and alignment
+        // of all buffers allocated via the pool
+        std::multimap<std::pair<size_t, int>, void *> pool;
+        std::map<void *, std::pair<size_t, int> > pool_buffers;
+        size_t pool_limit;
+        hipacc_pool_stats pool_stats;
+        // profile of kernels and memory transfers by name; enabled by the
+        // environment variable HIPACC_PROFILE and printed at exit. The profile
+        // is shared by the contexts of all backends, so that it is available
+        // before a context is created
+        struct hipacc_profile_state {
+            hipacc_profile_state() :
+                profiling(getenv("HIPACC_PROFILE") != NULL) {}
+            ~hipacc_profile_state() {
+                if (profiling && !profile.empty()) print_profile(stderr, profile);
+            }
+            bool profiling;
+            std::map<std::string, hipacc_profile_stats> profile;
+        };
+        static hipacc_profile_state &get_profile_state() {
+            static hipacc_profile_state state;
+            return state;
+        }
 
-        HipaccContextBase() {};
+        HipaccContextBase() :
+            pool_limit(256 << 20) {
+            get_profile_state();
+        };
         HipaccContextBase(HipaccContextBase const &);
         void operator=(HipaccContextBase const &);
 
@@ -145,9 +233,140 @@ class HipaccContextBase {
         void del_image(HipaccImage &img) {
             imgs.erase(std::remove(imgs.begin(), imgs.end(), img), imgs.end());
         }
+
+        // round size up to a bucket: multiples of 256 bytes up to 4 KiB,
+        // eighths of the next lower power of two beyond
+        static size_t pool_bucket(size_t bytes) {
+            size_t step = 256;
+            if (bytes > 4096) {
+                size_t pow2 = 4096;
+                while (pow2 <= bytes/2) pow2 *= 2;
+                step = pow2/8;
+            }
+            return (bytes + step - 1) / step * step;
+        }
+        // get free buffer from pool; returns NULL if none is available and
+        // the caller has to allocate one and register it via pool_add()
+        void *pool_get(size_t bytes, int alignment) {
+            std::multimap<std::pair<size_t, int>, void *>::iterator it =
+                pool.find(std::make_pair(bytes, alignment));
+            if (it == pool.end()) return NULL;
+            void *mem = it->second;
+            pool.erase(it);
+            pool_stats.pooled_bytes -= bytes;
+            ++pool_stats.reuses;
+            return mem;
+        }
+        void pool_add(void *mem, size_t bytes, int alignment) {
+            pool_buffers[mem] = std::make_pair(bytes, alignment);
+            ++pool_stats.allocations;
+        }
+        // return buffer to the pool; returns false if the buffer was not
+        // allocated via the pool or exceeds the pool limit and has to be
+        // freed by the caller
+        bool pool_put(void *mem) {
+            std::map<void *, std::pair<size_t, int> >::iterator it = pool_buffers.find(mem);
+            if (it == pool_buffers.end()) return false;
+            size_t bytes = it->second.first;
+            if (pool_stats.pooled_bytes + bytes > pool_limit) {
+                pool_buffers.erase(it);
+                ++pool_stats.evictions;
+                return false;
+            }
+            pool.insert(std::make_pair(it->second, mem));
+            pool_stats.pooled_bytes += bytes;
+            pool_stats.peak_pooled_bytes = std::max(pool_stats.peak_pooled_bytes, pool_stats.pooled_bytes);
+            ++pool_stats.releases;
+            return true;
+        }
+        // remove all free buffers from the pool, the caller has to free them
+        std::vector<void *> pool_drain() {
+            std::vector<void *> buffers;
+            for (std::multimap<std::pair<size_t, int>, void *>::iterator
+                 it=pool.begin(); it!=pool.end(); ++it) {
+                buffers.push_back(it->second);
+                pool_buffers.erase(it->second);
+            }
+            pool.clear();
+            pool_stats.pooled_bytes = 0;
+            return buffers;
+        }
+        void set_pool_limit(size_t bytes) { pool_limit = bytes; }
+        size_t get_pool_limit() { return pool_limit; }
+        hipacc_pool_stats get_pool_stats() { return pool_stats; }
+
+        static void set_profiling(bool enable) {
+            get_profile_state().profiling = enable;
+        }
+        static bool is_profiling() { return get_profile_state().profiling; }
+        // record an execution taking time ms and moving bytes bytes
+        static void profile_add(const std::string &name, float time, size_t
+                bytes=0) {
+            hipacc_profile_stats &stats = get_profile_state().profile[name];
+            ++stats.calls;
+            stats.total_time += time;
+            stats.min_time = std::min(stats.min_time, time);
+            stats.max_time = std::max(stats.max_time, time);
+            stats.bytes += bytes;
+            size_t bucket = 0;
+            for (float limit=HIPACC_PROFILE_RESOLUTION;
+                 time >= limit && bucket < HIPACC_PROFILE_BUCKETS-1;
+                 limit *= 2) ++bucket;
+            ++stats.histogram[bucket];
+        }
+        static std::map<std::string, hipacc_profile_stats> get_profile() {
+            return get_profile_state().profile;
+        }
+        static void reset_profile() { get_profile_state().profile.clear(); }
+        static void print_profile(FILE *fp) {
+            print_profile(fp, get_profile_state().profile);
+        }
+        static void print_profile(FILE *fp, std::map<std::string,
+                hipacc_profile_stats> &profile) {
+            fprintf(fp, "<HIPACC:> Profile (times in ms, histogram buckets "
+                        "from %gms doubling):\n", HIPACC_PROFILE_RESOLUTION);
+            fprintf(fp, "%-32s %8s %12s %10s %10s %10s %12s  histogram\n",
+                    "name", "calls", "total", "min", "avg", "max", "MB");
+            for (std::map<std::string, hipacc_profile_stats>::iterator
+                 it=profile.begin(); it!=profile.end(); ++it) {
+                hipacc_profile_stats &stats = it->second;
+                fprintf(fp, "%-32s %8zu %12.3f %10.3f %10.3f %10.3f %12.2f ",
+                        it->first.c_str(), stats.calls, stats.total_time,
+                        stats.min_time, stats.total_time/stats.calls,
+                        stats.max_time, stats.bytes/(1024.0*1024.0));
+                for (size_t i=0; i<HIPACC_PROFILE_BUCKETS; ++i) {
+                    fprintf(fp, " %zu", stats.histogram[i]);
+                }
+                fprintf(fp, "\n");
+            }
+        }
 };
 
 
+// Enable or disable profiling of kernels and memory transfers
+void hipaccSetProfiling(bool enable);
+// Get profile of kernels and memory transfers by name
+std::map<std::string, hipacc_profile_stats> hipaccGetProfile();
+// Print profile of kernels and memory transfers
+void hipaccPrintProfile(FILE *fp=stderr);
+
+#ifndef EXCLUDE_IMPL
+void hipaccSetProfiling(bool enable) {
+    HipaccContextBase::set_profiling(enable);
+}
+
+
+std::map<std::string, hipacc_profile_stats> hipaccGetProfile() {
+    return HipaccContextBase::get_profile();
+}
+
+
+void hipaccPrintProfile(FILE *fp) {
+    HipaccContextBase::print_profile(fp);
+}
+#endif // EXCLUDE_IMPL
+
+
 typedef struct hipacc_launch_info {
     hipacc_launch_info(int size_x, int size_y, int is_width, int is_height, int
             offset_x, int offset_y, int pixels_per_thread, int simd_width) :
@@ -199,6 +418,112 @@ unsigned int nextPow2(unsigned int x) {
 #endif // EXCLUDE_IMPL
 
 
+// Store the best configuration found by exploration in the tuning database
+// read by the compiler; the key identifies kernel, device, and the
+// configuration the kernel was compiled with (pixels per thread, local memory,
+// and texture memory). A previous record for the same key and size class of
+// the iteration space is replaced
+void hipaccWriteTuningRecord(const char *tuning_db, const char *key,
+        hipacc_launch_info &info, int tile_x, int tile_y, float time);
+
+#ifndef EXCLUDE_IMPL
+void hipaccWriteTuningRecord(const char *tuning_db, const char *key,
+        hipacc_launch_info &info, int tile_x, int tile_y, float time) {
+    if (!tuning_db || !key) return;
+
+    // size class: log2 of the number of pixels of the iteration space
+    int size_class = 0;
+    for (long pixels=(long)info.is_width*info.is_height; pixels>1; pixels>>=1)
+        ++size_class;
+
+    char record[FILENAME_MAX];
+    snprintf(record, sizeof(record), "%s %d ", key, size_class);
+    size_t record_len = strlen(record);
+
+    // keep all records of other keys and size classes
+    std::vector<std::string> records;
+    FILE *fp = fopen(tuning_db, "r");
+    if (fp) {
+        char line[FILENAME_MAX];
+        while (fgets(line, sizeof(line), fp)) {
+            if (strncmp(line, record, record_len) == 0) continue;
+            records.push_back(line);
+        }
+        fclose(fp);
+    }
+
+    fp = fopen(tuning_db, "w");
+    if (!fp) {
+        fprintf(stderr, "<HIPACC:> Could not open tuning database '%s'\n",
+                tuning_db);
+        return;
+    }
+    for (size_t i=0; i<records.size(); ++i)
+        fputs(records[i].c_str(), fp);
+    fprintf(fp, "%s%d %d %f\n", record, tile_x, tile_y, time);
+    fclose(fp);
+}
+#endif // EXCLUDE_IMPL
+
+
+// Append the result of the last kernel benchmark to the file given by the
+// environment variable HIPACC_BENCHMARK: one record per kernel with median and
+// 95th percentile latency, throughput, and effective bandwidth, assuming each
+// image is read or written once per pixel. Files ending in '.csv' get CSV,
+// other files JSON (one object per line). HIPACC_BENCHMARK_CASE labels the
+// records, e.g. with the test case and its parameters
+void hipaccWriteBenchmarkRecord(const char *kernel, hipacc_launch_info &info,
+        int bytes_per_pixel);
+
+#ifndef EXCLUDE_IMPL
+void hipaccWriteBenchmarkRecord(const char *kernel, hipacc_launch_info &info,
+        int bytes_per_pixel) {
+    const char *file = getenv("HIPACC_BENCHMARK");
+    const char *label = getenv("HIPACC_BENCHMARK_CASE");
+    if (!file || benchmark_timings.empty()) return;
+    if (!label) label = "";
+
+    std::vector<float> times(benchmark_timings);
+    std::sort(times.begin(), times.end());
+    size_t runs = times.size();
+    float median = times[runs/2];
+    // nearest-rank 95th percentile
+    float p95 = times[(95*runs + 99)/100 - 1];
+    double pixels = (double)info.is_width * info.is_height;
+    double mpixels = pixels / (median * 1.0e3);
+    double gbytes = pixels * bytes_per_pixel / (median * 1.0e6);
+
+    FILE *fp = fopen(file, "a");
+    if (!fp) {
+        fprintf(stderr, "<HIPACC:> Could not open benchmark file '%s'\n",
+                file);
+        return;
+    }
+
+    size_t len = strlen(file);
+    if (len > 4 && !strcmp(file + len - 4, ".csv")) {
+        // header for new files
+        fseek(fp, 0, SEEK_END);
+        if (ftell(fp) == 0) {
+            fprintf(fp, "case,kernel,width,height,bytes_per_pixel,runs,"
+                        "median_ms,p95_ms,mpixel_s,gbyte_s\n");
+        }
+        fprintf(fp, "%s,%s,%d,%d,%d,%zu,%.4f,%.4f,%.2f,%.3f\n", label, kernel,
+                info.is_width, info.is_height, bytes_per_pixel, runs, median,
+                p95, mpixels, gbytes);
+    } else {
+        fprintf(fp, "{\"case\": \"%s\", \"kernel\": \"%s\", \"width\": %d, "
+                    "\"height\": %d, \"bytes_per_pixel\": %d, \"runs\": %zu, "
+                    "\"median_ms\": %.4f, \"p95_ms\": %.4f, "
+                    "\"mpixel_s\": %.2f, \"gbyte_s\": %.3f}\n", label, kernel,
+                info.is_width, info.is_height, bytes_per_pixel, runs, median,
+                p95, mpixels, gbytes);
+    }
+    fclose(fp);
+}
+#endif // EXCLUDE_IMPL
+
+
 #if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
 
 class HipaccPyramid {
@@ -266,6 +591,9 @@ template<typename T>
 HipaccImage hipaccCreatePyramidImage(HipaccImage &base, int width, int height);
 void hipaccReleaseMemory(HipaccImage &Img);
 
+// runtimes defining HIPACC_PYRAMID_CHAIN allocate all levels of a pyramid at
+// once and provide their own hipaccCreatePyramid and hipaccReleasePyramid
+#ifndef HIPACC_PYRAMID_CHAIN
 template<typename data_t>
 HipaccPyramid hipaccCreatePyramid(HipaccImage &img, size_t depth) {
   HipaccPyramid p(depth);
@@ -290,6 +618,7 @@ void hipaccReleasePyramid(HipaccPyramid &pyr) {
     pyr.imgs_.pop_back();
   }
 }
+#endif // HIPACC_PYRAMID_CHAIN
 
 
 std::vector<const std::function<void()>*> hipaccTraverseFunc;
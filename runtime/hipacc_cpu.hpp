@@ -28,19 +28,409 @@
 
 #include <string.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <condition_variable>
+#include <functional>
+#include <iomanip>
 #include <iostream>
+#include <mutex>
+#include <thread>
 
+// levels of pyramids are allocated as one mip chain
+#define HIPACC_PYRAMID_CHAIN
 #include "hipacc_base.hpp"
 
+// Pool of worker threads executing row bands of a kernel's iteration space;
+// the calling thread participates in the execution
+class HipaccThreadPool {
+    private:
+        std::vector<std::thread> workers;
+        std::mutex mutex;
+        std::condition_variable cond_work, cond_done;
+        const std::function<void(int, int)> *job;
+        std::atomic<int> next_row;
+        int end_row, band_height;
+        unsigned int generation, pending;
+        bool stop;
+
+        void execute() {
+            for (;;) {
+                int start = next_row.fetch_add(band_height);
+                if (start >= end_row) break;
+                (*job)(start, std::min(start + band_height, end_row));
+            }
+        }
+
+        void worker() {
+            unsigned int seen = 0;
+            std::unique_lock<std::mutex> lock(mutex);
+            for (;;) {
+                cond_work.wait(lock, [&] { return stop || generation != seen; });
+                if (stop) return;
+                seen = generation;
+                lock.unlock();
+                execute();
+                lock.lock();
+                if (--pending == 0) cond_done.notify_one();
+            }
+        }
+
+    public:
+        HipaccThreadPool() :
+            job(nullptr), next_row(0), end_row(0), band_height(1),
+            generation(0), pending(0), stop(false) {}
+
+        ~HipaccThreadPool() { resize(1); }
+
+        // total number of threads, including the calling thread
+        void resize(unsigned int num_threads) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stop = true;
+            }
+            cond_work.notify_all();
+            for (size_t i=0; i<workers.size(); ++i) workers[i].join();
+            workers.clear();
+
+            stop = false;
+            generation = 0;
+            for (unsigned int i=1; i<num_threads; ++i) {
+                workers.push_back(std::thread(&HipaccThreadPool::worker, this));
+            }
+        }
+
+        unsigned int size() { return workers.size() + 1; }
+
+        // rows are fetched in bands of the given height; 0 selects several
+        // bands per thread for load balancing
+        void run(int start, int end, const std::function<void(int, int)> &func,
+                 int height=0) {
+            if (start >= end) return;
+            if (workers.empty()) {
+                func(start, end);
+                return;
+            }
+
+            int num_bands = size() * 4;
+            if (height <= 0) {
+                height = std::max(1, (end - start + num_bands - 1) / num_bands);
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                job = &func;
+                next_row = start;
+                end_row = end;
+                band_height = height;
+                pending = workers.size();
+                ++generation;
+            }
+            cond_work.notify_all();
+
+            execute();
+
+            std::unique_lock<std::mutex> lock(mutex);
+            cond_done.wait(lock, [&] { return pending == 0; });
+            job = nullptr;
+        }
+};
+
 class HipaccContext : public HipaccContextBase {
+    private:
+        HipaccThreadPool pool;
+
     public:
         static HipaccContext &getInstance() {
             static HipaccContext instance;
 
             return instance;
         }
+        HipaccThreadPool &get_thread_pool() { return pool; }
 };
 
+
+// Initialize thread pool; 0 selects the number of available cores
+void hipaccInitThreads(unsigned int num_threads) {
+    HipaccContext &Ctx = HipaccContext::getInstance();
+
+    if (num_threads == 0) num_threads = std::thread::hardware_concurrency();
+    if (num_threads == 0) num_threads = 1;
+
+    Ctx.get_thread_pool().resize(num_threads);
+}
+
+
+// Calculate the pixel coordinates of a) the first column/row that requires no
+// border handling (left, top) and b) the first column/row that requires border
+// handling (right, bottom)
+void hipaccPrepareKernelLaunch(hipacc_launch_info &info) {
+    info.bh_start_left = info.offset_x + info.size_x;
+    info.bh_start_right = info.offset_x + info.is_width - info.size_x;
+    info.bh_start_top = info.offset_y + info.size_y;
+    info.bh_start_bottom = info.offset_y + info.is_height - info.size_y;
+
+    if (info.bh_start_right > info.bh_start_left &&
+        info.bh_start_bottom > info.bh_start_top) {
+        info.bh_fall_back = 0;
+    } else {
+        info.bh_fall_back = 1;
+    }
+}
+
+
+// Execute kernel on rows [start, end) using the thread pool
+void hipaccLaunchKernel(int start, int end,
+                        const std::function<void(int, int)> &kernel) {
+    HipaccContext &Ctx = HipaccContext::getInstance();
+
+    Ctx.get_thread_pool().run(start, end, kernel);
+}
+
+
+// Execute a fused producer/consumer kernel pair on rows [start, end); the
+// consumer reads the output of the producer at most halo rows apart. The rows
+// are split into chunks of at least 2*halo rows: first, the producer computes
+// the halo rows at the top and bottom of each chunk. Afterwards, each chunk
+// interleaves producer and consumer on small bands, so that the consumer
+// reads the rows of the intermediate image while they are still cached
+void hipaccLaunchFusedKernels(int start, int end, int halo,
+                              const std::function<void(int, int)> &producer,
+                              const std::function<void(int, int)> &consumer) {
+    HipaccContext &Ctx = HipaccContext::getInstance();
+    HipaccThreadPool &pool = Ctx.get_thread_pool();
+    const int band_height = 16;
+    int rows = end - start;
+
+    if (rows <= 0) return;
+
+    int num_chunks = std::max(1, std::min<int>(pool.size() * 4,
+                                               rows / std::max(1, 2 * halo)));
+    auto chunk_start = [&] (int chunk) {
+        return start + (int)(((long long)chunk * rows) / num_chunks);
+    };
+
+    if (halo) {
+        pool.run(0, num_chunks, [&] (int first, int last) {
+            for (int chunk=first; chunk<last; ++chunk) {
+                int chunk_top = chunk_start(chunk);
+                int chunk_bottom = chunk_start(chunk + 1);
+                int top = std::min(chunk_top + halo, chunk_bottom);
+                int bottom = std::max(top, chunk_bottom - halo);
+
+                producer(chunk_top, top);
+                if (bottom < chunk_bottom) producer(bottom, chunk_bottom);
+            }
+        });
+    }
+
+    pool.run(0, num_chunks, [&] (int first, int last) {
+        for (int chunk=first; chunk<last; ++chunk) {
+            int chunk_top = chunk_start(chunk);
+            int chunk_bottom = chunk_start(chunk + 1);
+            // producer rows [next_p, end_p) are left after the first step
+            int next_p = std::min(chunk_top + halo, chunk_bottom);
+            int end_p = std::max(next_p, chunk_bottom - halo);
+            int next_c = chunk_top;
+
+            while (next_c < chunk_bottom) {
+                if (next_p < end_p) {
+                    int band_end = std::min(next_p + band_height, end_p);
+                    producer(next_p, band_end);
+                    next_p = band_end;
+                }
+                int end_c = next_p < end_p ? next_p - halo : chunk_bottom;
+                if (end_c > next_c) {
+                    consumer(next_c, end_c);
+                    next_c = end_c;
+                }
+            }
+        }
+    });
+}
+
+// Execute a fused producer/consumer kernel pair on rows [start, end) and keep
+// the intermediate image in a line buffer: each chunk of rows slides a window
+// of band_height+2*halo rows over the image. The producer writes the rows
+// entering the window, the rows leaving the window are never written to the
+// image in memory. The window is passed as image pointer to both kernels,
+// together with the image row stored in its first line. The halo rows at the
+// top of each chunk are computed twice
+void hipaccLaunchStreamedKernels(int start, int end, int halo, HipaccImage &tmp,
+                                 const std::function<void(int, int, void *, int)> &producer,
+                                 const std::function<void(int, int, void *, int)> &consumer) {
+    HipaccContext &Ctx = HipaccContext::getInstance();
+    HipaccThreadPool &pool = Ctx.get_thread_pool();
+    const int band_height = 16;
+    int rows = end - start;
+
+    if (rows <= 0) return;
+
+    size_t row_size = tmp.stride * tmp.pixel_size;
+    int window = band_height + 2 * halo;
+    int num_chunks = std::max(1, std::min<int>(pool.size() * 4,
+                                               rows / band_height));
+    auto chunk_start = [&] (int chunk) {
+        return start + (int)(((long long)chunk * rows) / num_chunks);
+    };
+
+    pool.run(0, num_chunks, [&] (int first, int last) {
+        // one additional row at each end catches out-of-bounds reads of
+        // kernels without border handling
+        std::vector<uchar> buffer((window + 2) * row_size);
+        uchar *lines = buffer.data() + row_size;
+
+        for (int chunk=first; chunk<last; ++chunk) {
+            int chunk_top = chunk_start(chunk);
+            int chunk_bottom = chunk_start(chunk + 1);
+            // image row stored in the first line of the window
+            int window_top = chunk_top - halo;
+            int next_p = std::max(window_top, start);
+
+            for (int y=chunk_top; y<chunk_bottom; y+=band_height) {
+                int band_end = std::min(y + band_height, chunk_bottom);
+                int end_p = std::min(band_end + halo, end);
+
+                // move rows still required to the top of the window
+                if (y - halo > window_top) {
+                    int shift = y - halo - window_top;
+                    int keep = next_p - (y - halo);
+                    if (keep > 0) {
+                        memmove(lines, lines + shift * row_size, keep * row_size);
+                    }
+                    window_top = y - halo;
+                    next_p = std::max(next_p, window_top);
+                }
+
+                if (end_p > next_p) {
+                    producer(next_p, end_p, lines, window_top);
+                    next_p = end_p;
+                }
+                consumer(y, band_end, lines, window_top);
+            }
+        }
+    });
+}
+
+
+// Perform global reduction and return result: each band of rows is reduced
+// into a private partial result, the partials are combined pairwise afterwards
+template<typename T>
+T hipaccApplyReduction(T (*reduce)(T, T), HipaccAccessor &acc) {
+    HipaccContext &Ctx = HipaccContext::getInstance();
+    HipaccThreadPool &pool = Ctx.get_thread_pool();
+    const T *input = (const T *)acc.img.mem;
+    int stride = acc.img.stride;
+
+    // there is no pixel to start the reduction with
+    if (acc.width <= 0 || acc.height <= 0) {
+        std::cerr << "ERROR: Global reduction over empty region ("
+                  << acc.width << "x" << acc.height << ")!" << std::endl;
+        return T();
+    }
+
+    // use several partials per thread for load balancing
+    int num_parts = std::max(1, std::min<int>(acc.height, pool.size() * 4));
+    std::vector<T> partials(num_parts);
+
+    pool.run(0, num_parts, [&] (int first, int last) {
+        for (int part=first; part<last; ++part) {
+            int start_y = acc.offset_y + (part * acc.height) / num_parts;
+            int end_y = acc.offset_y + ((part + 1) * acc.height) / num_parts;
+            const T *row = input + start_y * stride + acc.offset_x;
+            T val = row[0];
+
+            for (int x=1; x<acc.width; ++x) {
+                val = reduce(val, row[x]);
+            }
+            for (int y=start_y+1; y<end_y; ++y) {
+                row = input + y * stride + acc.offset_x;
+                for (int x=0; x<acc.width; ++x) {
+                    val = reduce(val, row[x]);
+                }
+            }
+            partials[part] = val;
+        }
+    });
+
+    // combine partials in order of the rows they cover
+    for (int step=1; step<num_parts; step*=2) {
+        for (int i=0; i+step<num_parts; i+=2*step) {
+            partials[i] = reduce(partials[i], partials[i+step]);
+        }
+    }
+
+    return partials[0];
+}
+template<typename T>
+T hipaccApplyReduction(T (*reduce)(T, T), HipaccImage &img) {
+    HipaccAccessor acc(img);
+    return hipaccApplyReduction<T>(reduce, acc);
+}
+
+// Execute kernel on the rows of the iteration space acc and reduce its output
+// band by band, while the rows are still cached; the partials of the chunks
+// are combined pairwise afterwards. In streaming mode, the output is only kept
+// in a line buffer, which is passed as image pointer to the kernel together
+// with the first row of the band stored in it
+template<typename T>
+T hipaccLaunchReducedKernel(T (*reduce)(T, T), HipaccAccessor &acc, bool stream,
+                            const std::function<void(int, int, void *, int)> &kernel) {
+    HipaccContext &Ctx = HipaccContext::getInstance();
+    HipaccThreadPool &pool = Ctx.get_thread_pool();
+    const int band_height = 16;
+    size_t row_size = acc.img.stride * acc.img.pixel_size;
+
+    // there is no pixel to start the reduction with
+    if (acc.width <= 0 || acc.height <= 0) {
+        std::cerr << "ERROR: Global reduction over empty region ("
+                  << acc.width << "x" << acc.height << ")!" << std::endl;
+        return T();
+    }
+
+    // use several partials per thread for load balancing
+    int num_parts = std::max(1, std::min<int>(acc.height, pool.size() * 4));
+    std::vector<T> partials(num_parts);
+
+    pool.run(0, num_parts, [&] (int first, int last) {
+        std::vector<uchar> buffer(stream ? band_height * row_size : 0);
+
+        for (int part=first; part<last; ++part) {
+            int start_y = acc.offset_y + (part * acc.height) / num_parts;
+            int end_y = acc.offset_y + ((part + 1) * acc.height) / num_parts;
+            T val = T();
+
+            for (int y=start_y; y<end_y; y+=band_height) {
+                int band_end = std::min(y + band_height, end_y);
+                uchar *mem = stream ? buffer.data() : (uchar *)acc.img.mem;
+                int mem_y = stream ? y : 0;
+                kernel(y, band_end, mem, mem_y);
+
+                for (int row_y=y; row_y<band_end; ++row_y) {
+                    const T *row = (const T *)(mem + (row_y - mem_y) *
+                                               row_size) + acc.offset_x;
+                    int x = 0;
+                    if (row_y == start_y) val = row[x++];
+                    for (; x<acc.width; ++x) {
+                        val = reduce(val, row[x]);
+                    }
+                }
+            }
+            partials[part] = val;
+        }
+    });
+
+    // combine partials in order of the rows they cover
+    for (int step=1; step<num_parts; step*=2) {
+        for (int i=0; i+step<num_parts; i+=2*step) {
+            partials[i] = reduce(partials[i], partials[i+step]);
+        }
+    }
+
+    return partials[0];
+}
+
+
 long start_time = 0L;
 long end_time = 0L;
 
@@ -48,15 +438,177 @@ void hipaccStartTiming() {
     start_time = getMicroTime();
 }
 
-void hipaccStopTiming() {
+void hipaccStopTiming(const char *kernel_name=NULL) {
+    HipaccContext &Ctx = HipaccContext::getInstance();
+
     end_time = getMicroTime();
     last_gpu_timing = (end_time - start_time) * 1.0e-3f;
+    if (Ctx.is_profiling() && kernel_name) {
+        Ctx.profile_add(kernel_name, last_gpu_timing);
+    }
 
     std::cerr << "<HIPACC:> Kernel timing: "
               << last_gpu_timing << "(ms)" << std::endl;
 }
 
 
+// Execute kernel repeatedly after a warm-up run and report the median timing
+void hipaccLaunchKernelBenchmark(const std::function<void()> &kernel,
+                                 bool print_timing=true) {
+    kernel();
+
+    size_t runs = hipaccGetBenchmarkRuns();
+    benchmark_timings.clear();
+    for (size_t i=0; i<runs; ++i) {
+        long start = getMicroTime();
+        kernel();
+        long end = getMicroTime();
+        benchmark_timings.push_back((end - start) * 1.0e-3f);
+    }
+
+    std::vector<float> times(benchmark_timings);
+    std::sort(times.begin(), times.end());
+    last_gpu_timing = times.at(runs/2);
+    if (print_timing) {
+        std::cerr << "<HIPACC:> Kernel timing benchmark ("
+                  << HipaccContext::getInstance().get_thread_pool().size()
+                  << " threads): " << last_gpu_timing << "(ms)" << std::endl;
+    }
+}
+
+
+// Explore thread count, tile width, and band height for a kernel: the
+// iteration space is split into bands of rows and tiles of columns; each thread
+// of the pool processes all tiles of a band before fetching the next band.
+// Tiles split only the columns without border handling, so that each tile
+// contains pixels of the interior
+void hipaccKernelExploration(const char *kernel, hipacc_launch_info &info,
+        const std::function<void(int, int, int, int)> &func) {
+    HipaccContext &Ctx = HipaccContext::getInstance();
+    HipaccThreadPool &pool = Ctx.get_thread_pool();
+    unsigned int pool_size = pool.size();
+    int opt_threads=1, opt_tw=info.is_width, opt_bh=1;
+    float opt_time = FLT_MAX;
+
+    hipaccPrepareKernelLaunch(info);
+    int start_x = info.offset_x, end_x = info.offset_x + info.is_width;
+    int start_y = info.offset_y, end_y = info.offset_y + info.is_height;
+    int interior_x = std::max(start_x, std::min(info.bh_start_left, end_x));
+    int interior_w = std::min(info.bh_start_right, end_x) - interior_x;
+    if (info.bh_fall_back) interior_w = 0;
+
+    // candidates: powers of two up to the number of cores, tile widths from
+    // the full width down to 32 columns, and band heights up to an equal split
+    std::vector<int> thread_counts, tile_widths;
+    int max_threads = std::max(pool_size, std::thread::hardware_concurrency());
+    for (int t=1; t<max_threads; t*=2) thread_counts.push_back(t);
+    thread_counts.push_back(max_threads);
+    tile_widths.push_back(info.is_width);
+    for (int tw=32; tw<interior_w; tw*=2) tile_widths.push_back(tw);
+
+    std::cerr << "<HIPACC:> Exploring configurations for kernel '" << kernel
+              << "': " << info.is_width << "x" << info.is_height
+              << " pixels, up to " << max_threads << " threads." << std::endl;
+
+    for (size_t i=0; i<thread_counts.size(); ++i) {
+        int threads = thread_counts[i];
+        pool.resize(threads);
+
+        for (size_t j=0; j<tile_widths.size(); ++j) {
+            int tw = tile_widths[j];
+
+            // column bounds of the tiles; border columns belong to the first
+            // and the last tile
+            std::vector<int> tiles(1, start_x);
+            for (int x=interior_x+tw; x<interior_x+interior_w; x+=tw) {
+                tiles.push_back(x);
+            }
+            tiles.push_back(end_x);
+            int num_tiles = tiles.size() - 1;
+
+            int max_bh = std::max(1, (info.is_height + threads - 1) / threads);
+            for (int bh=1; ; bh=std::min(2*bh, max_bh)) {
+                int num_bands = (info.is_height + bh - 1) / bh;
+                std::function<void(int, int)> job = [&] (int first, int last) {
+                    for (int k=first; k<last; ++k) {
+                        int y = start_y + (k / num_tiles) * bh;
+                        int t = k % num_tiles;
+                        func(y, std::min(y + bh, end_y), tiles[t], tiles[t+1]);
+                    }
+                };
+
+                std::vector<float> times;
+                times.reserve(HIPACC_NUM_ITERATIONS);
+                for (size_t k=0; k<HIPACC_NUM_ITERATIONS; ++k) {
+                    long start = getMicroTime();
+                    pool.run(0, num_bands * num_tiles, job, num_tiles);
+                    long end = getMicroTime();
+                    times.push_back((end - start) * 1.0e-3f);
+                }
+                std::sort(times.begin(), times.end());
+                float timing = times.at(HIPACC_NUM_ITERATIONS/2);
+                if (timing < opt_time) {
+                    opt_time = timing;
+                    opt_threads = threads;
+                    opt_tw = tw;
+                    opt_bh = bh;
+                }
+
+                // print timing
+                std::cerr << "<HIPACC:> Kernel config: "
+                          << std::setw(3) << std::right << threads << " threads, "
+                          << std::setw(5) << tw << "x"
+                          << std::setw(5) << std::left << bh << ": "
+                          << std::setw(8) << std::right << std::fixed
+                          << std::setprecision(4) << timing << " ms"
+                          << std::endl;
+
+                if (bh == max_bh) break;
+            }
+        }
+    }
+    pool.resize(pool_size);
+
+    std::cerr << "<HIPACC:> Best configuration for kernel '" << kernel << "': "
+              << opt_threads << " threads, " << opt_tw << "x" << opt_bh
+              << " tiles: " << opt_time << " ms" << std::endl;
+    last_gpu_timing = opt_time;
+}
+
+
+// Allocate memory aligned to the next power of two of alignment bytes, but at
+// least to the alignment of pointers; the memory is released by free()
+void *hipaccAlignedAlloc(size_t bytes, int alignment) {
+    size_t align = sizeof(void *);
+    while (align < (size_t)alignment) align *= 2;
+
+    void *mem = NULL;
+    if (posix_memalign(&mem, align, bytes) != 0) {
+        std::cerr << "ERROR: Can't allocate " << bytes << " bytes aligned to "
+                  << align << " bytes!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    return mem;
+}
+
+
+// Allocate buffer via the memory pool; the size is rounded up to the bucket
+// size, so that buffers of similar size can be reused
+void *hipaccAllocBuffer(size_t bytes, int alignment) {
+    HipaccContext &Ctx = HipaccContext::getInstance();
+
+    bytes = HipaccContextBase::pool_bucket(bytes);
+    void *mem = Ctx.pool_get(bytes, alignment);
+    if (!mem) {
+        mem = hipaccAlignedAlloc(bytes, alignment);
+        Ctx.pool_add(mem, bytes, alignment);
+    }
+
+    return mem;
+}
+
+
 // Allocate memory with alignment specified
 template<typename T>
 HipaccImage hipaccCreateMemory(T *host_mem, int width, int height, int alignment) {
@@ -67,7 +619,7 @@ HipaccImage hipaccCreateMemory(T *host_mem, int width, int height, int alignment
     alignment = (int)ceilf((float)alignment/sizeof(T)) * sizeof(T);
     // compute stride
     int stride = (int)ceilf((float)(width)/(alignment/sizeof(T))) * (alignment/sizeof(T));
-    mem = (T *)malloc(sizeof(T)*stride*height);
+    mem = (T *)hipaccAllocBuffer(sizeof(T)*stride*height, alignment);
 
     HipaccImage img = HipaccImage(width, height, stride, alignment, sizeof(T), (void *)mem);
     Ctx.add_image(img);
@@ -82,7 +634,7 @@ HipaccImage hipaccCreateMemory(T *host_mem, int width, int height) {
     T *mem;
     HipaccContext &Ctx = HipaccContext::getInstance();
 
-    mem = (T *)malloc(sizeof(T)*width*height);
+    mem = (T *)hipaccAllocBuffer(sizeof(T)*width*height, 0);
 
     HipaccImage img = HipaccImage(width, height, width, 0, sizeof(T), (void *)mem);
     Ctx.add_image(img);
@@ -94,14 +646,115 @@ HipaccImage hipaccCreateMemory(T *host_mem, int width, int height) {
 // Release memory
 void hipaccReleaseMemory(HipaccImage &img) {
     HipaccContext &Ctx = HipaccContext::getInstance();
-    free(img.mem);
+    if (!Ctx.pool_put(img.mem)) free(img.mem);
     Ctx.del_image(img);
 }
 
 
+// Allocate a single pyramid level like its base image
+template<typename T>
+HipaccImage hipaccCreatePyramidImage(HipaccImage &base, int width, int height) {
+    if (base.alignment > 0) {
+        return hipaccCreateMemory<T>(NULL, width, height, base.alignment);
+    } else {
+        return hipaccCreateMemory<T>(NULL, width, height);
+    }
+}
+
+
+// Create pyramid: all levels below the base image are stored in one mip chain.
+// The offsets of the levels are computed up front; each level uses the stride
+// alignment of the base image and starts at a cache line boundary. The levels
+// follow each other from fine to coarse, so that the small coarse levels are
+// packed into few cache lines. Kernels get the stride of each level, since
+// the C back end passes images without compile-time width as plain pointers
+template<typename data_t>
+HipaccPyramid hipaccCreatePyramid(HipaccImage &img, size_t depth) {
+    HipaccContext &Ctx = HipaccContext::getInstance();
+    HipaccPyramid p(depth);
+    p.add(img);
+    if (depth < 2) return p;
+
+    // pixels per stride alignment of the base image; levels start at
+    // multiples of the chain alignment, at least a cache line
+    int align_pixels = img.alignment > 0 ?
+        (int)ceilf((float)img.alignment/sizeof(data_t)) : 1;
+    size_t chain_align = std::max(img.alignment, 64);
+    std::vector<size_t> offsets(depth);
+    std::vector<int> widths(depth), heights(depth), strides(depth);
+    size_t bytes = 0;
+
+    for (size_t i=1; i<depth; ++i) {
+        widths[i] = (i == 1 ? img.width : widths[i-1]) / 2;
+        heights[i] = (i == 1 ? img.height : heights[i-1]) / 2;
+        assert(widths[i] * heights[i] > 0 &&
+               "Pyramid stages to deep for image size");
+        strides[i] = (widths[i] + align_pixels - 1) / align_pixels *
+                     align_pixels;
+        offsets[i] = (bytes + chain_align - 1) / chain_align * chain_align;
+        bytes = offsets[i] + sizeof(data_t) * strides[i] * heights[i];
+    }
+
+    uchar *chain = (uchar *)hipaccAllocBuffer(bytes, (int)chain_align);
+    for (size_t i=1; i<depth; ++i) {
+        HipaccImage level(widths[i], heights[i], strides[i], img.alignment,
+                          sizeof(data_t), (void *)(chain + offsets[i]));
+        Ctx.add_image(level);
+        p.add(level);
+    }
+
+    return p;
+}
+
+
+// Release pyramid: the first level below the base image owns the mip chain
+void hipaccReleasePyramid(HipaccPyramid &pyr) {
+    HipaccContext &Ctx = HipaccContext::getInstance();
+
+    // Do not remove the first one, it was created outside this context
+    while (pyr.imgs_.size() > 2) {
+        Ctx.del_image(pyr.imgs_.back());
+        pyr.imgs_.pop_back();
+    }
+    if (pyr.imgs_.size() > 1) {
+        hipaccReleaseMemory(pyr.imgs_.back());
+        pyr.imgs_.pop_back();
+    }
+}
+
+
+// Free all buffers held by the memory pool
+void hipaccReleaseMemoryPool() {
+    HipaccContext &Ctx = HipaccContext::getInstance();
+    std::vector<void *> buffers = Ctx.pool_drain();
+
+    for (size_t i=0; i<buffers.size(); ++i) free(buffers[i]);
+}
+
+
+// Set the maximal number of bytes held by free buffers in the memory pool
+void hipaccSetMemoryPoolLimit(size_t bytes) {
+    HipaccContext &Ctx = HipaccContext::getInstance();
+
+    Ctx.set_pool_limit(bytes);
+    if (Ctx.get_pool_stats().pooled_bytes > bytes) hipaccReleaseMemoryPool();
+}
+
+
+// Get allocation statistics of the memory pool
+hipacc_pool_stats hipaccGetMemoryPoolStats() {
+    HipaccContext &Ctx = HipaccContext::getInstance();
+
+    return Ctx.get_pool_stats();
+}
+
+
 // Write to memory
 template<typename T>
 void hipaccWriteMemory(HipaccImage &img, T *host_mem) {
+    HipaccContext &Ctx = HipaccContext::getInstance();
+    long start = Ctx.is_profiling() ? getMicroTime() : 0;
+
     int width = img.width;
     int height = img.height;
     int stride = img.stride;
@@ -113,12 +766,20 @@ void hipaccWriteMemory(HipaccImage &img, T *host_mem) {
     } else {
         memcpy(img.mem, host_mem, sizeof(T)*width*height);
     }
+
+    if (Ctx.is_profiling()) {
+        Ctx.profile_add("hipaccWriteMemory", (getMicroTime() - start)*1.0e-3f,
+                        sizeof(T)*width*height);
+    }
 }
 
 
 // Read from memory
 template<typename T>
 void hipaccReadMemory(T *host_mem, HipaccImage &img) {
+    HipaccContext &Ctx = HipaccContext::getInstance();
+    long start = Ctx.is_profiling() ? getMicroTime() : 0;
+
     int width = img.width;
     int height = img.height;
     int stride = img.stride;
@@ -130,6 +791,11 @@ void hipaccReadMemory(T *host_mem, HipaccImage &img) {
     } else {
         memcpy(host_mem, img.mem, sizeof(T)*width*height);
     }
+
+    if (Ctx.is_profiling()) {
+        Ctx.profile_add("hipaccReadMemory", (getMicroTime() - start)*1.0e-3f,
+                        sizeof(T)*width*height);
+    }
 }
 
 
@@ -39,19 +39,35 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <map>
 #include <sstream>
 #include <utility>
 #include <vector>
 
 #include "hipacc_base.hpp"
 
+typedef struct hipacc_image_events {
+    hipacc_image_events() : write(NULL) {}
+    cudaEvent_t write;
+    std::vector<cudaEvent_t> reads;
+} hipacc_image_events;
+
+
 class HipaccContext : public HipaccContextBase {
+    private:
+        // streams for asynchronous operations and their pending operations
+        // per image
+        std::vector<cudaStream_t> streams;
+        std::map<void *, hipacc_image_events> image_events;
+
     public:
         static HipaccContext &getInstance() {
             static HipaccContext instance;
 
             return instance;
         }
+        std::vector<cudaStream_t> &get_streams() { return streams; }
+        std::map<void *, hipacc_image_events> &get_image_events() { return image_events; }
 };
 
 
@@ -297,10 +313,143 @@ void hipaccInitCUDA() {
 }
 
 
+// Get an asynchronous stream; streams are created on demand
+cudaStream_t hipaccGetStream(int stream) {
+    cudaError_t err = cudaSuccess;
+    HipaccContext &Ctx = HipaccContext::getInstance();
+    std::vector<cudaStream_t> &streams = Ctx.get_streams();
+
+    while (streams.size() <= (size_t)stream) {
+        cudaStream_t new_stream;
+        err = cudaStreamCreate(&new_stream);
+        checkErr(err, "cudaStreamCreate()");
+        streams.push_back(new_stream);
+    }
+
+    return streams[stream];
+}
+
+
+// Record an event after all operations issued so far to a stream
+cudaEvent_t hipaccRecordEvent(cudaStream_t stream) {
+    cudaError_t err = cudaSuccess;
+    cudaEvent_t event;
+
+    err = cudaEventCreateWithFlags(&event, cudaEventDisableTiming);
+    checkErr(err, "cudaEventCreateWithFlags()");
+    err = cudaEventRecord(event, stream);
+    checkErr(err, "cudaEventRecord()");
+
+    return event;
+}
+
+
+// Let a stream wait for pending operations on an image: reading requires the
+// last write to be finished, writing additionally requires all reads issued
+// since then to be finished
+void hipaccWaitImageDependencies(cudaStream_t stream, HipaccImage &img, bool write) {
+    cudaError_t err = cudaSuccess;
+    HipaccContext &Ctx = HipaccContext::getInstance();
+    std::map<void *, hipacc_image_events> &events = Ctx.get_image_events();
+    std::map<void *, hipacc_image_events>::iterator it = events.find(img.mem);
+
+    if (it == events.end()) return;
+    if (it->second.write) {
+        err = cudaStreamWaitEvent(stream, it->second.write, 0);
+        checkErr(err, "cudaStreamWaitEvent()");
+    }
+    if (write) {
+        for (size_t i=0; i<it->second.reads.size(); ++i) {
+            err = cudaStreamWaitEvent(stream, it->second.reads[i], 0);
+            checkErr(err, "cudaStreamWaitEvent()");
+        }
+    }
+}
+
+
+// Record an asynchronous operation on an image issued to a stream
+void hipaccAddImageEvent(cudaStream_t stream, HipaccImage &img, bool write) {
+    cudaError_t err = cudaSuccess;
+    HipaccContext &Ctx = HipaccContext::getInstance();
+    hipacc_image_events &events = Ctx.get_image_events()[img.mem];
+    cudaEvent_t event = hipaccRecordEvent(stream);
+
+    if (write) {
+        if (events.write) err = cudaEventDestroy(events.write);
+        for (size_t i=0; i<events.reads.size(); ++i) {
+            err = cudaEventDestroy(events.reads[i]);
+        }
+        events.write = event;
+        events.reads.clear();
+    } else {
+        // drop finished reads, images might be read many times without writes
+        std::vector<cudaEvent_t> reads;
+        for (size_t i=0; i<events.reads.size(); ++i) {
+            if (cudaEventQuery(events.reads[i]) == cudaSuccess) err = cudaEventDestroy(events.reads[i]);
+            else reads.push_back(events.reads[i]);
+        }
+        reads.push_back(event);
+        events.reads.swap(reads);
+    }
+    checkErr(err, "cudaEventDestroy()");
+}
+
+
+// Wait for an event returned by an asynchronous operation and destroy it
+void hipaccWaitEvent(cudaEvent_t event) {
+    cudaError_t err = cudaSuccess;
+
+    err = cudaEventSynchronize(event);
+    checkErr(err, "cudaEventSynchronize()");
+    err = cudaEventDestroy(event);
+    checkErr(err, "cudaEventDestroy()");
+}
+
+
+// Wait for all asynchronous operations. Blocking operations use the legacy
+// default stream, which implicitly waits for all other streams
+void hipaccSynchronize() {
+    cudaError_t err = cudaSuccess;
+    HipaccContext &Ctx = HipaccContext::getInstance();
+    std::map<void *, hipacc_image_events> &events = Ctx.get_image_events();
+
+    if (events.empty()) return;
+
+    err = cudaDeviceSynchronize();
+    checkErr(err, "cudaDeviceSynchronize()");
+    for (std::map<void *, hipacc_image_events>::iterator it=events.begin();
+         it!=events.end(); ++it) {
+        if (it->second.write) err = cudaEventDestroy(it->second.write);
+        for (size_t i=0; i<it->second.reads.size(); ++i) {
+            err = cudaEventDestroy(it->second.reads[i]);
+        }
+    }
+    events.clear();
+    checkErr(err, "cudaEventDestroy()");
+}
+
+
+// Allocate buffer via the memory pool; the size is rounded up to the bucket
+// size, so that buffers of similar size can be reused
+void *hipaccAllocBuffer(size_t bytes, int alignment) {
+    cudaError_t err = cudaSuccess;
+    HipaccContext &Ctx = HipaccContext::getInstance();
+
+    bytes = HipaccContextBase::pool_bucket(bytes);
+    void *mem = Ctx.pool_get(bytes, alignment);
+    if (!mem) {
+        err = cudaMalloc(&mem, bytes);
+        checkErr(err, "cudaMalloc()");
+        Ctx.pool_add(mem, bytes, alignment);
+    }
+
+    return mem;
+}
+
+
 // Allocate memory with alignment specified
 template<typename T>
 HipaccImage hipaccCreateMemory(T *host_mem, int width, int height, int alignment) {
-    cudaError_t err = cudaSuccess;
     T *mem;
     HipaccContext &Ctx = HipaccContext::getInstance();
 
@@ -308,9 +457,8 @@ HipaccImage hipaccCreateMemory(T *host_mem, int width, int height, int alignment
     alignment = (int)ceilf((float)alignment/sizeof(T)) * sizeof(T);
     // compute stride
     int stride = (int)ceilf((float)(width)/(alignment/sizeof(T))) * (alignment/sizeof(T));
-    err = cudaMalloc((void **) &mem, sizeof(T)*stride*height);
+    mem = (T *)hipaccAllocBuffer(sizeof(T)*stride*height, alignment);
     //err = cudaMallocPitch((void **) &mem, &stride, stride*sizeof(float), height);
-    checkErr(err, "cudaMalloc()");
 
     HipaccImage img = HipaccImage(width, height, stride, alignment, sizeof(T), (void *)mem);
     Ctx.add_image(img);
@@ -322,12 +470,10 @@ HipaccImage hipaccCreateMemory(T *host_mem, int width, int height, int alignment
 // Allocate memory without any alignment considerations
 template<typename T>
 HipaccImage hipaccCreateMemory(T *host_mem, int width, int height) {
-    cudaError_t err = cudaSuccess;
     T *mem;
     HipaccContext &Ctx = HipaccContext::getInstance();
 
-    err = cudaMalloc((void **) &mem, sizeof(T)*width*height);
-    checkErr(err, "cudaMalloc()");
+    mem = (T *)hipaccAllocBuffer(sizeof(T)*width*height, 0);
 
     HipaccImage img = HipaccImage(width, height, width, 0, sizeof(T), (void *)mem);
     Ctx.add_image(img);
@@ -383,10 +529,11 @@ void hipaccReleaseMemory(HipaccImage &img) {
     cudaError_t err = cudaSuccess;
     HipaccContext &Ctx = HipaccContext::getInstance();
 
+    hipaccSynchronize();
     if (img.mem_type >= Array2D) {
         err = cudaFreeArray((cudaArray *)img.mem);
         checkErr(err, "cudaFreeArray()");
-    } else {
+    } else if (!Ctx.pool_put(img.mem)) {
         err = cudaFree(img.mem);
         checkErr(err, "cudaFree()");
     }
@@ -395,11 +542,42 @@ void hipaccReleaseMemory(HipaccImage &img) {
 }
 
 
+// Free all buffers held by the memory pool
+void hipaccReleaseMemoryPool() {
+    cudaError_t err = cudaSuccess;
+    HipaccContext &Ctx = HipaccContext::getInstance();
+    std::vector<void *> buffers = Ctx.pool_drain();
+
+    for (size_t i=0; i<buffers.size(); ++i) {
+        err = cudaFree(buffers[i]);
+        checkErr(err, "cudaFree()");
+    }
+}
+
+
+// Set the maximal number of bytes held by free buffers in the memory pool
+void hipaccSetMemoryPoolLimit(size_t bytes) {
+    HipaccContext &Ctx = HipaccContext::getInstance();
+
+    Ctx.set_pool_limit(bytes);
+    if (Ctx.get_pool_stats().pooled_bytes > bytes) hipaccReleaseMemoryPool();
+}
+
+
+// Get allocation statistics of the memory pool
+hipacc_pool_stats hipaccGetMemoryPoolStats() {
+    HipaccContext &Ctx = HipaccContext::getInstance();
+
+    return Ctx.get_pool_stats();
+}
+
+
 // Write to memory
 template<typename T>
 void hipaccWriteMemory(HipaccImage &img, T *host_mem) {
     cudaError_t err = cudaSuccess;
     HipaccContext &Ctx = HipaccContext::getInstance();
+    long start = Ctx.is_profiling() ? getMicroTime() : 0;
 
     int width = img.width;
     int height = img.height;
@@ -417,6 +595,11 @@ void hipaccWriteMemory(HipaccImage &img, T *host_mem) {
             checkErr(err, "cudaMemcpy()");
         }
     }
+
+    if (Ctx.is_profiling()) {
+        Ctx.profile_add("hipaccWriteMemory", (getMicroTime() - start)*1.0e-3f,
+                        sizeof(T)*width*height);
+    }
 }
 
 
@@ -425,6 +608,7 @@ template<typename T>
 void hipaccReadMemory(T *host_mem, HipaccImage &img) {
     cudaError_t err = cudaSuccess;
     HipaccContext &Ctx = HipaccContext::getInstance();
+    long start = Ctx.is_profiling() ? getMicroTime() : 0;
 
     int width = img.width;
     int height = img.height;
@@ -442,6 +626,76 @@ void hipaccReadMemory(T *host_mem, HipaccImage &img) {
             checkErr(err, "cudaMemcpy()");
         }
     }
+
+    if (Ctx.is_profiling()) {
+        Ctx.profile_add("hipaccReadMemory", (getMicroTime() - start)*1.0e-3f,
+                        sizeof(T)*width*height);
+    }
+}
+
+
+// Write to memory without blocking; host_mem must not be modified before the
+// returned event is finished. Transfers overlap with computations only for
+// page-locked host memory
+template<typename T>
+cudaEvent_t hipaccWriteMemoryAsync(HipaccImage &img, T *host_mem, int stream=0) {
+    cudaError_t err = cudaSuccess;
+    cudaStream_t cu_stream = hipaccGetStream(stream);
+
+    int width = img.width;
+    int height = img.height;
+    int stride = img.stride;
+
+    hipaccWaitImageDependencies(cu_stream, img, true);
+
+    if (img.mem_type >= Array2D) {
+        err = cudaMemcpyToArrayAsync((cudaArray *)img.mem, 0, 0, host_mem, sizeof(T)*width*height, cudaMemcpyHostToDevice, cu_stream);
+        checkErr(err, "cudaMemcpyToArrayAsync()");
+    } else {
+        if (stride > width) {
+            err = cudaMemcpy2DAsync(img.mem, stride*sizeof(T), host_mem, width*sizeof(T), width*sizeof(T), height, cudaMemcpyHostToDevice, cu_stream);
+            checkErr(err, "cudaMemcpy2DAsync()");
+        } else {
+            err = cudaMemcpyAsync(img.mem, host_mem, sizeof(T)*width*height, cudaMemcpyHostToDevice, cu_stream);
+            checkErr(err, "cudaMemcpyAsync()");
+        }
+    }
+
+    hipaccAddImageEvent(cu_stream, img, true);
+
+    return hipaccRecordEvent(cu_stream);
+}
+
+
+// Read from memory without blocking; host_mem is valid after the returned
+// event is finished
+template<typename T>
+cudaEvent_t hipaccReadMemoryAsync(T *host_mem, HipaccImage &img, int stream=0) {
+    cudaError_t err = cudaSuccess;
+    cudaStream_t cu_stream = hipaccGetStream(stream);
+
+    int width = img.width;
+    int height = img.height;
+    int stride = img.stride;
+
+    hipaccWaitImageDependencies(cu_stream, img, false);
+
+    if (img.mem_type >= Array2D) {
+        err = cudaMemcpyFromArrayAsync(host_mem, (cudaArray *)img.mem, 0, 0, sizeof(T)*width*height, cudaMemcpyDeviceToHost, cu_stream);
+        checkErr(err, "cudaMemcpyFromArrayAsync()");
+    } else {
+        if (stride > width) {
+            err = cudaMemcpy2DAsync(host_mem, width*sizeof(T), img.mem, stride*sizeof(T), width*sizeof(T), height, cudaMemcpyDeviceToHost, cu_stream);
+            checkErr(err, "cudaMemcpy2DAsync()");
+        } else {
+            err = cudaMemcpyAsync(host_mem, img.mem, sizeof(T)*width*height, cudaMemcpyDeviceToHost, cu_stream);
+            checkErr(err, "cudaMemcpyAsync()");
+        }
+    }
+
+    hipaccAddImageEvent(cu_stream, img, false);
+
+    return hipaccRecordEvent(cu_stream);
 }
 
 
@@ -644,17 +898,53 @@ void hipaccLaunchKernel(const void *kernel, const char *kernel_name, dim3 grid,
     cudaEventDestroy(end);
 
     last_gpu_timing = time;
+    if (Ctx.is_profiling()) Ctx.profile_add(kernel_name, time);
     if (print_timing) {
         std::cerr << "<HIPACC:> Kernel timing ("<< block.x*block.y << ": " << block.x << "x" << block.y << "): " << time << "(ms)" << std::endl;
     }
 }
 
 
+// Set the configuration for a kernel launched on an asynchronous stream
+void hipaccConfigureCallAsync(dim3 grid, dim3 block, int stream=0) {
+    cudaError_t err = cudaSuccess;
+
+    err = cudaConfigureCall(grid, block, 0, hipaccGetStream(stream));
+    checkErr(err, "cudaConfigureCall()");
+}
+
+
+// Launch kernel configured by hipaccConfigureCallAsync without blocking; the
+// kernel waits for pending operations on the images it reads and writes,
+// subsequent operations on these images wait for the kernel
+cudaEvent_t hipaccLaunchKernelAsync(const void *kernel, const char *kernel_name, std::vector<HipaccImage> inputs, std::vector<HipaccImage> outputs, int stream=0) {
+    cudaError_t err = cudaSuccess;
+    cudaStream_t cu_stream = hipaccGetStream(stream);
+    std::string error_string = "cudaLaunch(";
+    error_string += kernel_name;
+    error_string += ")";
+
+    for (size_t i=0; i<inputs.size(); ++i) hipaccWaitImageDependencies(cu_stream, inputs[i], false);
+    for (size_t i=0; i<outputs.size(); ++i) hipaccWaitImageDependencies(cu_stream, outputs[i], true);
+
+    err = cudaLaunch(kernel);
+    checkErr(err, error_string);
+
+    for (size_t i=0; i<inputs.size(); ++i) hipaccAddImageEvent(cu_stream, inputs[i], false);
+    for (size_t i=0; i<outputs.size(); ++i) hipaccAddImageEvent(cu_stream, outputs[i], true);
+
+    return hipaccRecordEvent(cu_stream);
+}
+
+
 // Benchmark timing for a kernel call
 void hipaccLaunchKernelBenchmark(const void *kernel, const char *kernel_name, std::vector<std::pair<size_t, void *> > args, dim3 grid, dim3 block, bool print_timing=true) {
     float min_dt=FLT_MAX;
+    size_t runs = hipaccGetBenchmarkRuns();
 
-    for (size_t i=0; i<HIPACC_NUM_ITERATIONS; ++i) {
+    benchmark_timings.clear();
+    // first iteration is a warm-up run
+    for (size_t i=0; i<=runs; ++i) {
         // setup call
         hipaccConfigureCall(grid, block);
 
@@ -665,7 +955,9 @@ void hipaccLaunchKernelBenchmark(const void *kernel, const char *kernel_name, st
         }
 
         // launch kernel
-        hipaccLaunchKernel(kernel, kernel_name, grid, block, print_timing);
+        hipaccLaunchKernel(kernel, kernel_name, grid, block, print_timing && i);
+        if (!i) continue;
+        benchmark_timings.push_back(last_gpu_timing);
         if (last_gpu_timing < min_dt) min_dt = last_gpu_timing;
     }
 
@@ -836,15 +1128,21 @@ void hipaccLaunchKernel(CUfunction &kernel, const char *kernel_name, dim3 grid,
     cudaEventDestroy(end);
 
     last_gpu_timing = time;
+    if (Ctx.is_profiling()) Ctx.profile_add(kernel_name, time);
     if (print_timing) {
         std::cerr << "<HIPACC:> Kernel timing (" << block.x*block.y << ": " << block.x << "x" << block.y << "): " << time << "(ms)" << std::endl;
     }
 }
 void hipaccLaunchKernelBenchmark(CUfunction &kernel, const char *kernel_name, dim3 grid, dim3 block, void **args, bool print_timing=true) {
     float min_dt=FLT_MAX;
-
-    for (size_t i=0; i<HIPACC_NUM_ITERATIONS; i++) {
-        hipaccLaunchKernel(kernel, kernel_name, grid, block, args, print_timing);
+    size_t runs = hipaccGetBenchmarkRuns();
+
+    benchmark_timings.clear();
+    // first iteration is a warm-up run
+    for (size_t i=0; i<=runs; i++) {
+        hipaccLaunchKernel(kernel, kernel_name, grid, block, args, print_timing && i);
+        if (!i) continue;
+        benchmark_timings.push_back(last_gpu_timing);
         if (last_gpu_timing < min_dt) min_dt = last_gpu_timing;
     }
 
@@ -1279,7 +1577,8 @@ void hipaccKernelExploration(const char *filename, const char *kernel,
         std::vector<hipacc_const_info> consts, std::vector<hipacc_tex_info>
         texs, hipacc_launch_info &info, int warp_size, int
         max_threads_per_block, int max_threads_for_kernel, int
-        max_smem_per_block, int heu_tx, int heu_ty, int cc) {
+        max_smem_per_block, int heu_tx, int heu_ty, int cc, const char
+        *tuning_db=NULL, const char *tuning_key=NULL) {
     CUresult err = CUDA_SUCCESS;
     std::string ptx_filename = filename;
     ptx_filename += ".ptx";
@@ -1374,6 +1673,9 @@ void hipaccKernelExploration(const char *filename, const char *kernel,
     std::cerr << "<HIPACC:> Best configurations for kernel '" << kernel << "': "
               << opt_tx*opt_ty << " (" << opt_tx << "x" << opt_ty << "): "
               << opt_time << " ms" << std::endl;
+
+    hipaccWriteTuningRecord(tuning_db, tuning_key, info, opt_tx, opt_ty,
+                            opt_time);
 }
 
 #endif  // __HIPACC_CUDA_HPP__
@@ -36,12 +36,16 @@
 #include <assert.h>
 #include <float.h>
 #include <math.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <map>
+#include <set>
 #include <sstream>
 #include <utility>
 #include <vector>
@@ -61,6 +65,13 @@ enum cl_platform_name {
 };
 
 
+typedef struct hipacc_image_events {
+    hipacc_image_events() : write(NULL) {}
+    cl_event write;
+    std::vector<cl_event> reads;
+} hipacc_image_events;
+
+
 class HipaccContext : public HipaccContextBase {
     private:
         std::vector<cl_platform_id> platforms;
@@ -68,8 +79,26 @@ class HipaccContext : public HipaccContextBase {
         std::vector<cl_device_id> devices, devices_all;
         std::vector<cl_context> contexts;
         std::vector<cl_command_queue> queues;
+        // command queues for asynchronous operations and their pending
+        // operations per image
+        std::vector<cl_command_queue> streams;
+        std::map<void *, hipacc_image_events> image_events;
+        // number of streams concurrent kernel launches are distributed to and
+        // the stream of the next launch
+        int concurrent_streams, next_stream;
+        // programs by file name and build options, kernels by program and name
+        std::map<std::string, cl_program> programs;
+        std::map<std::pair<cl_program, std::string>, cl_kernel> kernels;
+        size_t cache_hits, cache_misses;
+
+        HipaccContext() :
+            concurrent_streams(4), next_stream(0), cache_hits(0),
+            cache_misses(0) {}
 
     public:
+        // OpenCL objects are not released by the destructor: the OpenCL
+        // implementation might already be unloaded during static destruction.
+        // Use hipaccReleaseAll() to release them before exit
         static HipaccContext &getInstance() {
             static HipaccContext instance;
 
@@ -89,6 +118,62 @@ class HipaccContext : public HipaccContextBase {
         std::vector<cl_device_id> get_devices_all() { return devices_all; }
         std::vector<cl_context> get_contexts() { return contexts; }
         std::vector<cl_command_queue> get_command_queues() { return queues; }
+        std::vector<cl_command_queue> &get_streams() { return streams; }
+        std::map<void *, hipacc_image_events> &get_image_events() { return image_events; }
+        void set_concurrent_streams(int num) {
+            concurrent_streams = num;
+            next_stream = 0;
+        }
+        int get_concurrent_stream() {
+            int stream = next_stream;
+            next_stream = (next_stream + 1) % concurrent_streams;
+            return stream;
+        }
+        cl_program get_program(std::string key) {
+            std::map<std::string, cl_program>::iterator it = programs.find(key);
+            if (it == programs.end()) return NULL;
+            return it->second;
+        }
+        void add_program(std::string key, cl_program program) { programs[key] = program; }
+        cl_kernel get_kernel(cl_program program, std::string name) {
+            std::map<std::pair<cl_program, std::string>, cl_kernel>::iterator it =
+                kernels.find(std::make_pair(program, name));
+            if (it == kernels.end()) {
+                ++cache_misses;
+                return NULL;
+            }
+            ++cache_hits;
+            return it->second;
+        }
+        void add_kernel(cl_program program, std::string name, cl_kernel kernel) {
+            kernels[std::make_pair(program, name)] = kernel;
+        }
+        size_t get_cache_hits() { return cache_hits; }
+        size_t get_cache_misses() { return cache_misses; }
+        void release_kernels() {
+            for (std::map<std::pair<cl_program, std::string>, cl_kernel>::iterator
+                 it=kernels.begin(); it!=kernels.end(); ++it) {
+                clReleaseKernel(it->second);
+            }
+            for (std::map<std::string, cl_program>::iterator it=programs.begin();
+                 it!=programs.end(); ++it) {
+                clReleaseProgram(it->second);
+            }
+            kernels.clear();
+            programs.clear();
+        }
+        void release_devices() {
+            for (size_t i=0; i<streams.size(); ++i) clReleaseCommandQueue(streams[i]);
+            for (size_t i=0; i<queues.size(); ++i) clReleaseCommandQueue(queues[i]);
+            for (size_t i=0; i<contexts.size(); ++i) clReleaseContext(contexts[i]);
+            streams.clear();
+            queues.clear();
+            contexts.clear();
+            platforms.clear();
+            platform_names.clear();
+            devices.clear();
+            devices_all.clear();
+        }
 };
 
 
@@ -438,8 +523,8 @@ void hipaccCreateContextsAndCommandQueues(bool all_devies=false) {
 }
 
 
-// Get binary from OpenCL program and dump it to stderr
-void hipaccDumpBinary(cl_program program, cl_device_id device) {
+// Get the binaries of an OpenCL program for all associated devices
+std::vector<std::pair<cl_device_id, std::string> > hipaccGetBinaries(cl_program program) {
     cl_int err = CL_SUCCESS;
     cl_uint num_devices;
 
@@ -447,46 +532,238 @@ void hipaccDumpBinary(cl_program program, cl_device_id device) {
     err = clGetProgramInfo(program, CL_PROGRAM_NUM_DEVICES, sizeof(cl_uint), &num_devices, NULL);
 
     // Get the associated device ids
-    cl_device_id *devices = (cl_device_id *)malloc(num_devices * sizeof(cl_device_id));
-    err |= clGetProgramInfo(program, CL_PROGRAM_DEVICES, num_devices * sizeof(cl_device_id), devices, 0);
+    std::vector<cl_device_id> devices(num_devices);
+    err |= clGetProgramInfo(program, CL_PROGRAM_DEVICES, num_devices * sizeof(cl_device_id), devices.data(), 0);
 
     // Get the sizes of the binaries
-    size_t *binary_sizes = (size_t *)malloc(num_devices * sizeof(size_t));
-    err |= clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES, num_devices * sizeof(size_t), binary_sizes, NULL);
+    std::vector<size_t> binary_sizes(num_devices);
+    err |= clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES, num_devices * sizeof(size_t), binary_sizes.data(), NULL);
 
     // Get the binaries
-    unsigned char **binary = (unsigned char **)malloc(num_devices * sizeof(unsigned char *));
+    std::vector<std::string> binaries(num_devices);
+    std::vector<unsigned char *> binary(num_devices);
     for (size_t i=0; i<num_devices; ++i) {
-        binary[i] = (unsigned char *)malloc(binary_sizes[i]);
+        binaries[i].resize(binary_sizes[i]);
+        binary[i] = (unsigned char *)&binaries[i][0];
     }
-    err |= clGetProgramInfo(program, CL_PROGRAM_BINARIES,  sizeof(unsigned char *)*num_devices, binary, NULL);
+    err |= clGetProgramInfo(program, CL_PROGRAM_BINARIES,  sizeof(unsigned char *)*num_devices, binary.data(), NULL);
     checkErr(err, "clGetProgramInfo()");
 
+    std::vector<std::pair<cl_device_id, std::string> > result;
     for (size_t i=0; i<num_devices; ++i) {
-        if (devices[i] == device) {
+        result.push_back(std::make_pair(devices[i], binaries[i]));
+    }
+
+    return result;
+}
+
+
+// Get binary from OpenCL program and dump it to stderr
+void hipaccDumpBinary(cl_program program, cl_device_id device) {
+    std::vector<std::pair<cl_device_id, std::string> > binaries = hipaccGetBinaries(program);
+
+    for (size_t i=0; i<binaries.size(); ++i) {
+        if (binaries[i].first == device) {
             std::cerr << "OpenCL binary : " << std::endl;
             // binary can contain any character, emit char by char
-            for (size_t n=0; n<binary_sizes[i]; ++n) {
-                std::cerr << binary[i][n];
+            for (size_t n=0; n<binaries[i].second.size(); ++n) {
+                std::cerr << binaries[i].second[n];
             }
             std::cerr << std::endl;
         }
     }
+}
 
-    for (size_t i=0; i<num_devices; ++i) {
-        free(binary[i]);
+
+// Get the directory of the OpenCL program cache; the cache is disabled if
+// HIPACC_OCL_CACHE is not set
+std::string hipaccGetProgramCacheDir() {
+    const char *dir = getenv("HIPACC_OCL_CACHE");
+
+    return dir ? dir : "";
+}
+
+
+// Get device info string
+std::string hipaccGetDeviceInfo(cl_device_id device, cl_device_info param) {
+    size_t size = 0;
+    cl_int err = clGetDeviceInfo(device, param, 0, NULL, &size);
+    std::string info(size, '\0');
+    err |= clGetDeviceInfo(device, param, size, &info[0], NULL);
+    checkErr(err, "clGetDeviceInfo()");
+
+    return info;
+}
+
+
+// Add the headers included by source to the key of a program in the cache, so
+// that updated runtime headers invalidate the cached binaries. Headers are
+// searched in the current directory and the -I directories of the options
+void hipaccAddProgramIncludes(std::stringstream &key, const std::string &source, const std::vector<std::string> &dirs, std::set<std::string> &visited) {
+    std::istringstream lines(source);
+    std::string line;
+
+    while (std::getline(lines, line)) {
+        size_t pos = line.find_first_not_of(" \t");
+        if (pos == std::string::npos || line[pos] != '#') continue;
+        pos = line.find_first_not_of(" \t", pos + 1);
+        if (pos == std::string::npos || line.compare(pos, 7, "include") != 0) continue;
+        pos = line.find_first_of("\"<", pos + 7);
+        if (pos == std::string::npos) continue;
+        size_t end = line.find_first_of("\">", pos + 1);
+        if (end == std::string::npos) continue;
+        std::string name = line.substr(pos + 1, end - pos - 1);
+
+        bool found = false;
+        for (size_t i=0; i<dirs.size() && !found; ++i) {
+            std::string path = dirs[i] + "/" + name;
+            std::ifstream header(path.c_str());
+            if (!header.is_open()) continue;
+            found = true;
+            if (!visited.insert(path).second) break;
+
+            std::string content(std::istreambuf_iterator<char>(header),
+                    (std::istreambuf_iterator<char>()));
+            key << "include: " << path << "\n" << content << "\n";
+            hipaccAddProgramIncludes(key, content, dirs, visited);
+        }
+        if (!found) key << "include: " << name << " (not found)\n";
     }
-    free(binary);
-    free(binary_sizes);
-    free(devices);
 }
 
 
-// Load OpenCL source file, build program, and create kernel
-cl_kernel hipaccBuildProgramAndKernel(std::string file_name, std::string kernel_name, bool print_progress=true, bool dump_binary=false, bool print_log=false, const char *build_options=(const char *)"", const char *build_includes=(const char *)"") {
+// Compute the key of a program in the cache: the key consists of the source
+// and the headers it includes, the build options, and the name and driver
+// version of each device
+std::string hipaccGetProgramCacheKey(const std::string &source, const std::string &options, const std::vector<cl_device_id> &devices) {
+    std::stringstream key;
+
+    key << "options: " << options << "\n";
+    for (size_t i=0; i<devices.size(); ++i) {
+        key << "device: " << hipaccGetDeviceInfo(devices[i], CL_DEVICE_NAME).c_str()
+            << ", " << hipaccGetDeviceInfo(devices[i], CL_DEVICE_VERSION).c_str()
+            << ", driver " << hipaccGetDeviceInfo(devices[i], CL_DRIVER_VERSION).c_str() << "\n";
+    }
+    key << "source: " << source << "\n";
+
+    // include directories given as '-I dir' or '-Idir'
+    std::vector<std::string> dirs(1, ".");
+    std::istringstream tokens(options);
+    std::string token;
+    while (tokens >> token) {
+        if (token.compare(0, 2, "-I") != 0) continue;
+        if (token.size() > 2) dirs.push_back(token.substr(2));
+        else if (tokens >> token) dirs.push_back(token);
+    }
+    std::set<std::string> visited;
+    hipaccAddProgramIncludes(key, source, dirs, visited);
+
+    return key.str();
+}
+
+
+// Get the file name of a cache entry from the FNV-1a hash of its key
+std::string hipaccGetProgramCacheFile(const std::string &key) {
+    unsigned long long hash = 14695981039346656037ULL;
+    for (size_t i=0; i<key.size(); ++i) {
+        hash ^= (unsigned char)key[i];
+        hash *= 1099511628211ULL;
+    }
+
+    std::stringstream file_name;
+    file_name << hipaccGetProgramCacheDir() << "/hipacc_" << std::hex
+              << std::setw(16) << std::setfill('0') << hash << ".bin";
+
+    return file_name.str();
+}
+
+
+// Load program binaries for the given devices from the cache; returns NULL if
+// the program is not cached or the cached binaries are rejected by the driver
+cl_program hipaccLoadProgramBinary(cl_context context, const std::vector<cl_device_id> &devices, const std::string &key, const char *options) {
+    std::ifstream file(hipaccGetProgramCacheFile(key).c_str(), std::ios::binary);
+    if (!file.is_open()) return NULL;
+
+    // the cache entry stores the complete key to detect hash collisions
+    size_t key_size = 0, num_binaries = 0;
+    file.read((char *)&key_size, sizeof(size_t));
+    if (!file.good() || key_size != key.size()) return NULL;
+    std::string file_key(key_size, '\0');
+    file.read(&file_key[0], key_size);
+    file.read((char *)&num_binaries, sizeof(size_t));
+    if (!file.good() || file_key != key || num_binaries != devices.size()) return NULL;
+
+    std::vector<std::string> binaries(num_binaries);
+    std::vector<size_t> binary_sizes(num_binaries);
+    std::vector<const unsigned char *> binary(num_binaries);
+    for (size_t i=0; i<num_binaries; ++i) {
+        file.read((char *)&binary_sizes[i], sizeof(size_t));
+        if (!file.good()) return NULL;
+        binaries[i].resize(binary_sizes[i]);
+        file.read(&binaries[i][0], binary_sizes[i]);
+        if (!file.good()) return NULL;
+        binary[i] = (const unsigned char *)binaries[i].data();
+    }
+
+    cl_int err = CL_SUCCESS;
+    std::vector<cl_int> binary_status(num_binaries);
+    cl_program program = clCreateProgramWithBinary(context, devices.size(), devices.data(), binary_sizes.data(), binary.data(), binary_status.data(), &err);
+    if (err != CL_SUCCESS) return NULL;
+
+    err = clBuildProgram(program, 0, NULL, options, NULL, NULL);
+    if (err != CL_SUCCESS) {
+        clReleaseProgram(program);
+        return NULL;
+    }
+
+    return program;
+}
+
+
+// Store program binaries in the cache; the entry is written to a temporary
+// file named after the process first and renamed afterwards, so that
+// concurrent processes never see or write partially written entries
+void hipaccStoreProgramBinary(cl_program program, const std::string &key) {
+    std::vector<std::pair<cl_device_id, std::string> > binaries = hipaccGetBinaries(program);
+    std::string file_name = hipaccGetProgramCacheFile(key);
+    std::stringstream tmp_name;
+    tmp_name << file_name << "." << getpid() << "." << getMicroTime() << ".tmp";
+
+    for (size_t i=0; i<binaries.size(); ++i) {
+        // no binary available, e.g. for an unused device
+        if (binaries[i].second.empty()) return;
+    }
+
+    std::ofstream file(tmp_name.str().c_str(), std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "WARNING: Can't write OpenCL program cache '" << tmp_name.str() << "'!" << std::endl;
+        return;
+    }
+
+    size_t key_size = key.size(), num_binaries = binaries.size();
+    file.write((const char *)&key_size, sizeof(size_t));
+    file.write(key.data(), key_size);
+    file.write((const char *)&num_binaries, sizeof(size_t));
+    for (size_t i=0; i<num_binaries; ++i) {
+        size_t binary_size = binaries[i].second.size();
+        file.write((const char *)&binary_size, sizeof(size_t));
+        file.write(binaries[i].second.data(), binary_size);
+    }
+    file.close();
+
+    if (!file.good() || rename(tmp_name.str().c_str(), file_name.c_str()) != 0) {
+        std::cerr << "WARNING: Can't write OpenCL program cache '" << file_name << "'!" << std::endl;
+        remove(tmp_name.str().c_str());
+    }
+}
+
+
+// Load OpenCL source file and build program; if HIPACC_OCL_CACHE is set, the
+// program binaries are loaded from or stored to the program cache in that
+// directory. Calling this function at deployment time pre-populates the cache
+cl_program hipaccBuildProgram(std::string file_name, bool print_progress=true, bool print_log=false, const char *build_options=(const char *)"", const char *build_includes=(const char *)"") {
     cl_int err = CL_SUCCESS;
     cl_program program;
-    cl_kernel kernel;
     HipaccContext &Ctx = HipaccContext::getInstance();
 
     std::ifstream srcFile(file_name.c_str());
@@ -501,10 +778,6 @@ cl_kernel hipaccBuildProgramAndKernel(std::string file_name, std::string kernel_
     const size_t length = clString.length();
     const char *c_str = clString.c_str();
 
-    if (print_progress) std::cerr << "<HIPACC:> Compiling '" << kernel_name << "' .";
-    program = clCreateProgramWithSource(Ctx.get_contexts()[0], 1, (const char **)&c_str, &length, &err);
-    checkErr(err, "clCreateProgramWithSource()");
-
     std::string options = build_options;
     std::string includes = build_includes;
     cl_platform_name platform_name = Ctx.get_platform_names()[0];
@@ -530,6 +803,29 @@ cl_kernel hipaccBuildProgramAndKernel(std::string file_name, std::string kernel_
     if (includes != "") {
         options += " " + includes;
     }
+
+    // the build log is only available when compiling from source
+    bool use_cache = hipaccGetProgramCacheDir() != "" && !print_log;
+    std::string cache_key;
+    if (use_cache) {
+        cl_uint num_devices = 0;
+        err = clGetContextInfo(Ctx.get_contexts()[0], CL_CONTEXT_NUM_DEVICES, sizeof(cl_uint), &num_devices, NULL);
+        std::vector<cl_device_id> devices(num_devices);
+        err |= clGetContextInfo(Ctx.get_contexts()[0], CL_CONTEXT_DEVICES, num_devices * sizeof(cl_device_id), devices.data(), NULL);
+        checkErr(err, "clGetContextInfo()");
+
+        cache_key = hipaccGetProgramCacheKey(clString, options, devices);
+        program = hipaccLoadProgramBinary(Ctx.get_contexts()[0], devices, cache_key, options.c_str());
+        if (program) {
+            if (print_progress) std::cerr << "<HIPACC:> Loading '" << file_name << "' from program cache ... done" << std::endl;
+            return program;
+        }
+    }
+
+    if (print_progress) std::cerr << "<HIPACC:> Compiling '" << file_name << "' .";
+    program = clCreateProgramWithSource(Ctx.get_contexts()[0], 1, (const char **)&c_str, &length, &err);
+    checkErr(err, "clCreateProgramWithSource()");
+
     err = clBuildProgram(program, 0, NULL, options.c_str(), NULL, NULL);
     if (print_progress) std::cerr << ".";
 
@@ -558,17 +854,76 @@ cl_kernel hipaccBuildProgramAndKernel(std::string file_name, std::string kernel_
         free(program_build_log);
     }
     checkErr(err, "clBuildProgram(), clGetProgramBuildInfo()");
+    if (print_progress) std::cerr << ". done" << std::endl;
 
-    if (dump_binary) hipaccDumpBinary(program, Ctx.get_devices()[0]);
+    if (use_cache) hipaccStoreProgramBinary(program, cache_key);
 
-    kernel = clCreateKernel(program, kernel_name.c_str(), &err);
-    checkErr(err, "clCreateKernel()");
-    if (print_progress) std::cerr << ". done" << std::endl;
+    return program;
+}
+
+
+// Load OpenCL source file, build program, and create kernel; programs and
+// kernels are built only once and reused by subsequent calls
+cl_kernel hipaccBuildProgramAndKernel(std::string file_name, std::string kernel_name, bool print_progress=true, bool dump_binary=false, bool print_log=false, const char *build_options=(const char *)"", const char *build_includes=(const char *)"") {
+    cl_int err = CL_SUCCESS;
+    cl_kernel kernel;
+    HipaccContext &Ctx = HipaccContext::getInstance();
+
+    std::string program_key = file_name + "\n" + build_options + "\n" + build_includes;
+    cl_program program = Ctx.get_program(program_key);
+    if (!program) {
+        program = hipaccBuildProgram(file_name, print_progress, print_log, build_options, build_includes);
+        Ctx.add_program(program_key, program);
+
+        if (dump_binary) hipaccDumpBinary(program, Ctx.get_devices()[0]);
+    }
+
+    kernel = Ctx.get_kernel(program, kernel_name);
+    if (!kernel) {
+        kernel = clCreateKernel(program, kernel_name.c_str(), &err);
+        checkErr(err, "clCreateKernel()");
+        Ctx.add_kernel(program, kernel_name, kernel);
+    }
 
     return kernel;
 }
 
 
+// Get the number of kernel requests served from and missing in the kernel cache
+void hipaccGetKernelCacheStatistics(size_t &hits, size_t &misses) {
+    HipaccContext &Ctx = HipaccContext::getInstance();
+
+    hits = Ctx.get_cache_hits();
+    misses = Ctx.get_cache_misses();
+}
+
+
+// Release all cached programs and kernels
+void hipaccReleaseKernels() {
+    HipaccContext &Ctx = HipaccContext::getInstance();
+
+    Ctx.release_kernels();
+}
+
+
+// Allocate buffer via the memory pool; the size is rounded up to the bucket
+// size, so that buffers of similar size can be reused
+cl_mem hipaccAllocBuffer(size_t bytes, int alignment) {
+    cl_int err = CL_SUCCESS;
+    HipaccContext &Ctx = HipaccContext::getInstance();
+
+    bytes = HipaccContextBase::pool_bucket(bytes);
+    cl_mem buffer = (cl_mem)Ctx.pool_get(bytes, alignment);
+    if (!buffer) {
+        buffer = clCreateBuffer(Ctx.get_contexts()[0], CL_MEM_READ_WRITE, bytes, NULL, &err);
+        checkErr(err, "clCreateBuffer()");
+        Ctx.pool_add((void *)buffer, bytes, alignment);
+    }
+
+    return buffer;
+}
+
+
 // Allocate memory with alignment specified
 template<typename T>
 HipaccImage hipaccCreateBuffer(T *host_mem, int width, int height, int alignment) {
@@ -584,8 +939,12 @@ HipaccImage hipaccCreateBuffer(T *host_mem, int width, int height, int alignment
     alignment = (int)ceilf((float)alignment/sizeof(T)) * sizeof(T);
     // compute stride
     int stride = (int)ceilf((float)(width)/(alignment/sizeof(T))) * (alignment/sizeof(T));
-    buffer = clCreateBuffer(Ctx.get_contexts()[0], flags, sizeof(T)*stride*height, host_mem, &err);
-    checkErr(err, "clCreateBuffer()");
+    if (host_mem) {
+        buffer = clCreateBuffer(Ctx.get_contexts()[0], flags, sizeof(T)*stride*height, host_mem, &err);
+        checkErr(err, "clCreateBuffer()");
+    } else {
+        buffer = hipaccAllocBuffer(sizeof(T)*stride*height, alignment);
+    }
 
     HipaccImage img = HipaccImage(width, height, stride, alignment, sizeof(T), (void *)buffer);
     Ctx.add_image(img);
@@ -606,8 +965,12 @@ HipaccImage hipaccCreateBuffer(T *host_mem, int width, int height) {
         flags |= CL_MEM_COPY_HOST_PTR | CL_MEM_ALLOC_HOST_PTR;
     }
     int stride = width;
-    buffer = clCreateBuffer(Ctx.get_contexts()[0], flags, sizeof(T)*width*height, host_mem, &err);
-    checkErr(err, "clCreateBuffer()");
+    if (host_mem) {
+        buffer = clCreateBuffer(Ctx.get_contexts()[0], flags, sizeof(T)*width*height, host_mem, &err);
+        checkErr(err, "clCreateBuffer()");
+    } else {
+        buffer = hipaccAllocBuffer(sizeof(T)*width*height, 0);
+    }
 
     HipaccImage img = HipaccImage(width, height, stride, 0, sizeof(T), (void *)buffer);
     Ctx.add_image(img);
@@ -710,24 +1073,188 @@ cl_sampler hipaccCreateSampler(cl_bool normalized_coords, cl_addressing_mode add
 }
 
 
+// Get the command queue of an asynchronous stream; streams are created on
+// demand for the first device
+cl_command_queue hipaccGetStream(int stream) {
+    cl_int err = CL_SUCCESS;
+    HipaccContext &Ctx = HipaccContext::getInstance();
+    std::vector<cl_command_queue> &streams = Ctx.get_streams();
+
+    while (streams.size() <= (size_t)stream) {
+        cl_command_queue queue = clCreateCommandQueue(Ctx.get_contexts()[0], Ctx.get_devices()[0], CL_QUEUE_PROFILING_ENABLE, &err);
+        checkErr(err, "clCreateCommandQueue()");
+        streams.push_back(queue);
+    }
+
+    return streams[stream];
+}
+
+
+// Get the events an asynchronous operation on an image has to wait for:
+// reading requires the last write to be finished, writing additionally
+// requires all reads issued since then to be finished
+void hipaccGetImageDependencies(HipaccImage &img, bool write, std::vector<cl_event> &deps) {
+    HipaccContext &Ctx = HipaccContext::getInstance();
+    std::map<void *, hipacc_image_events> &events = Ctx.get_image_events();
+    std::map<void *, hipacc_image_events>::iterator it = events.find(img.mem);
+
+    if (it == events.end()) return;
+    if (it->second.write) deps.push_back(it->second.write);
+    if (write) deps.insert(deps.end(), it->second.reads.begin(), it->second.reads.end());
+}
+
+
+// Record the event of an asynchronous operation on an image
+void hipaccAddImageEvent(HipaccImage &img, cl_event event, bool write) {
+    cl_int err = CL_SUCCESS;
+    HipaccContext &Ctx = HipaccContext::getInstance();
+    hipacc_image_events &events = Ctx.get_image_events()[img.mem];
+
+    err = clRetainEvent(event);
+    if (write) {
+        if (events.write) err |= clReleaseEvent(events.write);
+        for (size_t i=0; i<events.reads.size(); ++i) {
+            err |= clReleaseEvent(events.reads[i]);
+        }
+        events.write = event;
+        events.reads.clear();
+    } else {
+        // drop finished reads, images might be read many times without writes
+        std::vector<cl_event> reads;
+        for (size_t i=0; i<events.reads.size(); ++i) {
+            cl_int status = CL_COMPLETE;
+            err |= clGetEventInfo(events.reads[i], CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(cl_int), &status, NULL);
+            if (status == CL_COMPLETE) err |= clReleaseEvent(events.reads[i]);
+            else reads.push_back(events.reads[i]);
+        }
+        reads.push_back(event);
+        events.reads.swap(reads);
+    }
+    checkErr(err, "clRetainEvent(), clReleaseEvent()");
+}
+
+
+// Get an event that completes after all commands enqueued so far to a stream
+cl_event hipaccEnqueueMarker(cl_command_queue queue) {
+    cl_int err = CL_SUCCESS;
+    cl_event event;
+
+    #ifdef CL_VERSION_1_2
+    err = clEnqueueMarkerWithWaitList(queue, 0, NULL, &event);
+    #else
+    err = clEnqueueMarker(queue, &event);
+    #endif
+    checkErr(err, "clEnqueueMarker()");
+    err = clFlush(queue);
+    checkErr(err, "clFlush()");
+
+    return event;
+}
+
+
+// Wait for an event returned by an asynchronous operation and release it
+void hipaccWaitEvent(cl_event event) {
+    cl_int err = CL_SUCCESS;
+
+    err = clWaitForEvents(1, &event);
+    err |= clReleaseEvent(event);
+    checkErr(err, "clWaitForEvents()");
+}
+
+
+// Wait for all asynchronous operations; blocking operations call this first
+// so that they can be mixed with asynchronous ones
+void hipaccSynchronize() {
+    cl_int err = CL_SUCCESS;
+    HipaccContext &Ctx = HipaccContext::getInstance();
+    std::vector<cl_command_queue> &streams = Ctx.get_streams();
+    std::map<void *, hipacc_image_events> &events = Ctx.get_image_events();
+
+    if (events.empty()) return;
+
+    for (size_t i=0; i<streams.size(); ++i) {
+        err |= clFinish(streams[i]);
+    }
+    for (std::map<void *, hipacc_image_events>::iterator it=events.begin();
+         it!=events.end(); ++it) {
+        if (it->second.write) err |= clReleaseEvent(it->second.write);
+        for (size_t i=0; i<it->second.reads.size(); ++i) {
+            err |= clReleaseEvent(it->second.reads[i]);
+        }
+    }
+    events.clear();
+    checkErr(err, "clFinish()");
+}
+
+
 // Release buffer or image
 void hipaccReleaseMemory(HipaccImage &img) {
     cl_int err = CL_SUCCESS;
     HipaccContext &Ctx = HipaccContext::getInstance();
 
-    err = clReleaseMemObject((cl_mem)img.mem);
-    checkErr(err, "clReleaseMemObject()");
+    hipaccSynchronize();
+    if (!Ctx.pool_put(img.mem)) {
+        err = clReleaseMemObject((cl_mem)img.mem);
+        checkErr(err, "clReleaseMemObject()");
+    }
 
     Ctx.del_image(img);
 }
 
 
+// Free all buffers held by the memory pool
+void hipaccReleaseMemoryPool() {
+    cl_int err = CL_SUCCESS;
+    HipaccContext &Ctx = HipaccContext::getInstance();
+    std::vector<void *> buffers = Ctx.pool_drain();
+
+    for (size_t i=0; i<buffers.size(); ++i) {
+        err |= clReleaseMemObject((cl_mem)buffers[i]);
+    }
+    checkErr(err, "clReleaseMemObject()");
+}
+
+
+// Set the maximal number of bytes held by free buffers in the memory pool
+void hipaccSetMemoryPoolLimit(size_t bytes) {
+    HipaccContext &Ctx = HipaccContext::getInstance();
+
+    Ctx.set_pool_limit(bytes);
+    if (Ctx.get_pool_stats().pooled_bytes > bytes) hipaccReleaseMemoryPool();
+}
+
+
+// Release all OpenCL objects held by the runtime after finishing pending
+// operations: cached programs and kernels, buffers of the memory pool, command
+// queues, and contexts. Objects still held at exit are not released, since the
+// OpenCL implementation might already be unloaded at that time. The runtime has
+// to be initialized again to be used afterwards
+void hipaccReleaseAll() {
+    HipaccContext &Ctx = HipaccContext::getInstance();
+
+    hipaccSynchronize();
+    hipaccReleaseKernels();
+    hipaccReleaseMemoryPool();
+    Ctx.release_devices();
+}
+
+
+// Get allocation statistics of the memory pool
+hipacc_pool_stats hipaccGetMemoryPoolStats() {
+    HipaccContext &Ctx = HipaccContext::getInstance();
+
+    return Ctx.get_pool_stats();
+}
+
+
 // Write to memory
 template<typename T>
 void hipaccWriteMemory(HipaccImage &img, T *host_mem, int num_device=0) {
     cl_int err = CL_SUCCESS;
     HipaccContext &Ctx = HipaccContext::getInstance();
 
+    hipaccSynchronize();
+    long start = Ctx.is_profiling() ? getMicroTime() : 0;
     if (img.mem_type >= Array2D) {
         const size_t origin[] = { 0, 0, 0 };
         const size_t region[] = { (size_t)img.width, (size_t)img.height, 1 };
@@ -753,6 +1280,11 @@ void hipaccWriteMemory(HipaccImage &img, T *host_mem, int num_device=0) {
         err |= clFinish(Ctx.get_command_queues()[num_device]);
         checkErr(err, "clEnqueueWriteBuffer()");
     }
+
+    if (Ctx.is_profiling()) {
+        Ctx.profile_add("hipaccWriteMemory", (getMicroTime() - start)*1.0e-3f,
+                        img.pixel_size*img.width*img.height);
+    }
 }
 
 
@@ -762,6 +1294,8 @@ void hipaccReadMemory(T *host_mem, HipaccImage &img, int num_device=0) {
     cl_int err = CL_SUCCESS;
     HipaccContext &Ctx = HipaccContext::getInstance();
 
+    hipaccSynchronize();
+    long start = Ctx.is_profiling() ? getMicroTime() : 0;
     if (img.mem_type >= Array2D) {
         const size_t origin[] = { 0, 0, 0 };
         const size_t region[] = { (size_t)img.width, (size_t)img.height, 1 };
@@ -787,6 +1321,122 @@ void hipaccReadMemory(T *host_mem, HipaccImage &img, int num_device=0) {
         err |= clFinish(Ctx.get_command_queues()[num_device]);
         checkErr(err, "clEnqueueReadBuffer()");
     }
+
+    if (Ctx.is_profiling()) {
+        Ctx.profile_add("hipaccReadMemory", (getMicroTime() - start)*1.0e-3f,
+                        img.pixel_size*img.width*img.height);
+    }
+}
+
+
+// Write to memory without blocking; host_mem must not be modified before the
+// returned event is finished
+template<typename T>
+cl_event hipaccWriteMemoryAsync(HipaccImage &img, T *host_mem, int stream=0) {
+    cl_int err = CL_SUCCESS;
+    cl_command_queue queue = hipaccGetStream(stream);
+    std::vector<cl_event> deps;
+
+    hipaccGetImageDependencies(img, true, deps);
+
+    if (img.mem_type >= Array2D) {
+        const size_t origin[] = { 0, 0, 0 };
+        const size_t region[] = { (size_t)img.width, (size_t)img.height, 1 };
+        // no stride supported for images in OpenCL
+        const size_t input_row_pitch = img.width*sizeof(T);
+        const size_t input_slice_pitch = 0;
+
+        err = clEnqueueWriteImage(queue, (cl_mem)img.mem, CL_FALSE, origin, region, input_row_pitch, input_slice_pitch, host_mem, deps.size(), deps.size() ? deps.data() : NULL, NULL);
+        checkErr(err, "clEnqueueWriteImage()");
+    } else {
+        size_t width = img.width;
+        size_t height = img.height;
+        size_t stride = img.stride;
+
+        if (stride > width) {
+            const size_t buffer_origin[] = { 0, 0, 0 };
+            const size_t region[] = { sizeof(T)*width, height, 1 };
+
+            err = clEnqueueWriteBufferRect(queue, (cl_mem)img.mem, CL_FALSE, buffer_origin, buffer_origin, region, sizeof(T)*stride, 0, sizeof(T)*width, 0, host_mem, deps.size(), deps.size() ? deps.data() : NULL, NULL);
+        } else {
+            err = clEnqueueWriteBuffer(queue, (cl_mem)img.mem, CL_FALSE, 0, sizeof(T)*width*height, host_mem, deps.size(), deps.size() ? deps.data() : NULL, NULL);
+        }
+        checkErr(err, "clEnqueueWriteBuffer()");
+    }
+
+    cl_event event = hipaccEnqueueMarker(queue);
+    hipaccAddImageEvent(img, event, true);
+
+    return event;
+}
+
+
+// Read from memory without blocking; host_mem is valid after the returned
+// event is finished
+template<typename T>
+cl_event hipaccReadMemoryAsync(T *host_mem, HipaccImage &img, int stream=0) {
+    cl_int err = CL_SUCCESS;
+    cl_command_queue queue = hipaccGetStream(stream);
+    std::vector<cl_event> deps;
+
+    hipaccGetImageDependencies(img, false, deps);
+
+    if (img.mem_type >= Array2D) {
+        const size_t origin[] = { 0, 0, 0 };
+        const size_t region[] = { (size_t)img.width, (size_t)img.height, 1 };
+        // no stride supported for images in OpenCL
+        const size_t row_pitch = img.width*sizeof(T);
+        const size_t slice_pitch = 0;
+
+        err = clEnqueueReadImage(queue, (cl_mem)img.mem, CL_FALSE, origin, region, row_pitch, slice_pitch, host_mem, deps.size(), deps.size() ? deps.data() : NULL, NULL);
+        checkErr(err, "clEnqueueReadImage()");
+    } else {
+        size_t width = img.width;
+        size_t height = img.height;
+        size_t stride = img.stride;
+
+        if (stride > width) {
+            const size_t buffer_origin[] = { 0, 0, 0 };
+            const size_t region[] = { sizeof(T)*width, height, 1 };
+
+            err = clEnqueueReadBufferRect(queue, (cl_mem)img.mem, CL_FALSE, buffer_origin, buffer_origin, region, sizeof(T)*stride, 0, sizeof(T)*width, 0, host_mem, deps.size(), deps.size() ? deps.data() : NULL, NULL);
+        } else {
+            err = clEnqueueReadBuffer(queue, (cl_mem)img.mem, CL_FALSE, 0, sizeof(T)*width*height, host_mem, deps.size(), deps.size() ? deps.data() : NULL, NULL);
+        }
+        checkErr(err, "clEnqueueReadBuffer()");
+    }
+
+    cl_event event = hipaccEnqueueMarker(queue);
+    hipaccAddImageEvent(img, event, false);
+
+    return event;
+}
+
+
+// Write to memory without blocking, used by the generated host code: the
+// transfer is issued to the next stream and ordered only by the operations on
+// the image. host_mem must not be modified before the kernels reading the
+// image finished, e.g. before their output was read
+template<typename T>
+void hipaccWriteMemoryConcurrent(HipaccImage &img, T *host_mem) {
+    cl_int err = CL_SUCCESS;
+    HipaccContext &Ctx = HipaccContext::getInstance();
+    cl_event event;
+
+    event = hipaccWriteMemoryAsync(img, host_mem, Ctx.get_concurrent_stream());
+    err = clReleaseEvent(event);
+    checkErr(err, "clReleaseEvent()");
+}
+
+
+// Read from memory, used by the generated host code: waits only for the
+// operations on the image, so that transfers and kernels on other images, e.g.
+// of the next frame of a video, keep running in the meantime
+template<typename T>
+void hipaccReadMemoryConcurrent(T *host_mem, HipaccImage &img) {
+    HipaccContext &Ctx = HipaccContext::getInstance();
+
+    hipaccWaitEvent(hipaccReadMemoryAsync(host_mem, img, Ctx.get_concurrent_stream()));
 }
 
 
@@ -811,6 +1461,7 @@ void hipaccCopyMemory(HipaccImage &src, HipaccImage &dst, int num_device=0) {
     cl_int err = CL_SUCCESS;
     HipaccContext &Ctx = HipaccContext::getInstance();
 
+    hipaccSynchronize();
     assert(src.width == dst.width && src.height == dst.height && src.pixel_size == dst.pixel_size && "Invalid CopyBuffer or CopyImage!");
 
     if (src.mem_type >= Array2D) {
@@ -833,6 +1484,7 @@ void hipaccCopyMemoryRegion(HipaccAccessor src, HipaccAccessor dst, int num_devi
     cl_int err = CL_SUCCESS;
     HipaccContext &Ctx = HipaccContext::getInstance();
 
+    hipaccSynchronize();
     if (src.img.mem_type >= Array2D) {
         const size_t dst_origin[] = { (size_t)dst.offset_x, (size_t)dst.offset_y, 0 };
         const size_t src_origin[] = { (size_t)src.offset_x, (size_t)src.offset_y, 0 };
@@ -941,6 +1593,7 @@ void hipaccEnqueueKernel(cl_kernel kernel, size_t *global_work_size, size_t *loc
     #endif
     HipaccContext &Ctx = HipaccContext::getInstance();
 
+    hipaccSynchronize();
     #ifdef GPU_TIMING
     err = clEnqueueNDRangeKernel(Ctx.get_command_queues()[0], kernel, 2, NULL, global_work_size, local_work_size, 0, NULL, &event);
     err |= clFinish(Ctx.get_command_queues()[0]);
@@ -970,6 +1623,64 @@ void hipaccEnqueueKernel(cl_kernel kernel, size_t *global_work_size, size_t *loc
     }
     total_time += (end-start)*1.0e-3f;
     last_gpu_timing = (end-start)*1.0e-3f;
+    if (Ctx.is_profiling()) {
+        char kernel_name[256];
+        err = clGetKernelInfo(kernel, CL_KERNEL_FUNCTION_NAME, sizeof(kernel_name), kernel_name, NULL);
+        checkErr(err, "clGetKernelInfo()");
+        Ctx.profile_add(kernel_name, last_gpu_timing);
+    }
+}
+
+
+// Enqueue kernel without blocking; the kernel waits for pending operations
+// on the images it reads and writes, subsequent operations on these images
+// wait for the kernel
+cl_event hipaccEnqueueKernelAsync(cl_kernel kernel, size_t *global_work_size, size_t *local_work_size, std::vector<HipaccImage> inputs, std::vector<HipaccImage> outputs, int stream=0) {
+    cl_int err = CL_SUCCESS;
+    cl_command_queue queue = hipaccGetStream(stream);
+    cl_event event;
+    std::vector<cl_event> deps;
+
+    for (size_t i=0; i<inputs.size(); ++i) hipaccGetImageDependencies(inputs[i], false, deps);
+    for (size_t i=0; i<outputs.size(); ++i) hipaccGetImageDependencies(outputs[i], true, deps);
+
+    err = clEnqueueNDRangeKernel(queue, kernel, 2, NULL, global_work_size, local_work_size, deps.size(), deps.size() ? deps.data() : NULL, &event);
+    checkErr(err, "clEnqueueNDRangeKernel()");
+    err = clFlush(queue);
+    checkErr(err, "clFlush()");
+
+    for (size_t i=0; i<inputs.size(); ++i) hipaccAddImageEvent(inputs[i], event, false);
+    for (size_t i=0; i<outputs.size(); ++i) hipaccAddImageEvent(outputs[i], event, true);
+
+    return event;
+}
+
+
+// Set the number of streams kernels launched by hipaccEnqueueKernelConcurrent
+// are distributed to
+void hipaccSetConcurrentStreams(int num_streams) {
+    HipaccContext &Ctx = HipaccContext::getInstance();
+
+    assert(num_streams > 0 && "At least one stream required.");
+    Ctx.set_concurrent_streams(num_streams);
+}
+
+
+// Enqueue kernel without blocking, used by the generated host code: launches
+// are issued round-robin to several streams and ordered only by the images
+// they read and write. Independent launches, e.g. of different levels or
+// pyramids of a traversal, overlap on the device; this keeps the device busy
+// on small coarse levels. Blocking operations wait for all launches.
+// Launches are not batched: hipaccTraverse still issues one launch per kernel
+// and level in program order, overlapping is left to the device
+void hipaccEnqueueKernelConcurrent(cl_kernel kernel, size_t *global_work_size, size_t *local_work_size, std::vector<HipaccImage> inputs, std::vector<HipaccImage> outputs) {
+    cl_int err = CL_SUCCESS;
+    HipaccContext &Ctx = HipaccContext::getInstance();
+    cl_event event;
+
+    event = hipaccEnqueueKernelAsync(kernel, global_work_size, local_work_size, inputs, outputs, Ctx.get_concurrent_stream());
+    err = clReleaseEvent(event);
+    checkErr(err, "clReleaseEvent()");
 }
 
 
@@ -1206,19 +1917,24 @@ T hipaccApplyReductionExploration(const char *filename, const char *kernel2D,
 // Benchmark timing for a kernel call
 void hipaccEnqueueKernelBenchmark(cl_kernel kernel, std::vector<std::pair<size_t, void *> > args, size_t *global_work_size, size_t *local_work_size, bool print_timing=true) {
     float timing=FLT_MAX;
+    size_t runs = hipaccGetBenchmarkRuns();
     #ifndef GPU_TIMING
     std::vector<float> times;
-    times.reserve(HIPACC_NUM_ITERATIONS);
+    times.reserve(runs);
     #endif
 
-    for (size_t i=0; i<HIPACC_NUM_ITERATIONS; ++i) {
+    benchmark_timings.clear();
+    // first iteration is a warm-up run
+    for (size_t i=0; i<=runs; ++i) {
         // set kernel arguments
         for (size_t j=0; j<args.size(); ++j) {
             hipaccSetKernelArg(kernel, j, args.data()[j].first, args.data()[j].second);
         }
 
         // launch kernel
-        hipaccEnqueueKernel(kernel, global_work_size, local_work_size, print_timing);
+        hipaccEnqueueKernel(kernel, global_work_size, local_work_size, print_timing && i);
+        if (!i) continue;
+        benchmark_timings.push_back(last_gpu_timing);
         #ifdef GPU_TIMING
         if (last_gpu_timing < timing) timing = last_gpu_timing;
         #else
@@ -1228,7 +1944,7 @@ void hipaccEnqueueKernelBenchmark(cl_kernel kernel, std::vector<std::pair<size_t
 
     #ifndef GPU_TIMING
     std::sort(times.begin(), times.end());
-    timing = times.at(HIPACC_NUM_ITERATIONS/2);
+    timing = times.at(runs/2);
     #endif
     last_gpu_timing = timing;
     if (print_timing) {
@@ -1245,7 +1961,8 @@ void hipaccKernelExploration(const char *filename, const char *kernel,
         std::vector<std::pair<size_t, void *> > args,
         std::vector<hipacc_smem_info> smems, hipacc_launch_info &info, int
         warp_size, int max_threads_per_block, int max_threads_for_kernel, int
-        max_smem_per_block, int heu_tx, int heu_ty) {
+        max_smem_per_block, int heu_tx, int heu_ty, const char
+        *tuning_db=NULL, const char *tuning_key=NULL) {
     int opt_tx=warp_size, opt_ty=1;
     float opt_time = FLT_MAX;
 
@@ -1331,6 +2048,9 @@ void hipaccKernelExploration(const char *filename, const char *kernel,
     std::cerr << "<HIPACC:> Best configurations for kernel '" << kernel << "': "
               << opt_tx*opt_ty << " (" << opt_tx << "x" << opt_ty << "): "
               << opt_time << " ms" << std::endl;
+
+    hipaccWriteTuningRecord(tuning_db, tuning_key, info, opt_tx, opt_ty,
+                            opt_time);
 }
 
 
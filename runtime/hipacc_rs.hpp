@@ -400,6 +400,7 @@ T hipaccInitScript() {
 template<typename T>
 void hipaccWriteMemory(HipaccImage &img, T *host_mem) {
     HipaccContext &Ctx = HipaccContext::getInstance();
+    long start = Ctx.is_profiling() ? getMicroTime() : 0;
 
     int width = img.width;
     int height = img.height;
@@ -416,6 +417,11 @@ void hipaccWriteMemory(HipaccImage &img, T *host_mem) {
     } else {
         COPYFROM(T, (Allocation *)img.mem, 0, width * height, host_mem);
     }
+
+    if (Ctx.is_profiling()) {
+        Ctx.profile_add("hipaccWriteMemory", (getMicroTime() - start)*1.0e-3f,
+                        sizeof(T)*width*height);
+    }
 }
 
 
@@ -423,6 +429,7 @@ void hipaccWriteMemory(HipaccImage &img, T *host_mem) {
 template<typename T>
 void hipaccReadMemory(T *host_mem, HipaccImage &img) {
     HipaccContext &Ctx = HipaccContext::getInstance();
+    long start = Ctx.is_profiling() ? getMicroTime() : 0;
 
     int width = img.width;
     int height = img.height;
@@ -439,6 +446,11 @@ void hipaccReadMemory(T *host_mem, HipaccImage &img) {
     } else {
         COPYTO(T, (Allocation *)img.mem, 0, width * height, host_mem);
     }
+
+    if (Ctx.is_profiling()) {
+        Ctx.profile_add("hipaccReadMemory", (getMicroTime() - start)*1.0e-3f,
+                        sizeof(T)*width*height);
+    }
 }
 
 
@@ -595,7 +607,8 @@ template<typename F>
 void hipaccLaunchScriptKernel(
     F* script,
     KERNEL1(F, kernel),
-    HipaccImage &out, size_t *work_size, bool print_timing=true
+    HipaccImage &out, size_t *work_size, bool print_timing=true,
+    const char *kernel_name=NULL
 ) {
     long end, start;
     HipaccContext &Ctx = HipaccContext::getInstance();
@@ -614,6 +627,9 @@ void hipaccLaunchScriptKernel(
     }
     total_time += (end - start) * 1.0e-3f;
     last_gpu_timing = (end - start) * 1.0e-3f;
+    if (Ctx.is_profiling() && kernel_name) {
+        Ctx.profile_add(kernel_name, last_gpu_timing);
+    }
 }
 
 
@@ -622,7 +638,8 @@ template<typename F>
 void hipaccLaunchScriptKernel(
     F* script,
     KERNEL2(F, kernel),
-    HipaccImage &in, HipaccImage &out, size_t *work_size, bool print_timing=true
+    HipaccImage &in, HipaccImage &out, size_t *work_size, bool print_timing=true,
+    const char *kernel_name=NULL
 ) {
     long end, start;
     HipaccContext &Ctx = HipaccContext::getInstance();
@@ -641,6 +658,9 @@ void hipaccLaunchScriptKernel(
     }
     total_time += (end - start) * 1.0e-3f;
     last_gpu_timing = (end - start) * 1.0e-3f;
+    if (Ctx.is_profiling() && kernel_name) {
+        Ctx.profile_add(kernel_name, last_gpu_timing);
+    }
 }
 
 
@@ -654,9 +674,12 @@ void hipaccLaunchScriptKernelBenchmark(
     bool print_timing=true
 ) {
     float med_dt;
+    size_t runs = hipaccGetBenchmarkRuns();
     std::vector<float> times;
 
-    for (size_t i=0; i<HIPACC_NUM_ITERATIONS; ++i) {
+    benchmark_timings.clear();
+    // first iteration is a warm-up run
+    for (size_t i=0; i<=runs; ++i) {
         // set kernel arguments
         for (typename std::vector<hipacc_script_arg<F> >::const_iterator
                 it = args.begin(); it != args.end(); ++it) {
@@ -664,11 +687,13 @@ void hipaccLaunchScriptKernelBenchmark(
         }
 
         // launch kernel
-        hipaccLaunchScriptKernel(script, kernel, out, work_size, print_timing);
+        hipaccLaunchScriptKernel(script, kernel, out, work_size, print_timing && i);
+        if (!i) continue;
         times.push_back(last_gpu_timing);
     }
+    benchmark_timings = times;
     std::sort(times.begin(), times.end());
-    med_dt = times.at(HIPACC_NUM_ITERATIONS/2);
+    med_dt = times.at(runs/2);
 
     last_gpu_timing = med_dt;
     if (print_timing) {
@@ -34,12 +34,18 @@ ifge = $(shell if [ $(1) -ge $(2) ]; then echo true; else echo false; fi)
 # Source-to-source compiler configuration
 # use local memory -> set HIPACC_LMEM to off|on
 # use texture memory -> set HIPACC_TEX to off|Linear1D|Linear2D|Array2D
-# vectorize code (experimental, doesn't work) -> set HIPACC_VEC to off|on
+# vectorize code (experimental for CUDA/OpenCL) -> set HIPACC_VEC to off|on
+#   or for C++ to emit hints for the instruction set: sse4.2|avx|avx2|avx512
 # pad images to a multiple of n bytes -> set HIPACC_PAD to n
 # map n output pixels to one thread -> set HIPACC_PPT to n
 # use specific configuration for kernels -> set HIPACC_CONFIG to nxm
 # generate code that explores configuration -> set HIPACC_EXPLORE to off|on
 # generate code that times kernel execution -> set HIPACC_TIMING to off|on
+# execute C++ kernels using multiple threads -> set HIPACC_THREADS to n|auto
+# interleave consecutive producer/consumer C++ kernels on bands of rows -> set HIPACC_FUSE to off|on|stream
+# evaluate kernels only at the pixels kept by a subsampling consumer -> set HIPACC_FUSE_SAMPLING to off|on
+# launch OpenCL kernels on multiple command queues -> set HIPACC_CONCURRENT to off|on
+# overlap OpenCL transfers and kernels on multiple command queues -> set HIPACC_ASYNC to off|on
 HIPACC_LMEM?=off
 HIPACC_TEX?=off
 HIPACC_VEC?=off
@@ -75,18 +81,115 @@ endif
 ifeq ($(HIPACC_TIMING),on)
     HIPACC_OPTS+= -time-kernels
 endif
+ifdef HIPACC_THREADS
+    HIPACC_CPU_OPTS+= -threads $(HIPACC_THREADS)
+endif
+ifdef HIPACC_FUSE
+    HIPACC_CPU_OPTS+= -fuse $(HIPACC_FUSE)
+endif
+ifdef HIPACC_FUSE_SAMPLING
+    HIPACC_OPTS+= -fuse-sampling $(HIPACC_FUSE_SAMPLING)
+endif
+ifdef HIPACC_CONCURRENT
+    HIPACC_OPTS+= -concurrent-kernels $(HIPACC_CONCURRENT)
+endif
+ifdef HIPACC_ASYNC
+    HIPACC_OPTS+= -async-transfers $(HIPACC_ASYNC)
+endif
 
 # set target GPU architecture to the compute capability encoded in target
 GPU_ARCH := $(shell echo $(HIPACC_TARGET) |cut -f2 -d-)
 
 
+# Benchmark configuration
+# run test cases for all image sizes (WIDTHxHEIGHT) and window sizes using
+# timed kernels (warm-up plus repeated runs) on target BENCHMARK_TARGET;
+# results are appended to BENCHMARK_OUT as CSV (*.csv) or JSON (one object
+# per line). Two CSV results are compared using
+#   make benchmark-compare BENCHMARK_BASE=old.csv BENCHMARK_OUT=new.csv
+# which fails if a kernel got slower by more than BENCHMARK_THRESHOLD percent;
+# each kernel is timed BENCHMARK_RUNS times (at least 20)
+BENCHMARK_TARGET    ?= cpu
+BENCHMARK_CASES     ?= opencv_blur_8uc1 opencv_blur_8uc4 opencv_box_8uc4 \
+                       opencv_dilate_8uc1 opencv_erode_8uc1 \
+                       opencv_gaussian_8uc1 opencv_gaussian_8uc4 \
+                       opencv_laplace_8uc1 opencv_sobel_8uc1 \
+                       opencv_sobel_8uc4 opencv_sobel_32fc1 \
+                       bilateral_filter memory_bound_operators
+BENCHMARK_SIZES     ?= 512x512 2048x2048 4096x4096
+BENCHMARK_WINDOWS   ?= 3 5 7
+BENCHMARK_OUT       ?= benchmark.csv
+BENCHMARK_THRESHOLD ?= 5
+BENCHMARK_RUNS      ?= 100
+
+
+# Check configuration
+# run test cases that cover the code generation paths of the C++ back end and
+# the runtime; each entry is <target>:<case>[:<VAR>=<value>[,...]], where the
+# variables select the options of the path, e.g. cpu:box_filter:HIPACC_VEC=avx
+# Each test case compares its output against a reference computed on the host;
+# target dsl runs the test case on the DSL headers, serially unless
+# HIPACC_NUM_THREADS selects the number of row bands; the image size is set by
+# CHECK_WIDTH and CHECK_HEIGHT, which entries may override
+# CHECK_CASES are run by target check. CHECK_CODEGEN_CASES are run by target
+# check-codegen and need an installed compiler and the respective device; they
+# move to CHECK_CASES once they have been run successfully
+CHECK_CASES ?= dsl:kernel_fusion \
+               dsl:kernel_fusion:HIPACC_NUM_THREADS=4 \
+               dsl:separable_filter \
+               dsl:median_filter \
+               dsl:box_filter \
+               dsl:reduction_fusion \
+               dsl:reduction_fusion:HIPACC_NUM_THREADS=4 \
+               dsl:gaussian_pyramid \
+               dsl:gaussian_pyramid:HIPACC_NUM_THREADS=4 \
+               dsl:gaussian_laplacian_pyramid \
+               dsl:subsample_fusion \
+               dsl:opencv_blur_8uc1 \
+               dsl:opencv_blur_8uc1:HIPACC_NUM_THREADS=auto \
+               dsl:opencv_blur_8uc1:CHECK_WIDTH=640,CHECK_HEIGHT=480
+CHECK_CODEGEN_CASES ?= cpu:subsample_fusion \
+                       cpu:subsample_fusion:HIPACC_FUSE_SAMPLING=on \
+                       cpu:reduction_fusion \
+                       cpu:reduction_fusion:HIPACC_FUSE=on \
+                       cpu:reduction_fusion:HIPACC_FUSE=stream,HIPACC_THREADS=4 \
+                       cpu:gaussian_pyramid \
+                       cpu:gaussian_pyramid:HIPACC_THREADS=4 \
+                       opencl-gpu:kernel_fusion:HIPACC_CONCURRENT=on \
+                       opencl-gpu:gaussian_pyramid:HIPACC_CONCURRENT=on \
+                       cpu:kernel_fusion \
+                       cpu:kernel_fusion:HIPACC_FUSE=on \
+                       cpu:kernel_fusion:HIPACC_FUSE=stream,HIPACC_THREADS=4 \
+                       opencl-gpu:kernel_fusion:HIPACC_ASYNC=on \
+                       opencl-gpu:memory_assignment:HIPACC_ASYNC=on \
+                       cpu:separable_filter \
+                       cpu:separable_filter:HIPACC_THREADS=4 \
+                       cpu:median_filter \
+                       cpu:box_filter \
+                       cpu:box_filter:HIPACC_THREADS=4 \
+                       cpu:opencv_blur_8uc1:HIPACC_VEC=avx2 \
+                       cpu:opencv_gaussian_8uc4:HIPACC_VEC=sse4.2 \
+                       cpu:opencv_sobel_32fc1:HIPACC_VEC=avx \
+                       cpu:opencv_blur_8uc1:CHECK_WIDTH=640,CHECK_HEIGHT=480 \
+                       cpu:opencv_blur_8uc1:HIPACC_VEC=avx2,CHECK_WIDTH=640,CHECK_HEIGHT=480
+CHECK_WIDTH  ?= 500
+CHECK_HEIGHT ?= 500
+CHECK_FLAGS  ?= -DSIZE_X=5 -DSIZE_Y=5
+
+
 all:
 run:
 	$(COMPILER) $(TEST_CASE)/main.cpp $(MYFLAGS) $(COMPILER_INC)
 
+dsl:
+	@echo 'Compiling DSL file using g++:'
+	$(OCL_CC) -I$(HIPACC_DIR)/include/dsl -I$(TEST_CASE) $(MYFLAGS) $(OFLAGS) -o main_dsl $(TEST_CASE)/main.cpp -lm -lstdc++ -lpthread
+	@echo 'Executing DSL binary'
+	./main_dsl
+
 cpu:
 	@echo 'Executing HIPAcc Compiler for C++:'
-	$(COMPILER) $(TEST_CASE)/main.cpp $(MYFLAGS) $(COMPILER_INC) -emit-cpu $(HIPACC_OPTS) -o main.cc
+	$(COMPILER) $(TEST_CASE)/main.cpp $(MYFLAGS) $(COMPILER_INC) -emit-cpu $(HIPACC_OPTS) $(HIPACC_CPU_OPTS) -o main.cc
 	@echo 'Compiling C++ file using g++:'
 	$(OCL_CC) -I$(HIPACC_DIR)/include -I$(TEST_CASE) $(MYFLAGS) $(OFLAGS) -o main_cpu main.cc -lm -ldl -lstdc++ -lpthread @TIME_LINK@
 	@echo 'Executing C++ binary'
@@ -134,6 +237,50 @@ else
 	cp build_$@/main_renderscript ./main_$@
 endif
 
+benchmark:
+	@for case in $(BENCHMARK_CASES); do \
+	    for size in $(BENCHMARK_SIZES); do \
+	        for win in $(BENCHMARK_WINDOWS); do \
+	            width=`echo $$size |cut -f1 -dx`; \
+	            height=`echo $$size |cut -f2 -dx`; \
+	            HIPACC_BENCHMARK=$(abspath $(BENCHMARK_OUT)) \
+	            HIPACC_BENCHMARK_CASE=$$case-$$size-$$win"x"$$win \
+	            HIPACC_BENCHMARK_RUNS=$(BENCHMARK_RUNS) \
+	            $(MAKE) --no-print-directory $(BENCHMARK_TARGET) \
+	                TEST_CASE=./tests/$$case HIPACC_TIMING=on \
+	                MYFLAGS="-DWIDTH=$$width -DHEIGHT=$$height -DSIZE_X=$$win -DSIZE_Y=$$win" \
+	                || exit 1; \
+	        done; \
+	    done; \
+	done
+
+check:
+	@for entry in $(CHECK_CASES); do \
+	    target=`echo $$entry |cut -f1 -d:`; \
+	    case=`echo $$entry |cut -f2 -d:`; \
+	    opts=`echo $$entry |cut -s -f3 -d: |tr ',' ' '`; \
+	    echo "Checking $$case on $$target $$opts"; \
+	    $(MAKE) --no-print-directory $$target TEST_CASE=./tests/$$case \
+	        MYFLAGS='-DWIDTH=$$(CHECK_WIDTH) -DHEIGHT=$$(CHECK_HEIGHT) $(CHECK_FLAGS)' \
+	        $$opts || exit 1; \
+	done
+
+check-codegen:
+	@$(MAKE) --no-print-directory check CHECK_CASES="$(CHECK_CODEGEN_CASES)"
+
+benchmark-compare:
+	@awk -F, -v threshold=$(BENCHMARK_THRESHOLD) ' \
+	    FNR == 1 { next } \
+	    NR == FNR { base[$$1 "," $$2] = $$7; next } \
+	    ($$1 "," $$2) in base { \
+	        diff = ($$7 / base[$$1 "," $$2] - 1) * 100; \
+	        printf "%-40s %-40s %10.4f ms %10.4f ms %+7.1f%%", \
+	               $$1, $$2, base[$$1 "," $$2], $$7, diff; \
+	        if (diff > threshold) { printf "  REGRESSION"; ++regressions } \
+	        printf "\n" \
+	    } \
+	    END { exit regressions > 0 }' $(BENCHMARK_BASE) $(BENCHMARK_OUT)
+
 clean:
 	rm -f main_* *.cu *.cc *.cubin *.cl *.isa *.rs *.fs
 	rm -rf build_*
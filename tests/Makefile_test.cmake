@@ -6,7 +6,7 @@ HIPACC_DIR   ?= @CMAKE_INSTALL_PREFIX@
 MYFLAGS      ?= -D WIDTH=2048 -D HEIGHT=2048 -D SIZE_X=5 -D SIZE_Y=5
 CFLAGS        = $(MYFLAGS) -Wall -Wunused \
                 -I$(HIPACC_DIR)/include/dsl
-LDFLAGS       = -lm
+LDFLAGS       = -lm -lpthread
 OFLAGS        = -O3
 
 ifeq ($(CC),clang++)
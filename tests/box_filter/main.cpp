@@ -0,0 +1,221 @@
+//
+// Copyright (c) 2013, University of Erlangen-Nuremberg
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hipacc.hpp"
+
+// variables set by Makefile
+//#define WIDTH 4096
+//#define HEIGHT 4096
+#define EPS 0.01f
+
+using namespace hipacc;
+
+
+// clamp access to the image for the reference
+int get_clamped(int *img, int x, int y, int width, int height) {
+    x = x < 0 ? 0 : (x >= width ? width-1 : x);
+    y = y < 0 ? 0 : (y >= height ? height-1 : y);
+    return img[y*width + x];
+}
+
+
+// sum over a constant Domain: computed using running sums
+class BoxReduce : public Kernel<int> {
+  private:
+    Accessor<int> &input;
+    Domain &dom;
+
+  public:
+    BoxReduce(IterationSpace<int> &iter, Accessor<int> &input, Domain &dom)
+        : Kernel(iter),
+          input(input),
+          dom(dom) {
+      addAccessor(&input);
+    }
+
+    void kernel() {
+      output() = reduce(dom, HipaccSUM, [&] () -> int {
+        return input(dom);
+      });
+    }
+};
+
+// convolution with uniform weights: computed using running sums
+class BoxConvolve : public Kernel<int> {
+  private:
+    Accessor<int> &input;
+    Mask<int> &mask;
+
+  public:
+    BoxConvolve(IterationSpace<int> &iter, Accessor<int> &input,
+                Mask<int> &mask)
+        : Kernel(iter),
+          input(input),
+          mask(mask) {
+      addAccessor(&input);
+    }
+
+    void kernel() {
+      output() = convolve(mask, HipaccSUM, [&] () -> int {
+        return mask() * input(mask);
+      });
+    }
+};
+
+// sum of floating-point values: running sums would accumulate rounding
+// errors, hence the Domain is unrolled
+class BoxFloat : public Kernel<float> {
+  private:
+    Accessor<float> &input;
+    Domain &dom;
+
+  public:
+    BoxFloat(IterationSpace<float> &iter, Accessor<float> &input, Domain &dom)
+        : Kernel(iter),
+          input(input),
+          dom(dom) {
+      addAccessor(&input);
+    }
+
+    void kernel() {
+      output() = reduce(dom, HipaccSUM, [&] () -> float {
+        return input(dom);
+      });
+    }
+};
+
+
+/*************************************************************************
+ * Main function                                                         *
+ *************************************************************************/
+int main(int argc, const char **argv) {
+    const int width = WIDTH;
+    const int height = HEIGHT;
+
+    // uniform mask: weights of 3 for each pixel
+    const int filter_xy[5][5] = {
+        { 3, 3, 3, 3, 3 },
+        { 3, 3, 3, 3, 3 },
+        { 3, 3, 3, 3, 3 },
+        { 3, 3, 3, 3, 3 },
+        { 3, 3, 3, 3, 3 }
+    };
+
+    // host memory for image of width x height pixels
+    int *host_in = (int *)malloc(sizeof(int)*width*height);
+    int *host_out = (int *)malloc(sizeof(int)*width*height);
+    float *host_in_f = (float *)malloc(sizeof(float)*width*height);
+    float *host_out_f = (float *)malloc(sizeof(float)*width*height);
+
+    // initialize data
+    for (int y=0; y<height; ++y) {
+        for (int x=0; x<width; ++x) {
+            host_in[y*width + x] = (y*width + x) % 251;
+            host_out[y*width + x] = 0;
+            host_in_f[y*width + x] = (float)host_in[y*width + x] * 0.5f;
+            host_out_f[y*width + x] = 0.0f;
+        }
+    }
+
+    // input and output images of width x height pixels
+    Image<int> IN(width, height);
+    Image<int> OUT1(width, height);
+    Image<int> OUT2(width, height);
+    Image<float> IN_F(width, height);
+    Image<float> OUT_F(width, height);
+    Domain D(5, 5);
+    Mask<int> M(filter_xy);
+
+    IN = host_in;
+    OUT1 = host_out;
+    OUT2 = host_out;
+    IN_F = host_in_f;
+    OUT_F = host_out_f;
+
+    BoundaryCondition<int> BC(IN, D, BOUNDARY_CLAMP);
+    Accessor<int> AccIn(BC);
+    BoundaryCondition<float> BCF(IN_F, D, BOUNDARY_CLAMP);
+    Accessor<float> AccInF(BCF);
+
+    fprintf(stderr, "Calculating HIPAcc box filters ...\n");
+
+    IterationSpace<int> IS1(OUT1);
+    BoxReduce BR(IS1, AccIn, D);
+    BR.execute();
+
+    IterationSpace<int> IS2(OUT2);
+    BoxConvolve BV(IS2, AccIn, M);
+    BV.execute();
+
+    IterationSpace<float> ISF(OUT_F);
+    BoxFloat BF(ISF, AccInF, D);
+    BF.execute();
+
+    int *out1 = OUT1.getData();
+    int *out2 = OUT2.getData();
+    float *out_f = OUT_F.getData();
+
+
+    fprintf(stderr, "\nComparing results ...\n");
+    for (int y=0; y<height; ++y) {
+        for (int x=0; x<width; ++x) {
+            int sum = 0;
+            for (int yf=-2; yf<=2; ++yf) {
+                for (int xf=-2; xf<=2; ++xf) {
+                    sum += get_clamped(host_in, x+xf, y+yf, width, height);
+                }
+            }
+            if (sum != out1[y*width + x]) {
+                fprintf(stderr, "Test FAILED for reduce, at (%d,%d): %d vs. %d\n",
+                        x, y, sum, out1[y*width + x]);
+                exit(EXIT_FAILURE);
+            }
+            if (3*sum != out2[y*width + x]) {
+                fprintf(stderr, "Test FAILED for convolve, at (%d,%d): %d vs. %d\n",
+                        x, y, 3*sum, out2[y*width + x]);
+                exit(EXIT_FAILURE);
+            }
+            if (fabs(0.5f*sum - out_f[y*width + x]) > EPS) {
+                fprintf(stderr, "Test FAILED for float, at (%d,%d): %f vs. %f\n",
+                        x, y, 0.5f*sum, out_f[y*width + x]);
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+    fprintf(stderr, "Test PASSED\n");
+
+    // memory cleanup
+    free(host_in);
+    free(host_out);
+    free(host_in_f);
+    free(host_out_f);
+
+    return EXIT_SUCCESS;
+}
@@ -256,13 +256,14 @@ int main(int argc, const char **argv) {
         }
     });
 
-    host_out = GAUS.getData();
+    // the data is owned by the image, do not free it
+    char *out = GAUS.getData();
 
     for (int y = 0; y < height; ++y) {
       for (int x = 0; x < width; ++x) {
-        if (host_in[y*height+x] != host_out[y*height+x]) {
+        if (host_in[y*width + x] != out[y*width + x]) {
           fprintf(stderr, "Test FAILED, at (%d,%d): %hhu vs. %hhu\n",
-                  x, y, host_in[y*width + x], host_out[y*width + x]);
+                  x, y, host_in[y*width + x], out[y*width + x]);
           exit(EXIT_FAILURE);
         }
       }
@@ -0,0 +1,238 @@
+//
+// Copyright (c) 2013, University of Erlangen-Nuremberg
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "hipacc.hpp"
+
+// variables set by Makefile
+//#define WIDTH 4096
+//#define HEIGHT 4096
+#define DEPTH 4
+
+using namespace hipacc;
+
+
+// 3x3 blur with integer weights
+class Blur : public Kernel<int> {
+  private:
+    Accessor<int> &input;
+
+  public:
+    Blur(IterationSpace<int> &iter, Accessor<int> &input)
+        : Kernel(iter),
+          input(input) {
+      addAccessor(&input);
+    }
+
+    void kernel() {
+      output() = (4*input() + input(-1, 0) + input(1, 0) + input(0, -1) +
+                  input(0, 1)) / 8;
+    }
+};
+
+class Copy : public Kernel<int> {
+  private:
+    Accessor<int> &input;
+
+  public:
+    Copy(IterationSpace<int> &iter, Accessor<int> &input)
+        : Kernel(iter),
+          input(input) {
+      addAccessor(&input);
+    }
+
+    void kernel() {
+      output() = input();
+    }
+};
+
+class Average : public Kernel<int> {
+  private:
+    Accessor<int> &input1;
+    Accessor<int> &input2;
+
+  public:
+    Average(IterationSpace<int> &iter, Accessor<int> &input1,
+            Accessor<int> &input2)
+        : Kernel(iter),
+          input1(input1),
+          input2(input2) {
+      addAccessor(&input1);
+      addAccessor(&input2);
+    }
+
+    void kernel() {
+      output() = (input1() + input2()) / 2;
+    }
+};
+
+
+// clamp access to a pyramid level for the reference
+int get_clamped(std::vector<int> &img, int x, int y, int width, int height) {
+    x = x < 0 ? 0 : (x >= width ? width-1 : x);
+    y = y < 0 ? 0 : (y >= height ? height-1 : y);
+    return img[y*width + x];
+}
+
+// nearest neighbor access to a pyramid level, mapped like AccessorNN
+int get_nn(std::vector<int> &img, int x, int y, int width, int height,
+           int is_width, int is_height) {
+    int x_mapped = (int)((width/(float)is_width) * x);
+    int y_mapped = (int)((height/(float)is_height) * y);
+    return get_clamped(img, x_mapped, y_mapped, width, height);
+}
+
+
+/*************************************************************************
+ * Main function                                                         *
+ *************************************************************************/
+int main(int argc, const char **argv) {
+    const int width = WIDTH;
+    const int height = HEIGHT;
+
+    // host memory for image of width x height pixels
+    int *host_in = (int *)malloc(sizeof(int)*width*height);
+    int *host_out = (int *)malloc(sizeof(int)*width*height);
+
+    // initialize data
+    for (int y=0; y<height; ++y) {
+        for (int x=0; x<width; ++x) {
+            host_in[y*width + x] = (y*width + x) % 251;
+            host_out[y*width + x] = 0;
+        }
+    }
+
+    // input and output images of width x height pixels
+    Image<int> GAUS(width, height);
+    Image<int> TMP(width, height);
+    Image<int> RES(width, height);
+
+    GAUS = host_in;
+    TMP = host_out;
+    RES = host_out;
+
+    Pyramid<int> PGAUS(GAUS, DEPTH);
+    Pyramid<int> PTMP(TMP, DEPTH);
+    Pyramid<int> PRES(RES, DEPTH);
+
+    fprintf(stderr, "Calculating HIPAcc pyramid ...\n");
+
+    traverse(PGAUS, PTMP, PRES, [&] () {
+        if (!PGAUS.isTopLevel()) {
+          // blur the finer level and subsample it
+          BoundaryCondition<int> BC(PGAUS(-1), 3, 3, BOUNDARY_CLAMP);
+          Accessor<int> Acc1(BC);
+          IterationSpace<int> IS1(PTMP(-1));
+          Blur B(IS1, Acc1);
+          B.execute();
+
+          AccessorNN<int> Acc2(PTMP(-1));
+          IterationSpace<int> IS2(PGAUS(0));
+          Copy Sub(IS2, Acc2);
+          Sub.execute();
+        }
+
+        traverse();
+
+        if (PGAUS.isBottomLevel()) {
+          Accessor<int> Acc1(PGAUS(0));
+          IterationSpace<int> IS(PRES(0));
+          Copy C(IS, Acc1);
+          C.execute();
+        } else {
+          // average the level with the upsampled coarser level
+          Accessor<int> Acc1(PGAUS(0));
+          AccessorNN<int> Acc2(PRES(1));
+          IterationSpace<int> IS(PRES(0));
+          Average A(IS, Acc1, Acc2);
+          A.execute();
+        }
+    });
+
+    int *out = RES.getData();
+
+
+    fprintf(stderr, "\nCalculating reference ...\n");
+    std::vector<std::vector<int> > gaus(DEPTH), res(DEPTH);
+    std::vector<int> widths(DEPTH), heights(DEPTH);
+    widths[0] = width;
+    heights[0] = height;
+    gaus[0].assign(host_in, host_in + width*height);
+    for (int l=1; l<DEPTH; ++l) {
+        int pw = widths[l-1], ph = heights[l-1];
+        int w = widths[l] = pw/2;
+        int h = heights[l] = ph/2;
+        std::vector<int> tmp(pw*ph);
+        for (int y=0; y<ph; ++y) {
+            for (int x=0; x<pw; ++x) {
+                tmp[y*pw + x] = (4*gaus[l-1][y*pw + x] +
+                    get_clamped(gaus[l-1], x-1, y, pw, ph) +
+                    get_clamped(gaus[l-1], x+1, y, pw, ph) +
+                    get_clamped(gaus[l-1], x, y-1, pw, ph) +
+                    get_clamped(gaus[l-1], x, y+1, pw, ph)) / 8;
+            }
+        }
+        gaus[l].resize(w*h);
+        for (int y=0; y<h; ++y) {
+            for (int x=0; x<w; ++x) {
+                gaus[l][y*w + x] = get_nn(tmp, x, y, pw, ph, w, h);
+            }
+        }
+    }
+    res[DEPTH-1] = gaus[DEPTH-1];
+    for (int l=DEPTH-2; l>=0; --l) {
+        int w = widths[l], h = heights[l];
+        res[l].resize(w*h);
+        for (int y=0; y<h; ++y) {
+            for (int x=0; x<w; ++x) {
+                res[l][y*w + x] = (gaus[l][y*w + x] +
+                    get_nn(res[l+1], x, y, widths[l+1], heights[l+1], w, h)) /
+                    2;
+            }
+        }
+    }
+
+    fprintf(stderr, "\nComparing results ...\n");
+    for (int y=0; y<height; ++y) {
+        for (int x=0; x<width; ++x) {
+            if (res[0][y*width + x] != out[y*width + x]) {
+                fprintf(stderr, "Test FAILED, at (%d,%d): %d vs. %d\n",
+                        x, y, res[0][y*width + x], out[y*width + x]);
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+    fprintf(stderr, "Test PASSED\n");
+
+    // memory cleanup
+    free(host_in);
+    free(host_out);
+
+    return EXIT_SUCCESS;
+}
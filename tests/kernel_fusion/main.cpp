@@ -0,0 +1,234 @@
+//
+// Copyright (c) 2013, University of Erlangen-Nuremberg
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hipacc.hpp"
+
+// variables set by Makefile
+//#define WIDTH 4096
+//#define HEIGHT 4096
+
+using namespace hipacc;
+
+
+// clamp access to the image for the reference
+int get_clamped(int *img, int x, int y, int width, int height) {
+    x = x < 0 ? 0 : (x >= width ? width-1 : x);
+    y = y < 0 ? 0 : (y >= height ? height-1 : y);
+    return img[y*width + x];
+}
+
+
+// point operator producing the image of the first kernel pair
+class Scale : public Kernel<int> {
+  private:
+    Accessor<int> &input;
+
+  public:
+    Scale(IterationSpace<int> &iter, Accessor<int> &input)
+        : Kernel(iter),
+          input(input) {
+      addAccessor(&input);
+    }
+
+    void kernel() {
+      output() = 3*input() + 1;
+    }
+};
+
+// local operator producing the image of the second kernel pair
+class Blur : public Kernel<int> {
+  private:
+    Accessor<int> &input;
+
+  public:
+    Blur(IterationSpace<int> &iter, Accessor<int> &input)
+        : Kernel(iter),
+          input(input) {
+      addAccessor(&input);
+    }
+
+    void kernel() {
+      output() = (input(-1, -1) + input(0, -1) + input(1, -1) +
+                  input(-1,  0) + input(0,  0) + input(1,  0) +
+                  input(-1,  1) + input(0,  1) + input(1,  1)) / 9;
+    }
+};
+
+// local operator consuming the output of a producer with a halo of two rows
+class Laplace : public Kernel<int> {
+  private:
+    Accessor<int> &input;
+
+  public:
+    Laplace(IterationSpace<int> &iter, Accessor<int> &input)
+        : Kernel(iter),
+          input(input) {
+      addAccessor(&input);
+    }
+
+    void kernel() {
+      output() = input(0, -2) + input(-2, 0) + input(2, 0) + input(0, 2) -
+                 4*input();
+    }
+};
+
+
+/*************************************************************************
+ * Main function                                                         *
+ *************************************************************************/
+int main(int argc, const char **argv) {
+    const int width = WIDTH;
+    const int height = HEIGHT;
+
+    // host memory for image of width x height pixels
+    int *host_in = (int *)malloc(sizeof(int)*width*height);
+    int *host_out = (int *)malloc(sizeof(int)*width*height);
+    int *reference_tmp = (int *)malloc(sizeof(int)*width*height);
+    int *reference_out1 = (int *)malloc(sizeof(int)*width*height);
+    int *reference_out2 = (int *)malloc(sizeof(int)*width*height);
+
+    // initialize data
+    for (int y=0; y<height; ++y) {
+        for (int x=0; x<width; ++x) {
+            host_in[y*width + x] = (y*width + x) % 251;
+            host_out[y*width + x] = 0;
+        }
+    }
+
+    // input and output images of width x height pixels; the intermediate
+    // images are only referenced by the producers and consumers, so that
+    // fusion may keep them in line buffers
+    Image<int> IN(width, height);
+    Image<int> TMP1(width, height);
+    Image<int> TMP2(width, height);
+    Image<int> OUT1(width, height);
+    Image<int> OUT2(width, height);
+
+    IN = host_in;
+    OUT1 = host_out;
+    OUT2 = host_out;
+
+    fprintf(stderr, "Calculating HIPAcc fused kernels ...\n");
+
+    // point operator followed by a local operator
+    Accessor<int> AccIn1(IN);
+    IterationSpace<int> IS1(TMP1);
+    Scale S(IS1, AccIn1);
+    S.execute();
+
+    BoundaryCondition<int> BC1(TMP1, 3, 3, BOUNDARY_CLAMP);
+    Accessor<int> AccTmp1(BC1);
+    IterationSpace<int> IS2(OUT1);
+    Blur B1(IS2, AccTmp1);
+    B1.execute();
+
+    // local operator followed by a local operator
+    BoundaryCondition<int> BC2(IN, 3, 3, BOUNDARY_CLAMP);
+    Accessor<int> AccIn2(BC2);
+    IterationSpace<int> IS3(TMP2);
+    Blur B2(IS3, AccIn2);
+    B2.execute();
+
+    BoundaryCondition<int> BC3(TMP2, 5, 5, BOUNDARY_MIRROR);
+    Accessor<int> AccTmp2(BC3);
+    IterationSpace<int> IS4(OUT2);
+    Laplace L(IS4, AccTmp2);
+    L.execute();
+
+    int *out1 = OUT1.getData();
+    int *out2 = OUT2.getData();
+
+
+    fprintf(stderr, "\nCalculating reference ...\n");
+    for (int y=0; y<height; ++y) {
+        for (int x=0; x<width; ++x) {
+            reference_tmp[y*width + x] = 3*host_in[y*width + x] + 1;
+        }
+    }
+    for (int y=0; y<height; ++y) {
+        for (int x=0; x<width; ++x) {
+            int sum = 0;
+            for (int yf=-1; yf<=1; ++yf) {
+                for (int xf=-1; xf<=1; ++xf) {
+                    sum += get_clamped(reference_tmp, x+xf, y+yf, width, height);
+                }
+            }
+            reference_out1[y*width + x] = sum / 9;
+        }
+    }
+    for (int y=0; y<height; ++y) {
+        for (int x=0; x<width; ++x) {
+            int sum = 0;
+            for (int yf=-1; yf<=1; ++yf) {
+                for (int xf=-1; xf<=1; ++xf) {
+                    sum += get_clamped(host_in, x+xf, y+yf, width, height);
+                }
+            }
+            reference_tmp[y*width + x] = sum / 9;
+        }
+    }
+    for (int y=0; y<height; ++y) {
+        for (int x=0; x<width; ++x) {
+            // mirror at the image border
+            int xl = x-2 < 0 ? 1-x : x-2;
+            int xr = x+2 >= width ? 2*width-1-(x+2) : x+2;
+            int yt = y-2 < 0 ? 1-y : y-2;
+            int yb = y+2 >= height ? 2*height-1-(y+2) : y+2;
+            reference_out2[y*width + x] = reference_tmp[yt*width + x] +
+                reference_tmp[y*width + xl] + reference_tmp[y*width + xr] +
+                reference_tmp[yb*width + x] - 4*reference_tmp[y*width + x];
+        }
+    }
+
+    fprintf(stderr, "\nComparing results ...\n");
+    for (int y=0; y<height; ++y) {
+        for (int x=0; x<width; ++x) {
+            if (reference_out1[y*width + x] != out1[y*width + x]) {
+                fprintf(stderr, "Test FAILED for point/local fusion, at (%d,%d): %d vs. %d\n",
+                        x, y, reference_out1[y*width + x], out1[y*width + x]);
+                exit(EXIT_FAILURE);
+            }
+            if (reference_out2[y*width + x] != out2[y*width + x]) {
+                fprintf(stderr, "Test FAILED for local/local fusion, at (%d,%d): %d vs. %d\n",
+                        x, y, reference_out2[y*width + x], out2[y*width + x]);
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+    fprintf(stderr, "Test PASSED\n");
+
+    // memory cleanup
+    free(host_in);
+    free(host_out);
+    free(reference_tmp);
+    free(reference_out1);
+    free(reference_out2);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,163 @@
+//
+// Copyright (c) 2013, University of Erlangen-Nuremberg
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "hipacc.hpp"
+
+// variables set by Makefile
+//#define WIDTH 4096
+//#define HEIGHT 4096
+
+using namespace hipacc;
+
+
+// mirror access to the image for the reference
+uchar get_mirrored(uchar *img, int x, int y, int width, int height) {
+    if (x < 0) x = -x - 1;
+    if (y < 0) y = -y - 1;
+    if (x >= width) x = 2*width - x - 1;
+    if (y >= height) y = 2*height - y - 1;
+    return img[y*width + x];
+}
+
+// median of a size x size window around (x, y)
+uchar median_ref(uchar *img, int x, int y, int size, int width, int height) {
+    std::vector<uchar> values;
+    for (int yf=-size/2; yf<=size/2; ++yf) {
+        for (int xf=-size/2; xf<=size/2; ++xf) {
+            values.push_back(get_mirrored(img, x+xf, y+yf, width, height));
+        }
+    }
+    std::nth_element(values.begin(), values.begin() + values.size()/2,
+                     values.end());
+    return values[values.size()/2];
+}
+
+
+// median over a constant Domain: sorting network for small windows,
+// histogram for windows with more than 25 taps
+class MedianFilter : public Kernel<uchar> {
+  private:
+    Accessor<uchar> &input;
+    Domain &dom;
+
+  public:
+    MedianFilter(IterationSpace<uchar> &iter, Accessor<uchar> &input,
+                 Domain &dom)
+        : Kernel(iter),
+          input(input),
+          dom(dom) {
+      addAccessor(&input);
+    }
+
+    void kernel() {
+      output() = reduce(dom, HipaccMEDIAN, [&] () -> uchar {
+        return input(dom);
+      });
+    }
+};
+
+
+/*************************************************************************
+ * Main function                                                         *
+ *************************************************************************/
+int main(int argc, const char **argv) {
+    const int width = WIDTH;
+    const int height = HEIGHT;
+
+    // host memory for image of width x height pixels
+    uchar *host_in = (uchar *)malloc(sizeof(uchar)*width*height);
+    uchar *host_out = (uchar *)malloc(sizeof(uchar)*width*height);
+
+    // initialize data with a pseudo-random pattern
+    unsigned int seed = 42;
+    for (int y=0; y<height; ++y) {
+        for (int x=0; x<width; ++x) {
+            seed = seed * 1103515245 + 12345;
+            host_in[y*width + x] = (uchar)(seed >> 16);
+            host_out[y*width + x] = 0;
+        }
+    }
+
+    // input and output images of width x height pixels
+    Image<uchar> IN(width, height);
+    Image<uchar> OUT3(width, height);
+    Image<uchar> OUT7(width, height);
+    Domain D3(3, 3);
+    Domain D7(7, 7);
+
+    IN = host_in;
+    OUT3 = host_out;
+    OUT7 = host_out;
+
+    BoundaryCondition<uchar> BC3(IN, D3, BOUNDARY_MIRROR);
+    Accessor<uchar> AccIn3(BC3);
+    BoundaryCondition<uchar> BC7(IN, D7, BOUNDARY_MIRROR);
+    Accessor<uchar> AccIn7(BC7);
+
+    fprintf(stderr, "Calculating HIPAcc median filters ...\n");
+
+    IterationSpace<uchar> IS3(OUT3);
+    MedianFilter M3(IS3, AccIn3, D3);
+    M3.execute();
+
+    IterationSpace<uchar> IS7(OUT7);
+    MedianFilter M7(IS7, AccIn7, D7);
+    M7.execute();
+
+    uchar *out3 = OUT3.getData();
+    uchar *out7 = OUT7.getData();
+
+
+    fprintf(stderr, "\nComparing results ...\n");
+    for (int y=0; y<height; ++y) {
+        for (int x=0; x<width; ++x) {
+            uchar ref3 = median_ref(host_in, x, y, 3, width, height);
+            uchar ref7 = median_ref(host_in, x, y, 7, width, height);
+            if (ref3 != out3[y*width + x]) {
+                fprintf(stderr, "Test FAILED for 3x3 median, at (%d,%d): %d vs. %d\n",
+                        x, y, ref3, out3[y*width + x]);
+                exit(EXIT_FAILURE);
+            }
+            if (ref7 != out7[y*width + x]) {
+                fprintf(stderr, "Test FAILED for 7x7 median, at (%d,%d): %d vs. %d\n",
+                        x, y, ref7, out7[y*width + x]);
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+    fprintf(stderr, "Test PASSED\n");
+
+    // memory cleanup
+    free(host_in);
+    free(host_out);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,215 @@
+//
+// Copyright (c) 2013, University of Erlangen-Nuremberg
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hipacc.hpp"
+
+// variables set by Makefile
+//#define WIDTH 4096
+//#define HEIGHT 4096
+
+using namespace hipacc;
+using namespace hipacc::math;
+
+
+// absolute difference of two images, summed up over the iteration space
+class AbsDiffSum : public Kernel<int> {
+  private:
+    Accessor<int> &input0;
+    Accessor<int> &input1;
+
+  public:
+    AbsDiffSum(IterationSpace<int> &iter, Accessor<int> &input0,
+               Accessor<int> &input1)
+        : Kernel(iter),
+          input0(input0),
+          input1(input1) {
+      addAccessor(&input0);
+      addAccessor(&input1);
+    }
+
+    void kernel() {
+      int diff = input0() - input1();
+      output() = diff < 0 ? -diff : diff;
+    }
+
+    int reduce(int left, int right) {
+      return left + right;
+    }
+};
+
+// scaled pixels, maximum over the iteration space
+class ScaleMax : public Kernel<int> {
+  private:
+    Accessor<int> &input;
+
+  public:
+    ScaleMax(IterationSpace<int> &iter, Accessor<int> &input)
+        : Kernel(iter),
+          input(input) {
+      addAccessor(&input);
+    }
+
+    void kernel() {
+      output() = 3*input() - 100;
+    }
+
+    int reduce(int left, int right) {
+      return max(left, right);
+    }
+};
+
+// scaled pixels, minimum over the iteration space
+class ScaleMin : public Kernel<int> {
+  private:
+    Accessor<int> &input;
+
+  public:
+    ScaleMin(IterationSpace<int> &iter, Accessor<int> &input)
+        : Kernel(iter),
+          input(input) {
+      addAccessor(&input);
+    }
+
+    void kernel() {
+      output() = 3*input() - 100;
+    }
+
+    int reduce(int left, int right) {
+      return min(left, right);
+    }
+};
+
+
+/*************************************************************************
+ * Main function                                                         *
+ *************************************************************************/
+int main(int argc, const char **argv) {
+    const int width = WIDTH;
+    const int height = HEIGHT;
+    const int offset_x = width/4;
+    const int offset_y = height/4;
+    const int is_width = width/2;
+    const int is_height = height/2;
+
+    // host memory for image of width x height pixels
+    int *host_in0 = (int *)malloc(sizeof(int)*width*height);
+    int *host_in1 = (int *)malloc(sizeof(int)*width*height);
+    int *host_out = (int *)malloc(sizeof(int)*width*height);
+
+    // initialize data
+    for (int y=0; y<height; ++y) {
+        for (int x=0; x<width; ++x) {
+            host_in0[y*width + x] = (y*width + x) % 199;
+            host_in1[y*width + x] = (x*height + y) % 211;
+            host_out[y*width + x] = 0;
+        }
+    }
+
+    // input and output images of width x height pixels
+    Image<int> IN0(width, height);
+    Image<int> IN1(width, height);
+    Image<int> OUT1(width, height);
+    Image<int> OUT2(width, height);
+    Image<int> OUT3(width, height);
+
+    IN0 = host_in0;
+    IN1 = host_in1;
+    OUT1 = host_out;
+
+    Accessor<int> AccIn0(IN0);
+    Accessor<int> AccIn1(IN1);
+    Accessor<int> AccRegion(IN0, is_width, is_height, offset_x, offset_y);
+
+    fprintf(stderr, "Calculating HIPAcc reductions ...\n");
+
+    // the output image is read back: the bands are reduced after computing
+    // them
+    IterationSpace<int> IS1(OUT1);
+    AbsDiffSum ADS(IS1, AccIn0, AccIn1);
+    ADS.execute();
+    int sum = ADS.getReducedData();
+    int *out1 = OUT1.getData();
+
+    // the output images are not used otherwise: the bands are reduced
+    // without storing them
+    IterationSpace<int> IS2(OUT2);
+    ScaleMax SMX(IS2, AccIn1);
+    SMX.execute();
+    int max_val = SMX.getReducedData();
+
+    IterationSpace<int> IS3(OUT3, is_width, is_height, offset_x, offset_y);
+    ScaleMin SMN(IS3, AccRegion);
+    SMN.execute();
+    int min_val = SMN.getReducedData();
+
+
+    fprintf(stderr, "\nCalculating reference ...\n");
+    int ref_sum = 0;
+    int ref_max = 3*host_in1[0] - 100;
+    int ref_min = 3*host_in0[offset_y*width + offset_x] - 100;
+    for (int y=0; y<height; ++y) {
+        for (int x=0; x<width; ++x) {
+            int diff = host_in0[y*width + x] - host_in1[y*width + x];
+            diff = diff < 0 ? -diff : diff;
+            if (diff != out1[y*width + x]) {
+                fprintf(stderr, "Test FAILED for output image, at (%d,%d): %d vs. %d\n",
+                        x, y, diff, out1[y*width + x]);
+                exit(EXIT_FAILURE);
+            }
+            ref_sum += diff;
+            ref_max = max(ref_max, 3*host_in1[y*width + x] - 100);
+            if (x >= offset_x && x < offset_x + is_width &&
+                y >= offset_y && y < offset_y + is_height) {
+                ref_min = min(ref_min, 3*host_in0[y*width + x] - 100);
+            }
+        }
+    }
+
+    fprintf(stderr, "\nComparing results ...\n");
+    if (ref_sum != sum) {
+        fprintf(stderr, "Test FAILED for sum: %d vs. %d\n", ref_sum, sum);
+        exit(EXIT_FAILURE);
+    }
+    if (ref_max != max_val) {
+        fprintf(stderr, "Test FAILED for max: %d vs. %d\n", ref_max, max_val);
+        exit(EXIT_FAILURE);
+    }
+    if (ref_min != min_val) {
+        fprintf(stderr, "Test FAILED for min: %d vs. %d\n", ref_min, min_val);
+        exit(EXIT_FAILURE);
+    }
+    fprintf(stderr, "Test PASSED\n");
+
+    // memory cleanup
+    free(host_in0);
+    free(host_in1);
+    free(host_out);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,195 @@
+//
+// Copyright (c) 2013, University of Erlangen-Nuremberg
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hipacc.hpp"
+
+// variables set by Makefile
+//#define WIDTH 4096
+//#define HEIGHT 4096
+#define EPS 0.001f
+
+using namespace hipacc;
+
+
+// clamp access to the image for the reference
+float get_clamped(float *img, int x, int y, int width, int height) {
+    x = x < 0 ? 0 : (x >= width ? width-1 : x);
+    y = y < 0 ? 0 : (y >= height ? height-1 : y);
+    return img[y*width + x];
+}
+
+
+// convolution with a separable mask: only reads the accessor per tap, hence
+// the column sums can be reused by the next pixel
+class Binomial : public Kernel<float> {
+  private:
+    Accessor<float> &input;
+    Mask<float> &mask;
+
+  public:
+    Binomial(IterationSpace<float> &iter, Accessor<float> &input,
+             Mask<float> &mask)
+        : Kernel(iter),
+          input(input),
+          mask(mask) {
+      addAccessor(&input);
+    }
+
+    void kernel() {
+      output() = convolve(mask, HipaccSUM, [&] () {
+        return mask() * input(mask);
+      });
+    }
+};
+
+// convolution with a separable mask, but each tap depends on a value
+// computed for the current pixel: the column sums must not be reused
+class WeightedBinomial : public Kernel<float> {
+  private:
+    Accessor<float> &input;
+    Mask<float> &mask;
+
+  public:
+    WeightedBinomial(IterationSpace<float> &iter, Accessor<float> &input,
+                     Mask<float> &mask)
+        : Kernel(iter),
+          input(input),
+          mask(mask) {
+      addAccessor(&input);
+    }
+
+    void kernel() {
+      float weight = 1.0f + 0.5f * input();
+      output() = convolve(mask, HipaccSUM, [&] () {
+        return mask() * input(mask) * weight;
+      });
+    }
+};
+
+
+/*************************************************************************
+ * Main function                                                         *
+ *************************************************************************/
+int main(int argc, const char **argv) {
+    const int width = WIDTH;
+    const int height = HEIGHT;
+
+    // binomial filter mask: outer product of (1 4 6 4 1)/16
+    const float coef[5] = { 0.0625f, 0.25f, 0.375f, 0.25f, 0.0625f };
+    const float filter_xy[5][5] = {
+        { 0.00390625f, 0.015625f, 0.0234375f, 0.015625f, 0.00390625f },
+        { 0.015625f,   0.0625f,   0.09375f,   0.0625f,   0.015625f   },
+        { 0.0234375f,  0.09375f,  0.140625f,  0.09375f,  0.0234375f  },
+        { 0.015625f,   0.0625f,   0.09375f,   0.0625f,   0.015625f   },
+        { 0.00390625f, 0.015625f, 0.0234375f, 0.015625f, 0.00390625f }
+    };
+
+    // host memory for image of width x height pixels
+    float *host_in = (float *)malloc(sizeof(float)*width*height);
+    float *host_out = (float *)malloc(sizeof(float)*width*height);
+    float *reference_out1 = (float *)malloc(sizeof(float)*width*height);
+    float *reference_out2 = (float *)malloc(sizeof(float)*width*height);
+
+    // initialize data
+    for (int y=0; y<height; ++y) {
+        for (int x=0; x<width; ++x) {
+            host_in[y*width + x] = (float)((y*width + x) % 97) * 0.01f;
+            host_out[y*width + x] = 0.0f;
+        }
+    }
+
+    // input and output images of width x height pixels
+    Image<float> IN(width, height);
+    Image<float> OUT1(width, height);
+    Image<float> OUT2(width, height);
+    Mask<float> M(filter_xy);
+
+    IN = host_in;
+    OUT1 = host_out;
+    OUT2 = host_out;
+
+    BoundaryCondition<float> BC(IN, M, BOUNDARY_CLAMP);
+    Accessor<float> AccIn(BC);
+
+    fprintf(stderr, "Calculating HIPAcc separable filters ...\n");
+
+    IterationSpace<float> IS1(OUT1);
+    Binomial B(IS1, AccIn, M);
+    B.execute();
+
+    IterationSpace<float> IS2(OUT2);
+    WeightedBinomial W(IS2, AccIn, M);
+    W.execute();
+
+    float *out1 = OUT1.getData();
+    float *out2 = OUT2.getData();
+
+
+    fprintf(stderr, "\nCalculating reference ...\n");
+    for (int y=0; y<height; ++y) {
+        for (int x=0; x<width; ++x) {
+            float sum = 0.0f;
+            for (int yf=-2; yf<=2; ++yf) {
+                for (int xf=-2; xf<=2; ++xf) {
+                    sum += coef[yf+2] * coef[xf+2] *
+                           get_clamped(host_in, x+xf, y+yf, width, height);
+                }
+            }
+            reference_out1[y*width + x] = sum;
+            reference_out2[y*width + x] = sum *
+                (1.0f + 0.5f * host_in[y*width + x]);
+        }
+    }
+
+    fprintf(stderr, "\nComparing results ...\n");
+    for (int y=0; y<height; ++y) {
+        for (int x=0; x<width; ++x) {
+            if (fabs(reference_out1[y*width + x] - out1[y*width + x]) > EPS) {
+                fprintf(stderr, "Test FAILED for separable mask, at (%d,%d): %f vs. %f\n",
+                        x, y, reference_out1[y*width + x], out1[y*width + x]);
+                exit(EXIT_FAILURE);
+            }
+            if (fabs(reference_out2[y*width + x] - out2[y*width + x]) > EPS) {
+                fprintf(stderr, "Test FAILED for per-pixel weights, at (%d,%d): %f vs. %f\n",
+                        x, y, reference_out2[y*width + x], out2[y*width + x]);
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+    fprintf(stderr, "Test PASSED\n");
+
+    // memory cleanup
+    free(host_in);
+    free(host_out);
+    free(reference_out1);
+    free(reference_out2);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,197 @@
+//
+// Copyright (c) 2013, University of Erlangen-Nuremberg
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hipacc.hpp"
+
+// variables set by Makefile
+//#define WIDTH 4096
+//#define HEIGHT 4096
+
+using namespace hipacc;
+
+
+// clamp access to the image for the reference
+int get_clamped(int *img, int x, int y, int width, int height) {
+    x = x < 0 ? 0 : (x >= width ? width-1 : x);
+    y = y < 0 ? 0 : (y >= height ? height-1 : y);
+    return img[y*width + x];
+}
+
+// 3x3 blur with integer weights
+int blur_ref(int *img, int x, int y, int width, int height) {
+    return (4*img[y*width + x] +
+            get_clamped(img, x-1, y, width, height) +
+            get_clamped(img, x+1, y, width, height) +
+            get_clamped(img, x, y-1, width, height) +
+            get_clamped(img, x, y+1, width, height)) / 8;
+}
+
+
+// 3x3 blur with integer weights
+class Blur : public Kernel<int> {
+  private:
+    Accessor<int> &input;
+
+  public:
+    Blur(IterationSpace<int> &iter, Accessor<int> &input)
+        : Kernel(iter),
+          input(input) {
+      addAccessor(&input);
+    }
+
+    void kernel() {
+      output() = (4*input() + input(-1, 0) + input(1, 0) + input(0, -1) +
+                  input(0, 1)) / 8;
+    }
+};
+
+class Scale : public Kernel<int> {
+  private:
+    Accessor<int> &input;
+
+  public:
+    Scale(IterationSpace<int> &iter, Accessor<int> &input)
+        : Kernel(iter),
+          input(input) {
+      addAccessor(&input);
+    }
+
+    void kernel() {
+      output() = 3*input() + 1;
+    }
+};
+
+class Subsample : public Kernel<int> {
+  private:
+    Accessor<int> &input;
+
+  public:
+    Subsample(IterationSpace<int> &iter, Accessor<int> &input)
+        : Kernel(iter),
+          input(input) {
+      addAccessor(&input);
+    }
+
+    void kernel() {
+      output() = input();
+    }
+};
+
+
+/*************************************************************************
+ * Main function                                                         *
+ *************************************************************************/
+int main(int argc, const char **argv) {
+    const int width = WIDTH;
+    const int height = HEIGHT;
+    const int width1 = width/2;
+    const int height1 = height/2;
+    const int width2 = width/3;
+    const int height2 = height/3;
+
+    // host memory for image of width x height pixels
+    int *host_in = (int *)malloc(sizeof(int)*width*height);
+
+    // initialize data
+    for (int y=0; y<height; ++y) {
+        for (int x=0; x<width; ++x) {
+            host_in[y*width + x] = (y*width + x) % 251;
+        }
+    }
+
+    // input, intermediate, and subsampled output images
+    Image<int> IN(width, height);
+    Image<int> TMP1(width, height);
+    Image<int> TMP2(width, height);
+    Image<int> OUT1(width1, height1);
+    Image<int> OUT2(width2, height2);
+
+    IN = host_in;
+
+    fprintf(stderr, "Calculating HIPAcc subsampled kernels ...\n");
+
+    // local operator, subsampled by two
+    BoundaryCondition<int> BC(IN, 3, 3, BOUNDARY_CLAMP);
+    Accessor<int> AccIn(BC);
+    IterationSpace<int> IS1(TMP1);
+    Blur B(IS1, AccIn);
+    B.execute();
+
+    AccessorNN<int> AccTmp1(TMP1);
+    IterationSpace<int> IS2(OUT1);
+    Subsample Sub1(IS2, AccTmp1);
+    Sub1.execute();
+
+    // point operator, subsampled by three
+    Accessor<int> AccIn2(IN);
+    IterationSpace<int> IS3(TMP2);
+    Scale S(IS3, AccIn2);
+    S.execute();
+
+    AccessorNN<int> AccTmp2(TMP2);
+    IterationSpace<int> IS4(OUT2);
+    Subsample Sub2(IS4, AccTmp2);
+    Sub2.execute();
+
+    int *out1 = OUT1.getData();
+    int *out2 = OUT2.getData();
+
+
+    fprintf(stderr, "\nComparing results ...\n");
+    for (int y=0; y<height1; ++y) {
+        for (int x=0; x<width1; ++x) {
+            int xs = (int)((width/(float)width1) * x);
+            int ys = (int)((height/(float)height1) * y);
+            int ref = blur_ref(host_in, xs, ys, width, height);
+            if (ref != out1[y*width1 + x]) {
+                fprintf(stderr, "Test FAILED for local operator, at (%d,%d): %d vs. %d\n",
+                        x, y, ref, out1[y*width1 + x]);
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+    for (int y=0; y<height2; ++y) {
+        for (int x=0; x<width2; ++x) {
+            int xs = (int)((width/(float)width2) * x);
+            int ys = (int)((height/(float)height2) * y);
+            int ref = 3*host_in[ys*width + xs] + 1;
+            if (ref != out2[y*width2 + x]) {
+                fprintf(stderr, "Test FAILED for point operator, at (%d,%d): %d vs. %d\n",
+                        x, y, ref, out2[y*width2 + x]);
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+    fprintf(stderr, "Test PASSED\n");
+
+    // memory cleanup
+    free(host_in);
+
+    return EXIT_SUCCESS;
+}